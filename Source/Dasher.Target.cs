@@ -11,5 +11,8 @@ public class DasherTarget : TargetRules
 		DefaultBuildSettings = BuildSettingsVersion.V2;
 		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_1;
 		ExtraModuleNames.Add("Dasher");
+
+		// Replicated properties are push-model, see Core/DasherPushModel.h
+		bWithPushModel = true;
 	}
 }
@@ -2,8 +2,16 @@
 
 #include "DasherProjectile.h"
 
+#include "Dasher.h"
+#include "Characters/DasherCharacter.h"
+#include "Core/DasherAllocationTracker.h"
+#include "Core/DasherTelemetry.h"
+#include "Subsystems/DasherProjectilePoolSubsystem.h"
+#include "Subsystems/DasherProjectilePredictionSubsystem.h"
+
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "Components/SphereComponent.h"
+#include "Net/UnrealNetwork.h"
 
 ADasherProjectile::ADasherProjectile() 
 {
@@ -30,15 +38,166 @@ ADasherProjectile::ADasherProjectile()
 
     // Die after 3 seconds by default
     InitialLifeSpan = 3.0f;
+
+    bInPool = false;
+    bPooledInstance = false;
+    bPredicted = false;
+    ShotId = 0;
+}
+
+void ADasherProjectile::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    FDoRepLifetimeParams Params;
+    Params.bIsPushBased = true;
+    DOREPLIFETIME_WITH_PARAMS_FAST(ADasherProjectile, bInPool, Params);
+
+    Params.Condition = COND_OwnerOnly;
+    DOREPLIFETIME_WITH_PARAMS_FAST(ADasherProjectile, ShotId, Params);
+
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+}
+
+void ADasherProjectile::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+    Super::PreReplication(ChangedPropertyTracker);
+
+    DASHER_VALIDATE_PUSH_PROPERTY(bInPool);
+    DASHER_VALIDATE_PUSH_PROPERTY(ShotId);
+}
+
+void ADasherProjectile::PostNetInit()
+{
+    Super::PostNetInit();
+
+    // Spawned in play when the pool was empty, OnRep_InPool isn't called for it
+    if (!bInPool)
+    {
+        OnServerShotArrived();
+    }
+}
+
+void ADasherProjectile::SetShotId(uint8 InShotId)
+{
+    DASHER_SET_PUSH_PROPERTY(ADasherProjectile, ShotId, InShotId);
 }
 
 void ADasherProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
-    // Only add impulse and destroy projectile if we hit a physics
+    DASHER_SCOPE_CYCLE_COUNTER(DasherProjectileHit);
+    DASHER_ALLOCATION_SCOPE();
+
+    if (!bPredicted)
+    {
+        FDasherTelemetry::Record(EDasherTelemetryEvent::ProjectileHit, OtherActor, Hit.ImpactPoint, GetVelocity().Size());
+    }
+
+    // Only add impulse and destroy projectile if we hit a physics, the server's projectile does the pushing for a predicted one
     if ((OtherActor != nullptr) && (OtherActor != this) && (OtherComp != nullptr) && OtherComp->IsSimulatingPhysics())
     {
-        OtherComp->AddImpulseAtLocation(GetVelocity() * 100.0f, GetActorLocation());
+        if (!bPredicted)
+        {
+            OtherComp->AddImpulseAtLocation(GetVelocity() * 100.0f, GetActorLocation());
+        }
 
-        Destroy();
+        Recycle();
     }
-}
\ No newline at end of file
+}
+
+bool ADasherProjectile::ActivateFromPool(const FVector& Location, const FRotator& Rotation)
+{
+    DASHER_SET_PUSH_PROPERTY(ADasherProjectile, bInPool, false);
+    ApplyPoolState();
+
+    // Same rule as spawning with AdjustIfPossibleButDontSpawnIfColliding
+    if (!TeleportTo(Location, Rotation))
+    {
+        DeactivateToPool();
+        return false;
+    }
+
+    // The pool expires it, a lifespan timer would allocate its delegate on every shot
+    RestartMovement();
+    PoolExpireTime = InitialLifeSpan > 0.f ? GetWorld()->GetTimeSeconds() + InitialLifeSpan : 0.0;
+    ForceNetUpdate();
+
+    INC_DWORD_STAT(STAT_DasherProjectilesSpawned);
+    return true;
+}
+
+void ADasherProjectile::DeactivateToPool()
+{
+    DASHER_SET_PUSH_PROPERTY(ADasherProjectile, bInPool, true);
+    PoolExpireTime = 0.0;
+    // Clears the lifespan timer started when the projectile was spawned
+    SetLifeSpan(0.f);
+    ProjectileMovement->StopMovementImmediately();
+    ApplyPoolState();
+    ForceNetUpdate();
+}
+
+void ADasherProjectile::Recycle()
+{
+    INC_DWORD_STAT(STAT_DasherProjectilesDestroyed);
+
+    if (bPooledInstance)
+    {
+        if (UDasherProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UDasherProjectilePoolSubsystem>())
+        {
+            ProjectilePool->Release(this);
+            return;
+        }
+    }
+    Destroy();
+}
+
+void ADasherProjectile::LifeSpanExpired()
+{
+    Recycle();
+}
+
+void ADasherProjectile::OnRep_InPool()
+{
+    if (bInPool)
+    {
+        ProjectileMovement->StopMovementImmediately();
+    }
+    else
+    {
+        RestartMovement();
+    }
+    ApplyPoolState();
+
+    if (!bInPool)
+    {
+        OnServerShotArrived();
+    }
+}
+
+void ADasherProjectile::RestartMovement()
+{
+    // Same as what InitializeComponent does for a freshly spawned projectile
+    ProjectileMovement->SetUpdatedComponent(CollisionComp);
+    ProjectileMovement->SetVelocityInLocalSpace(FVector::ForwardVector * ProjectileMovement->InitialSpeed);
+    ProjectileMovement->UpdateComponentVelocity();
+}
+
+void ADasherProjectile::OnServerShotArrived()
+{
+    const ADasherCharacter* Shooter = Cast<ADasherCharacter>(GetInstigator());
+    if (Shooter == nullptr || !Shooter->IsLocallyControlled())
+    {
+        return;
+    }
+
+    if (UDasherProjectilePredictionSubsystem* Prediction = GetWorld()->GetSubsystem<UDasherProjectilePredictionSubsystem>())
+    {
+        Prediction->MatchProjectile(this);
+    }
+}
+
+void ADasherProjectile::ApplyPoolState()
+{
+    SetActorHiddenInGame(bInPool);
+    SetActorEnableCollision(!bInPool);
+    ProjectileMovement->SetComponentTickEnabled(!bInPool);
+}
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Core/DasherPushModel.h"
 #include "DasherProjectile.generated.h"
 
 class USphereComponent;
@@ -25,13 +26,83 @@ class ADasherProjectile : public AActor
 public:
     ADasherProjectile();
 
+    void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+    virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+    virtual void PostNetInit() override;
+
     /** called when projectile hits something */
     UFUNCTION()
     void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
+    /** Puts a pooled projectile back into play, as if it was just spawned. Returns false if the location is blocked */
+    bool ActivateFromPool(const FVector& Location, const FRotator& Rotation);
+
+    /** Stops and hides the projectile while it waits in the pool */
+    void DeactivateToPool();
+
+    /** Gives the projectile back to its pool, or destroys it if it wasn't pooled */
+    void Recycle();
+
+    /** Returns true while the projectile is waiting in the pool */
+    bool IsInPool() const { return bInPool; }
+
+    /** Sets the ID of the shot that fired the projectile, on the server */
+    void SetShotId(uint8 InShotId);
+
+    uint8 GetShotId() const { return ShotId; }
+
+    /** Marks the projectile as one the shooter's client fired ahead of the server, which only shows and pushes nothing */
+    void SetPredicted(bool bInPredicted) { bPredicted = bInPredicted; }
+
+    bool IsPredicted() const { return bPredicted; }
+
     /** Returns CollisionComp subobject **/
     USphereComponent* GetCollisionComp() const { return CollisionComp; }
     /** Returns ProjectileMovement subobject **/
     UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovement; }
+
+protected:
+
+    virtual void LifeSpanExpired() override;
+
+    /** Whether the projectile is waiting in the pool, replicated so clients hide it without closing its channel. Push-model */
+    UPROPERTY(ReplicatedUsing = OnRep_InPool)
+    bool bInPool;
+
+    UFUNCTION()
+    void OnRep_InPool();
+
+    TDasherPushModelShadow<bool> bInPoolShadow;
+
+    /** ID of the shot that fired the projectile, sent to the shooter only, to match it with the one it predicted. Push-model */
+    UPROPERTY(Replicated)
+    uint8 ShotId;
+
+    TDasherPushModelShadow<uint8> ShotIdShadow;
+
+private:
+
+    /** Applies the pooled or active state to the components */
+    void ApplyPoolState();
+
+    /** Launches the projectile along its forward vector at the initial speed */
+    void RestartMovement();
+
+    /**
+     * Called on clients when the server fired the projectile, a locally controlled shooter's is handed to its prediction.
+     * Other shooters' cosmetics come from their server shot count, not from projectiles replicating
+     */
+    void OnServerShotArrived();
+
+    /** Set by the pool for the projectiles it owns */
+    bool bPooledInstance;
+
+    bool bPredicted;
+
+    /** World time at which the pool recycles the projectile, zero while pooled or if it doesn't expire */
+    double PoolExpireTime = 0.0;
+
+    friend class UDasherProjectilePoolSubsystem;
+    friend class FDasherPushModelClassesTest;
 };
 
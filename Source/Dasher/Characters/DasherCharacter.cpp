@@ -2,7 +2,17 @@
 
 #include "DasherCharacter.h"
 
+#include "Dasher.h"
 #include "Actors/DasherProjectile.h"
+#include "Components/DasherCharacterMovementComponent.h"
+#include "Components/DasherFirstPersonMeshComponent.h"
+#include "Components/DasherInventoryComponent.h"
+#include "Core/DasherAllocationTracker.h"
+#include "Core/DasherPerfCounters.h"
+#include "Subsystems/DasherLagCompensationSubsystem.h"
+#include "Subsystems/DasherPickupSubsystem.h"
+#include "Subsystems/DasherProjectilePredictionSubsystem.h"
+#include "Subsystems/DasherSignificanceSubsystem.h"
 
 #include "Animation/AnimInstance.h"
 #include "Camera/CameraComponent.h"
@@ -10,20 +20,30 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/InputSettings.h"
 #include "Net/UnrealNetwork.h"
 
-
 //////////////////////////////////////////////////////////////////////////
 // ADasherCharacter
 
-ADasherCharacter::ADasherCharacter()
+ADasherCharacter::ADasherCharacter(const FObjectInitializer& ObjectInitializer)
+    : Super(ObjectInitializer.SetDefaultSubobjectClass<UDasherCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
     // Character doesnt have a rifle at start
     bHasRifle = false;
     
     // Set size for collision capsule
     GetCapsuleComponent()->InitCapsuleSize(55.f, 96.0f);
-        
+
+    // Pickups are found by UDasherPickupSubsystem, nothing needs overlaps from the moving capsule
+    GetCapsuleComponent()->SetGenerateOverlapEvents(false);
+
+    // Dedicated server builds have neither, the arms aren't even cooked for them. Servers running from an editor build
+    // switch them off instead
+    FirstPersonCameraComponent = nullptr;
+    Mesh1P = nullptr;
+#if !UE_SERVER
     // Create a CameraComponent    
     FirstPersonCameraComponent = CreateDefaultSubobject<UCameraComponent>(TEXT("FirstPersonCamera"));
     FirstPersonCameraComponent->SetupAttachment(GetCapsuleComponent());
@@ -31,14 +51,33 @@ ADasherCharacter::ADasherCharacter()
     FirstPersonCameraComponent->bUsePawnControlRotation = true;
 
     // Create a mesh component that will be used when being viewed from a '1st person' view (when controlling this pawn)
-    Mesh1P = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("CharacterMesh1P"));
-    Mesh1P->SetOnlyOwnerSee(true);
+    Mesh1P = CreateDefaultSubobject<UDasherFirstPersonMeshComponent>(TEXT("CharacterMesh1P"));
     Mesh1P->SetupAttachment(FirstPersonCameraComponent);
-    Mesh1P->bCastDynamicShadow = false;
-    Mesh1P->CastShadow = false;
     //Mesh1P->SetRelativeRotation(FRotator(0.9f, -19.19f, 5.2f));
     Mesh1P->SetRelativeLocation(FVector(-30.f, 0.f, -150.f));
-
+#endif
+
+    Inventory = CreateDefaultSubobject<UDasherInventoryComponent>(TEXT("Inventory"));
+
+    // Let small on screen characters skip animation frames, UDasherSignificanceSubsystem budgets the rest
+    GetMesh()->bEnableUpdateRateOptimizations = true;
+
+    // Look rotation is sent at a fixed rate, not on every mouse event
+    LookNetSendRate = 30.f;
+    LookKeepAliveInterval = 0.5f;
+    LookInterpSpeed = 20.f;
+    ReplicatedLook = 0;
+    ServerShotCount = 0;
+    LastSentLook = 0;
+    LastLookSendTime = 0.0;
+    LookInputTime = 0.0;
+
+    // Full auto shots go out in batches, a first shot goes right away
+    FireNetSendRate = 30.f;
+    PendingShotsInputTime = 0.0;
+    LastFireSendTime = 0.0;
+    LastAltFireTime = -UE_BIG_NUMBER;
+    NextShotId = 0;
 }
 
 void ADasherCharacter::BeginPlay()
@@ -46,6 +85,7 @@ void ADasherCharacter::BeginPlay()
     // Call the base class  
     Super::BeginPlay();
 
+#if !UE_SERVER
     //Add Input Mapping Context
     if (APlayerController* PlayerController = Cast<APlayerController>(Controller))
     {
@@ -54,11 +94,30 @@ void ADasherCharacter::BeginPlay()
             Subsystem->AddMappingContext(DefaultMappingContext, 0);
         }
     }
+#endif
+
+    // Record our hitbox so hits against us can be rewound
+    if (HasAuthority())
+    {
+        if (UDasherLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UDasherLagCompensationSubsystem>())
+        {
+            LagCompensation->RegisterCharacter(this);
+        }
+    }
 
+    if (UDasherPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<UDasherPickupSubsystem>())
+    {
+        PickupSubsystem->RegisterCharacter(this);
+    }
+    if (UDasherSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UDasherSignificanceSubsystem>())
+    {
+        Significance->RegisterCharacter(this);
+    }
 }
 
 void ADasherCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+#if !UE_SERVER
     // Remove Input Mapping Context
     if (APlayerController* PlayerController = Cast<APlayerController>(Controller))
     {
@@ -67,18 +126,78 @@ void ADasherCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
             Subsystem->RemoveMappingContext(DefaultMappingContext);
         }
     }
+#endif
     UnsubscribeToWeaponInput();
+    FDasherInputRecorder::RemoveCharacter(this);
+
+    if (UDasherLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UDasherLagCompensationSubsystem>())
+    {
+        LagCompensation->UnregisterCharacter(this);
+    }
+    if (UDasherPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<UDasherPickupSubsystem>())
+    {
+        PickupSubsystem->UnregisterCharacter(this);
+    }
+    if (UDasherSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UDasherSignificanceSubsystem>())
+    {
+        Significance->UnregisterCharacter(this);
+    }
 
     Super::EndPlay(EndPlayReason);
 }
 
+void ADasherCharacter::PostInitializeComponents()
+{
+    Super::PostInitializeComponents();
+
+    GetDasherMovement()->SetMovementSpeeds(Speeds);
+
+    // Only the owning client looks through the camera and sees the arms, nothing on a dedicated server does
+    if (GetNetMode() == NM_DedicatedServer)
+    {
+        if (Mesh1P != nullptr)
+        {
+            Mesh1P->SetComponentTickEnabled(false);
+            Mesh1P->bNoSkeletonUpdate = true;
+            Mesh1P->SetVisibility(false);
+        }
+        if (FirstPersonCameraComponent != nullptr)
+        {
+            FirstPersonCameraComponent->SetComponentTickEnabled(false);
+        }
+    }
+}
+
+void ADasherCharacter::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    UpdateLook(DeltaSeconds);
+    UpdateFire();
+}
+
 void ADasherCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
-    DOREPLIFETIME(ADasherCharacter, LookRotation);
+    FDoRepLifetimeParams Params;
+    Params.bIsPushBased = true;
+    DOREPLIFETIME_WITH_PARAMS_FAST(ADasherCharacter, bHasRifle, Params);
+
+    Params.Condition = COND_SkipOwner;
+    DOREPLIFETIME_WITH_PARAMS_FAST(ADasherCharacter, ReplicatedLook, Params);
+    DOREPLIFETIME_WITH_PARAMS_FAST(ADasherCharacter, ServerShotCount, Params);
 
     Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 }
 
+void ADasherCharacter::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+    Super::PreReplication(ChangedPropertyTracker);
+
+    DASHER_VALIDATE_PUSH_PROPERTY(ReplicatedLook);
+    DASHER_VALIDATE_PUSH_PROPERTY(bHasRifle);
+    DASHER_VALIDATE_PUSH_PROPERTY(ServerShotCount);
+}
+
 //////////////////////////////////////////////////////////////////////////// Input
 
 void ADasherCharacter::SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent)
@@ -87,8 +206,8 @@ void ADasherCharacter::SetupPlayerInputComponent(class UInputComponent* PlayerIn
     if (UEnhancedInputComponent* EnhancedInputComponent = CastChecked<UEnhancedInputComponent>(PlayerInputComponent))
     {
         //Jumping
-        EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Triggered, this, &ACharacter::Jump);
-        EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Completed, this, &ACharacter::StopJumping);
+        EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Triggered, this, &ADasherCharacter::StartJump);
+        EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Completed, this, &ADasherCharacter::StopJump);
 
         //Moving
         EnhancedInputComponent->BindAction(MoveAction, ETriggerEvent::Triggered, this, &ADasherCharacter::Move);
@@ -103,12 +222,35 @@ void ADasherCharacter::SetupPlayerInputComponent(class UInputComponent* PlayerIn
         //Crouching
         EnhancedInputComponent->BindAction(CrouchAction, ETriggerEvent::Triggered, this, &ADasherCharacter::TryCrouch);
         EnhancedInputComponent->BindAction(CrouchAction, ETriggerEvent::Completed, this, &ADasherCharacter::TryUnCrouch);
+
+        //Dashing
+        EnhancedInputComponent->BindAction(DashAction, ETriggerEvent::Started, this, &ADasherCharacter::Dash);
+    }
+
+    // Restarted where the player spawned, which is where the replay spawns it
+    if (Cast<APlayerController>(Controller) != nullptr)
+    {
+        FDasherInputRecorder::AddCharacter(this);
     }
 }
 
+void ADasherCharacter::StartJump(const FInputActionValue& Value)
+{
+    RecordInput(EDasherRecordedInput::Jump, Value);
+    Jump();
+}
+
+void ADasherCharacter::StopJump(const FInputActionValue& Value)
+{
+    RecordInput(EDasherRecordedInput::StopJumping, Value);
+    StopJumping();
+}
 
 void ADasherCharacter::Move(const FInputActionValue& Value)
 {
+    DASHER_SCOPE_CYCLE_COUNTER(DasherCharacterMove);
+    RecordInput(EDasherRecordedInput::Move, Value);
+
     // input is a Vector2D
     FVector2D MovementVector = Value.Get<FVector2D>();
 
@@ -122,99 +264,235 @@ void ADasherCharacter::Move(const FInputActionValue& Value)
 
 void ADasherCharacter::Look(const FInputActionValue& Value)
 {
+    DASHER_SCOPE_CYCLE_COUNTER(DasherCharacterLook);
+
     // input is a Vector2D
     FVector2D LookAxisVector = Value.Get<FVector2D>();
 
     if (Controller != nullptr)
     {
-        // add yaw and pitch input to controller
-        AddControllerYawInput(LookAxisVector.X);
-        AddControllerPitchInput(LookAxisVector.Y);
+        if (APlayerController* PlayerController = Controller->IsLocalPlayerController() ? Cast<APlayerController>(Controller) : nullptr)
+        {
+            // Recorded as the rotation it turns, which is what replays apply through the branch below
+            if (FDasherInputRecorder::IsRecording())
+            {
+                const bool bLegacyScales = GetDefault<UInputSettings>()->bEnableLegacyInputScales;
+                const FVector2D Turn(LookAxisVector.X * (bLegacyScales ? PlayerController->GetDeprecatedInputYawScale() : 1.f),
+                    LookAxisVector.Y * (bLegacyScales ? PlayerController->GetDeprecatedInputPitchScale() : 1.f));
+                RecordInput(EDasherRecordedInput::Look, FInputActionValue(Turn));
+            }
 
-        LookRotation = GetControlRotation();
-        ServerLook(LookRotation);
+            if (LookInputTime == 0.0)
+            {
+                LookInputTime = FPlatformTime::Seconds();
+            }
+
+            // add yaw and pitch input to controller, the result is sent to the server once per frame in UpdateLook
+            AddControllerYawInput(LookAxisVector.X);
+            AddControllerPitchInput(LookAxisVector.Y);
+        }
+        else
+        {
+            RecordInput(EDasherRecordedInput::Look, Value);
+
+            // Controllers without player input, like bots, turn the control rotation directly
+            FRotator NewControlRotation = Controller->GetControlRotation();
+            NewControlRotation.Yaw = FRotator::NormalizeAxis(NewControlRotation.Yaw + LookAxisVector.X);
+            NewControlRotation.Pitch = FMath::ClampAngle(FRotator::NormalizeAxis(NewControlRotation.Pitch + LookAxisVector.Y), -89.f, 89.f);
+            Controller->SetControlRotation(NewControlRotation);
+        }
     }
 }
 
-void ADasherCharacter::ServerLook_Implementation(const FRotator& NewRotation)
+void ADasherCharacter::ServerLook_Implementation(uint32 PackedLook)
 {
-    LookRotation = NewRotation;
+    ++FDasherPerfCounters::Get().LookRPCsReceived;
+
+    LookRotation = UnpackLook(PackedLook);
+    DASHER_SET_PUSH_PROPERTY(ADasherCharacter, ReplicatedLook, PackedLook);
+}
+
+void ADasherCharacter::ServerLookStamped_Implementation(uint32 PackedLook, uint8 InputSequence)
+{
+    ServerLook_Implementation(PackedLook);
+    ClientAckInput(EDasherInputKind::Look, InputSequence);
 }
 
 void ADasherCharacter::Sprint(const FInputActionValue& Value)
 {
-    if (GetCharacterMovement()->IsCrouching() || GetCharacterMovement()->IsFalling() || !Speeds.Contains(EMovementSpeed::Sprint))
+    RecordInput(EDasherRecordedInput::Sprint, Value);
+
+    if (GetCharacterMovement()->IsCrouching() || GetCharacterMovement()->IsFalling())
     {
         return;
     }
-    StartSprint_Internal();
-    ServerSprint();
+
+    // Triggered every frame while held, only the press is sampled
+    if (!GetDasherMovement()->WantsToSprint())
+    {
+        StampMoveInput(EDasherInputKind::Sprint);
+    }
+    GetDasherMovement()->SetWantsToSprint(true);
 }
 
-void ADasherCharacter::ServerSprint_Implementation()
+void ADasherCharacter::StopSprinting(const FInputActionValue& Value)
 {
-    StartSprint_Internal();
+    RecordInput(EDasherRecordedInput::StopSprinting, Value);
+    GetDasherMovement()->SetWantsToSprint(false);
 }
 
-void ADasherCharacter::StopSprinting(const FInputActionValue& Value)
+void ADasherCharacter::TryCrouch(const FInputActionValue& Value)
 {
-    if (!Speeds.Contains(EMovementSpeed::Walk))
+    RecordInput(EDasherRecordedInput::Crouch, Value);
+    if (!GetCharacterMovement()->bWantsToCrouch)
     {
-        return;
+        StampMoveInput(EDasherInputKind::Crouch);
     }
-    StopSprint_Internal();
-    ServerStopSprinting();
+    Crouch();
 }
 
-void ADasherCharacter::ServerStopSprinting_Implementation()
+void ADasherCharacter::TryUnCrouch(const FInputActionValue& Value)
 {
-    StopSprint_Internal();
+    RecordInput(EDasherRecordedInput::UnCrouch, Value);
+    UnCrouch();
 }
 
-void ADasherCharacter::TryCrouch(const FInputActionValue& Value)
+void ADasherCharacter::Dash(const FInputActionValue& Value)
 {
-    Crouch_Internal();
-    ServerCrouch();
+    RecordInput(EDasherRecordedInput::Dash, Value);
+    GetDasherMovement()->RequestDash();
 }
 
-void ADasherCharacter::ServerCrouch_Implementation()
+void ADasherCharacter::Fire(const FInputActionValue& Value)
 {
-    Crouch_Internal();
+    DASHER_SCOPE_CYCLE_COUNTER(DasherCharacterFire);
+    DASHER_ALLOCATION_SCOPE();
+    RecordInput(EDasherRecordedInput::Fire, Value);
+
+    // Triggered every frame while held, the scheduler decides when shots come out
+    if (const UTP_WeaponComponent* Weapon = GetActiveWeaponComponent())
+    {
+        FireScheduler.PullTrigger(GetWorld()->GetTimeSeconds(), Weapon->GetStats().FireInterval);
+        UpdateFire();
+    }
 }
 
-void ADasherCharacter::TryUnCrouch(const FInputActionValue& Value)
+void ADasherCharacter::ServerFireBatch_Implementation(const FDasherShotBatch& Shots, uint8 InputSequence)
+{
+    ++FDasherPerfCounters::Get().FireRPCsReceived;
+
+    if (UTP_WeaponComponent* Weapon = GetActiveWeaponComponent())
+    {
+        Weapon->ServerFireBatch(Shots);
+    }
+
+    if (InputSequence != 0)
+    {
+        ClientAckInput(EDasherInputKind::Fire, InputSequence);
+    }
+}
+
+void ADasherCharacter::AddServerShots(int32 NumShots)
 {
-    UnCrouch_Internal();
-    ServerUnCrouch();
+    DASHER_SET_PUSH_PROPERTY(ADasherCharacter, ServerShotCount, static_cast<uint8>(ServerShotCount + NumShots));
+
+    // A listen server's player sees the remote shooters it fires for without replication
+    if (GetNetMode() == NM_ListenServer && !IsLocallyControlled())
+    {
+        if (UTP_WeaponComponent* Weapon = GetActiveWeaponComponent())
+        {
+            Weapon->PlayFireCosmetics();
+        }
+    }
 }
 
-void ADasherCharacter::ServerUnCrouch_Implementation()
+void ADasherCharacter::ClientAckInput_Implementation(EDasherInputKind Kind, uint8 InputSequence)
 {
-    UnCrouch_Internal();
+    InputLatency.AckRPC(Kind, InputSequence, this);
 }
 
-void ADasherCharacter::Fire(const FInputActionValue& Value)
+void ADasherCharacter::ClientRejectShots_Implementation(uint8 FirstShotId, uint16 RejectedMask)
 {
-    if (ActiveWeaponComponent.IsValid())
+    if (UDasherProjectilePredictionSubsystem* Prediction = GetWorld()->GetSubsystem<UDasherProjectilePredictionSubsystem>())
     {
-        ActiveWeaponComponent->Fire();
-        ServerFire();
+        Prediction->RejectShots(this, FirstShotId, RejectedMask);
     }
 }
 
-void ADasherCharacter::ServerFire_Implementation()
+void ADasherCharacter::StopFire(const FInputActionValue& Value)
 {
-    ActiveWeaponComponent->ServerFire();
+    RecordInput(EDasherRecordedInput::StopFire, Value);
+    FireScheduler.ReleaseTrigger();
 }
 
-void ADasherCharacter::StopFire(const FInputActionValue& Value)
+void ADasherCharacter::AltFire(const FInputActionValue& Value)
 {
+    RecordInput(EDasherRecordedInput::AltFire, Value);
+
+    UTP_WeaponComponent* Weapon = GetActiveWeaponComponent();
+    const double Now = GetWorld()->GetTimeSeconds();
+    if (Weapon != nullptr && Now - LastAltFireTime >= Weapon->GetHitscanInterval())
+    {
+        LastAltFireTime = Now;
+
+        // Shoot from where we see ourselves, at the server time our view of the others is from. Simulated proxies are
+        // smoothed towards their replicated location, so they show it that much later
+        FVector ViewLocation;
+        FRotator ViewRotation;
+        GetActorEyesViewPoint(ViewLocation, ViewRotation);
+        const AGameStateBase* GameState = GetWorld()->GetGameState();
+        double ClientTimestamp = GameState != nullptr ? GameState->GetServerWorldTimeSeconds() : Now;
+        if (!HasAuthority())
+        {
+            // Every character moves with the same settings, ours say how far behind the others are shown
+            const UCharacterMovementComponent* Movement = GetCharacterMovement();
+            ClientTimestamp -= Movement->NetworkSmoothingMode != ENetworkSmoothingMode::Disabled ? Movement->NetworkSimulatedSmoothLocationTime : 0.f;
+        }
 
+        Weapon->Fire();
+        ServerAltFire(ViewLocation, ViewRotation.Vector(), ClientTimestamp);
+        INC_DWORD_STAT(STAT_DasherServerAltFireRPCsSent);
+    }
 }
 
-void ADasherCharacter::AltFire(const FInputActionValue& Value)
+void ADasherCharacter::ServerAltFire_Implementation(FVector_NetQuantize Start, FVector_NetQuantizeNormal Direction, double ClientTimestamp)
 {
+    if (UTP_WeaponComponent* Weapon = GetActiveWeaponComponent())
+    {
+        Weapon->ServerHitscanFire(Start, Direction, ClientTimestamp);
+    }
+}
 
+void ADasherCharacter::SwapWeapon(const FInputActionValue& Value)
+{
+    RecordInput(EDasherRecordedInput::SwapWeapon, Value);
+
+    const float Direction = Value.Get<float>();
+    if (Direction != 0.f)
+    {
+        Inventory->CycleWeapon(Direction > 0.f ? 1 : -1);
+    }
+}
+
+void ADasherCharacter::ReplayInput(EDasherRecordedInput Input, const FInputActionValue& Value)
+{
+    switch (Input)
+    {
+    case EDasherRecordedInput::Jump: StartJump(Value); break;
+    case EDasherRecordedInput::StopJumping: StopJump(Value); break;
+    case EDasherRecordedInput::Move: Move(Value); break;
+    case EDasherRecordedInput::Look: Look(Value); break;
+    case EDasherRecordedInput::Sprint: Sprint(Value); break;
+    case EDasherRecordedInput::StopSprinting: StopSprinting(Value); break;
+    case EDasherRecordedInput::Crouch: TryCrouch(Value); break;
+    case EDasherRecordedInput::UnCrouch: TryUnCrouch(Value); break;
+    case EDasherRecordedInput::Dash: Dash(Value); break;
+    case EDasherRecordedInput::Fire: Fire(Value); break;
+    case EDasherRecordedInput::StopFire: StopFire(Value); break;
+    case EDasherRecordedInput::AltFire: AltFire(Value); break;
+    case EDasherRecordedInput::SwapWeapon: SwapWeapon(Value); break;
+    default: break;
+    }
 }
 
 void ADasherCharacter::PickUp(AActor* PickedUpActor)
@@ -222,20 +500,31 @@ void ADasherCharacter::PickUp(AActor* PickedUpActor)
     OnPickedActorUp.Broadcast(PickedUpActor);
     if (const auto WeaponComponent = PickedUpActor->GetComponentByClass<UTP_WeaponComponent>())
     {
-        ActiveWeaponComponent = WeaponComponent;
         OnAttachedWeapon.Broadcast(WeaponComponent);
-        WeaponComponent->AttachWeapon(this, IsLocallyControlled());
+        if (HasAuthority())
+        {
+            Inventory->AddWeapon(WeaponComponent);
+        }
+        else
+        {
+            // Held right away, it joins the inventory when the server's list replicates
+            WeaponComponent->AttachWeapon(this, IsLocallyControlled());
+        }
     }
     PickedUpActor->SetOwner(this);
 }
 
 void ADasherCharacter::SetHasRifle(bool bNewHasRifle)
 {
-    bHasRifle = bNewHasRifle;
+    DASHER_SET_PUSH_PROPERTY(ADasherCharacter, bHasRifle, bNewHasRifle);
     if (bHasRifle)
     {
         SubscribeToWeaponInput();
     }
+    else
+    {
+        UnsubscribeToWeaponInput();
+    }
 }
 
 bool ADasherCharacter::GetHasRifle()
@@ -245,6 +534,13 @@ bool ADasherCharacter::GetHasRifle()
 
 void ADasherCharacter::SubscribeToWeaponInput()
 {
+#if !UE_SERVER
+    // Every weapon picked up calls this, the actions are bound once for all of them
+    if (WeaponInputBindings.Num() > 0)
+    {
+        return;
+    }
+
     if (APlayerController* PlayerController = Cast<APlayerController>(Controller))
     {
         if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer()))
@@ -253,15 +549,33 @@ void ADasherCharacter::SubscribeToWeaponInput()
 
             if (UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(PlayerController->InputComponent))
             {
-                EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Triggered, this, &ADasherCharacter::Fire);
-                EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Completed, this, &ADasherCharacter::StopFire);
+                WeaponInputComponent = EnhancedInputComponent;
+                WeaponInputBindings.Add(EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Triggered, this, &ADasherCharacter::Fire).GetHandle());
+                WeaponInputBindings.Add(EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Completed, this, &ADasherCharacter::StopFire).GetHandle());
+                WeaponInputBindings.Add(EnhancedInputComponent->BindAction(AltFireAction, ETriggerEvent::Started, this, &ADasherCharacter::AltFire).GetHandle());
+                if (SwapWeaponAction != nullptr)
+                {
+                    WeaponInputBindings.Add(EnhancedInputComponent->BindAction(SwapWeaponAction, ETriggerEvent::Started, this, &ADasherCharacter::SwapWeapon).GetHandle());
+                }
             }
         }
     }
+#endif
 }
 
 void ADasherCharacter::UnsubscribeToWeaponInput()
 {
+#if !UE_SERVER
+    if (UEnhancedInputComponent* EnhancedInputComponent = WeaponInputComponent.Get())
+    {
+        for (const uint32 Handle : WeaponInputBindings)
+        {
+            EnhancedInputComponent->RemoveBindingByHandle(Handle);
+        }
+    }
+    WeaponInputComponent.Reset();
+    WeaponInputBindings.Reset();
+
     if (APlayerController* PlayerController = Cast<APlayerController>(Controller))
     {
         if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer()))
@@ -269,24 +583,196 @@ void ADasherCharacter::UnsubscribeToWeaponInput()
             Subsystem->RemoveMappingContext(FireMappingContext);
         }
     }
+#endif
+}
+
+UTP_WeaponComponent* ADasherCharacter::GetActiveWeaponComponent() const
+{
+    return Inventory != nullptr ? Inventory->GetActiveWeapon() : nullptr;
+}
+
+UDasherCharacterMovementComponent* ADasherCharacter::GetDasherMovement() const
+{
+    return CastChecked<UDasherCharacterMovementComponent>(GetCharacterMovement());
+}
+
+void ADasherCharacter::RecordInput(EDasherRecordedInput Input, const FInputActionValue& Value) const
+{
+    // Only players are recorded, bots replay from their seed and replayed characters from the recording
+    if (FDasherInputRecorder::IsRecording() && Cast<APlayerController>(Controller) != nullptr)
+    {
+        FDasherInputRecorder::Record(this, Input, Value);
+    }
+}
+
+void ADasherCharacter::StampMoveInput(EDasherInputKind Kind)
+{
+    if (!IsLocallyControlled() || HasAuthority())
+    {
+        return;
+    }
+
+    // The input goes out with the first move saved after the last one
+    if (const FNetworkPredictionData_Client_Character* ClientData = GetDasherMovement()->GetPredictionData_Client_Character())
+    {
+        InputLatency.StampMove(Kind, ClientData->CurrentTimeStamp, FPlatformTime::Seconds());
+    }
+}
+
+void ADasherCharacter::UpdateLook(float DeltaSeconds)
+{
+    if (IsLocallyControlled())
+    {
+        LookRotation = GetControlRotation();
+
+        const uint32 PackedLook = PackLook(LookRotation);
+        const double Now = GetWorld()->GetTimeSeconds();
+        if (PackedLook == LastSentLook)
+        {
+            // Input too small to change what would be sent isn't measured
+            LookInputTime = 0.0;
+
+            // ServerLook is unreliable, the last look sent may have been lost. It is sent again now and then, so the
+            // server catches up once the owner stops looking around
+            if (HasAuthority() || LookKeepAliveInterval <= 0.f || Now - LastLookSendTime < LookKeepAliveInterval)
+            {
+                return;
+            }
+        }
+
+        if (HasAuthority())
+        {
+            DASHER_SET_PUSH_PROPERTY(ADasherCharacter, ReplicatedLook, PackedLook);
+        }
+        else
+        {
+            if (LookNetSendRate > 0.f && Now - LastLookSendTime < 1.0 / LookNetSendRate)
+            {
+                return;
+            }
+            LastLookSendTime = Now;
+
+            // Most sends stay 4 bytes, the one sampled for latency carries its sequence
+            const uint8 InputSequence = LookInputTime != 0.0 ? InputLatency.StampRPC(EDasherInputKind::Look, LookInputTime) : 0;
+            if (InputSequence != 0)
+            {
+                ServerLookStamped(PackedLook, InputSequence);
+                INC_DWORD_STAT_BY(STAT_DasherServerLookRPCBytes, sizeof(PackedLook) + sizeof(InputSequence));
+            }
+            else
+            {
+                ServerLook(PackedLook);
+                INC_DWORD_STAT_BY(STAT_DasherServerLookRPCBytes, sizeof(PackedLook));
+            }
+            INC_DWORD_STAT(STAT_DasherServerLookRPCsSent);
+            ++FDasherPerfCounters::Get().LookRPCsSent;
+        }
+        LastSentLook = PackedLook;
+        LookInputTime = 0.0;
+    }
+    else if (GetLocalRole() == ROLE_SimulatedProxy)
+    {
+        LookRotation = FMath::RInterpTo(LookRotation, UnpackLook(ReplicatedLook), DeltaSeconds, LookInterpSpeed);
+    }
+}
+
+void ADasherCharacter::UpdateFire()
+{
+    // Also runs from Tick, when shots come due between two fire inputs
+    DASHER_ALLOCATION_SCOPE();
+
+    if (!FireScheduler.IsActive() && PendingShots.Num() == 0)
+    {
+        return;
+    }
+
+    UTP_WeaponComponent* Weapon = GetActiveWeaponComponent();
+    if (Weapon == nullptr)
+    {
+        FireScheduler.ReleaseTrigger();
+        PendingShots.Reset();
+        return;
+    }
+
+    // Shots are stamped in server time, which the server checks the fire rate against
+    const double Now = GetWorld()->GetTimeSeconds();
+    const AGameStateBase* GameState = GetWorld()->GetGameState();
+    const double ServerTimeOffset = GameState != nullptr && !HasAuthority() ? GameState->GetServerWorldTimeSeconds() - Now : 0.0;
+
+    double ShotTime;
+    while (FireScheduler.TakeDueShot(Now, Weapon->GetStats().FireInterval, ShotTime))
+    {
+        // Wraps around, a batch holds far fewer shots than it takes to come back to an ID still waiting for its projectile
+        const uint8 ShotId = NextShotId++;
+        Weapon->Fire(ShotId);
+
+        if (PendingShots.Num() == 0)
+        {
+            PendingShotsInputTime = FPlatformTime::Seconds();
+        }
+        if (!PendingShots.Add(ShotId, ShotTime + ServerTimeOffset))
+        {
+            SendShots(Weapon, Now);
+            PendingShotsInputTime = FPlatformTime::Seconds();
+            PendingShots.Add(ShotId, ShotTime + ServerTimeOffset);
+        }
+    }
+
+    // The server fires its own shots every frame, the owner sends them at the send rate
+    if (PendingShots.Num() > 0 && (HasAuthority() || FireNetSendRate <= 0.f || Now - LastFireSendTime >= 1.0 / FireNetSendRate))
+    {
+        SendShots(Weapon, Now);
+    }
 }
 
-void ADasherCharacter::StartSprint_Internal()
+void ADasherCharacter::SendShots(UTP_WeaponComponent* Weapon, double Now)
 {
-    GetCharacterMovement()->MaxWalkSpeed = Speeds[EMovementSpeed::Sprint];
+    if (HasAuthority())
+    {
+        Weapon->ServerFireBatch(PendingShots);
+    }
+    else
+    {
+        const uint8 InputSequence = IsLocallyControlled() ? InputLatency.StampRPC(EDasherInputKind::Fire, PendingShotsInputTime) : 0;
+        ServerFireBatch(PendingShots, InputSequence);
+        INC_DWORD_STAT(STAT_DasherServerFireRPCsSent);
+        INC_DWORD_STAT_BY(STAT_DasherServerFireRPCBytes, PendingShots.GetNetSize() + sizeof(InputSequence));
+        ++FDasherPerfCounters::Get().FireRPCsSent;
+    }
+
+    PendingShots.Reset();
+    LastFireSendTime = Now;
 }
 
-void ADasherCharacter::StopSprint_Internal()
+uint32 ADasherCharacter::PackLook(const FRotator& Rotation)
 {
-    GetCharacterMovement()->MaxWalkSpeed = Speeds[EMovementSpeed::Walk];
+    return (uint32(FRotator::CompressAxisToShort(Rotation.Pitch)) << 16) | uint32(FRotator::CompressAxisToShort(Rotation.Yaw));
 }
 
-void ADasherCharacter::Crouch_Internal()
+FRotator ADasherCharacter::UnpackLook(uint32 PackedLook)
 {
-    Crouch(!HasAuthority());
+    return FRotator(FRotator::DecompressAxisFromShort(uint16(PackedLook >> 16)), FRotator::DecompressAxisFromShort(uint16(PackedLook & 0xFFFF)), 0.f);
 }
 
-void ADasherCharacter::UnCrouch_Internal()
+void ADasherCharacter::OnRep_ServerShotCount()
 {
-    UnCrouch(!HasAuthority());
+    // The count a proxy becomes relevant with, before it begins play, is from shots fired before anyone here saw it
+    if (!HasActorBegunPlay())
+    {
+        return;
+    }
+
+    if (UTP_WeaponComponent* Weapon = GetActiveWeaponComponent())
+    {
+        Weapon->PlayFireCosmetics();
+    }
+}
+
+void ADasherCharacter::OnRep_ReplicatedLook()
+{
+    // Snap on the first update, so a proxy that just became relevant doesn't sweep from zero
+    if (LookRotation.IsZero())
+    {
+        LookRotation = UnpackLook(ReplicatedLook);
+    }
 }
@@ -7,6 +7,10 @@
 #include "InputActionValue.h"
 
 #include "Components/TP_WeaponComponent.h"
+#include "Core/DasherFireScheduler.h"
+#include "Core/DasherInputLatency.h"
+#include "Core/DasherInputRecording.h"
+#include "Core/DasherPushModel.h"
 
 #include "DasherCharacter.generated.h"
 
@@ -16,6 +20,9 @@ class USceneComponent;
 class UCameraComponent;
 class UAnimMontage;
 class USoundBase;
+class UDasherCharacterMovementComponent;
+class UDasherInventoryComponent;
+class UEnhancedInputComponent;
 
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPickedActorUp, AActor*, PickedUpActor);
@@ -26,7 +33,8 @@ enum class EMovementSpeed : uint8
 {
     None,
     Walk,
-    Sprint
+    Sprint,
+    MAX UMETA(Hidden)
 };
 
 UCLASS(config=Game)
@@ -36,22 +44,29 @@ class ADasherCharacter : public ACharacter
 
 public:
 
-    ADasherCharacter();
+    ADasherCharacter(const FObjectInitializer& ObjectInitializer);
 
 protected:
 
     virtual void BeginPlay() override;
     virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void PostInitializeComponents() override;
+    virtual void Tick(float DeltaSeconds) override;
 
     void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+    virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
 
-    /** Pawn mesh: 1st person view (arms; seen only by self) */
+    /** Pawn mesh: 1st person view (arms; seen only by self). Null in dedicated server builds, switched off on other dedicated servers */
     UPROPERTY(VisibleDefaultsOnly, Category=Mesh)
     USkeletalMeshComponent* Mesh1P;
 
-    /** First person camera */
+    /** First person camera. Null in dedicated server builds, switched off on other dedicated servers */
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
     UCameraComponent* FirstPersonCameraComponent;
+
+    /** Weapons the character carries */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Weapon, meta = (AllowPrivateAccess = "true"))
+    UDasherInventoryComponent* Inventory;
     
 public:
 
@@ -75,6 +90,10 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Input, meta=(AllowPrivateAccess = "true"))
     class UInputAction* CrouchAction;
 
+    /** Dash Input Action */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Input, meta=(AllowPrivateAccess = "true"))
+    class UInputAction* DashAction;
+
     /** Look Input Action */
     UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
     class UInputAction* LookAction;
@@ -87,7 +106,15 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Input, meta=(AllowPrivateAccess = "true"))
     class UInputAction* FireAction;
 
-    /** Character movement speeds */
+    /** Alternative Fire Input Action */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Input, meta=(AllowPrivateAccess = "true"))
+    class UInputAction* AltFireAction;
+
+    /** Weapon swap Input Action, an axis: positive equips the next weapon, negative the previous one */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Input, meta=(AllowPrivateAccess = "true"))
+    class UInputAction* SwapWeaponAction;
+
+    /** Character movement speeds, copied into the movement component when the character is initialized */
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Speeds)
     TMap<EMovementSpeed, float> Speeds;
 
@@ -98,6 +125,14 @@ public:
     FOnWeaponAttached OnAttachedWeapon;
 
 protected:
+    /** Called for jump input */
+    UFUNCTION(BlueprintCallable, Category = Input)
+    void StartJump(const FInputActionValue& Value);
+
+    /** Called for stopping jump input */
+    UFUNCTION(BlueprintCallable, Category = Input)
+    void StopJump(const FInputActionValue& Value);
+
     /** Called for movement input */
     UFUNCTION(BlueprintCallable, Category = Input)
     void Move(const FInputActionValue& Value);
@@ -106,59 +141,98 @@ protected:
     UFUNCTION(BlueprintCallable, Category = Input)
     void Look(const FInputActionValue& Value);
 
-    UFUNCTION(BlueprintCallable, Server, Reliable, Category = Network)
-    void ServerLook(const FRotator& NewRotation);
+    /** Sends the owner's packed look rotation to the server */
+    UFUNCTION(Server, Unreliable)
+    void ServerLook(uint32 PackedLook);
+
+    /** ServerLook for the look rotations sampled for input latency, echoed back with ClientAckInput */
+    UFUNCTION(Server, Unreliable)
+    void ServerLookStamped(uint32 PackedLook, uint8 InputSequence);
 
-    /** Called for sprinting input */
+    /** Called for sprinting input, predicted by the movement component */
     UFUNCTION(BlueprintCallable, Category = Input)
     void Sprint(const FInputActionValue& Value);
 
-    UFUNCTION(BlueprintCallable, Server, Reliable, Category = Network)
-    void ServerSprint();
-
     /** Called for stopping sprint input */
     UFUNCTION(BlueprintCallable, Category = Input)
     void StopSprinting(const FInputActionValue& Value);
 
-    UFUNCTION(BlueprintCallable, Server, Reliable, Category = Network)
-    void ServerStopSprinting();
-
-    /** Called for crouching input */
+    /** Called for crouching input, predicted by the movement component */
     UFUNCTION(BlueprintCallable, Category = Input)
     void TryCrouch(const FInputActionValue& Value);
 
-    UFUNCTION(BlueprintCallable, Server, Reliable, Category = Network)
-    void ServerCrouch();
-
     /** Called for stopping crouch input */
     UFUNCTION(BlueprintCallable, Category = Input)
     void TryUnCrouch(const FInputActionValue& Value);
 
-    UFUNCTION(BlueprintCallable, Server, Reliable, Category = Network)
-    void ServerUnCrouch();
+    /** Called for dash input, predicted by the movement component */
+    UFUNCTION(BlueprintCallable, Category = Input)
+    void Dash(const FInputActionValue& Value);
 
+    /** Called for fire input, holds the trigger for this frame. Shots come out of the fire scheduler at the weapon's fire rate */
     UFUNCTION(BlueprintCallable, Category = Input)
     void Fire(const FInputActionValue& Value);
 
-    UFUNCTION(BlueprintCallable, Server, Reliable, Category = Network)
-    void ServerFire();
+    /** Fires the shots of a batch on the server, a non-zero InputSequence is echoed back with ClientAckInput */
+    UFUNCTION(Server, Reliable)
+    void ServerFireBatch(const FDasherShotBatch& Shots, uint8 InputSequence);
+
+    /** Echoes a stamped input back to the owner once the server has applied it */
+    UFUNCTION(Client, Unreliable)
+    void ClientAckInput(EDasherInputKind Kind, uint8 InputSequence);
 
+    /** Called for stopping fire input, releases the trigger */
     UFUNCTION(BlueprintCallable, Category = Input)
     void StopFire(const FInputActionValue& Value);
 
+    /** Called for alternative fire input, an instant hit validated with lag compensation */
     UFUNCTION(BlueprintCallable, Category = Input)
     void AltFire(const FInputActionValue& Value);
 
+    /** Sends a hitscan shot to the server, with the server time the client saw it at */
+    UFUNCTION(Server, Reliable)
+    void ServerAltFire(FVector_NetQuantize Start, FVector_NetQuantizeNormal Direction, double ClientTimestamp);
+
+    /** Called for weapon swap input */
+    UFUNCTION(BlueprintCallable, Category = Input)
+    void SwapWeapon(const FInputActionValue& Value);
+
 public:
 
-    UPROPERTY(EditAnywhere, Replicated, BlueprintReadWrite, Category = Weapon)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Weapon)
     FRotator LookRotation;
 
-    /** Bool for AnimBP to switch to another animation set */
-    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Weapon)
+    /** How many times per second the owner sends its look rotation to the server, every frame it changes if zero */
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Network)
+    float LookNetSendRate;
+
+    /** Seconds after which the owner sends its look rotation again when it hasn't changed, in case the last send was lost. Never if zero */
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Network)
+    float LookKeepAliveInterval;
+
+    /** How many times per second the owner sends the shots it fired to the server, every frame it fires if zero */
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Network)
+    float FireNetSendRate;
+
+    /** How fast simulated proxies interpolate towards the replicated look rotation */
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Network)
+    float LookInterpSpeed;
+
+    /** Bool for AnimBP to switch to another animation set, push-model replicated so only SetHasRifle writes it */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Replicated, Category = Weapon)
     bool bHasRifle;
 
-    /** Called for picking up actors */
+    /** Counts shots the server fired, on the server, so the other machines play the shooter's fire cosmetics */
+    void AddServerShots(int32 NumShots);
+
+    /** Tells the owner which shots of a batch the server didn't fire, bit N is shot FirstShotId + N, so their predictions go */
+    UFUNCTION(Client, Unreliable)
+    void ClientRejectShots(uint8 FirstShotId, uint16 RejectedMask);
+
+    /** Calls the input handler a recorded input was delivered to */
+    void ReplayInput(EDasherRecordedInput Input, const FInputActionValue& Value);
+
+    /** Called for picking up actors, weapons go into the inventory */
     UFUNCTION(BlueprintCallable, Category = Weapon)
     void PickUp(AActor* PickedUpActor);
 
@@ -185,14 +259,95 @@ public:
     USkeletalMeshComponent* GetMesh1P() const { return Mesh1P; }
     /** Returns FirstPersonCameraComponent subobject **/
     UCameraComponent* GetFirstPersonCameraComponent() const { return FirstPersonCameraComponent; }
+    /** Returns CharacterMovement as the Dasher movement component **/
+    UDasherCharacterMovementComponent* GetDasherMovement() const;
+    /** Returns the weapon the character is holding, if any **/
+    UTP_WeaponComponent* GetActiveWeaponComponent() const;
+    /** Returns Inventory subobject **/
+    UDasherInventoryComponent* GetInventory() const { return Inventory; }
+    /** Returns the input latency measured for the owning client, empty everywhere else **/
+    const FDasherInputLatency& GetInputLatency() const { return InputLatency; }
+    /** Clears the input latency measured so far **/
+    void ResetInputLatency() { InputLatency.Reset(); }
 
 private:
 
-    void StartSprint_Internal();
-    void StopSprint_Internal();
+    /** Records an input handler call of a player controlled character, while inputs are recorded */
+    void RecordInput(EDasherRecordedInput Input, const FInputActionValue& Value) const;
+
+    /** Starts an input latency sample for an input carried by the saved moves, on owning clients */
+    void StampMoveInput(EDasherInputKind Kind);
+
+    /** Sends the look rotation once per frame for the owner, interpolates it for simulated proxies */
+    void UpdateLook(float DeltaSeconds);
+
+    /** Takes the shots due from the fire scheduler and sends them to the server at FireNetSendRate */
+    void UpdateFire();
+
+    /** Sends the pending shots to the server, or fires them with authority */
+    void SendShots(UTP_WeaponComponent* Weapon, double Now);
+
+    static uint32 PackLook(const FRotator& Rotation);
+    static FRotator UnpackLook(uint32 PackedLook);
+
+    /** Pitch and yaw of LookRotation, 16 bits each. Not replicated to the owner, who has its own control rotation. Push-model, only compared after it changes */
+    UPROPERTY(ReplicatedUsing = OnRep_ReplicatedLook)
+    uint32 ReplicatedLook;
+
+    UFUNCTION()
+    void OnRep_ReplicatedLook();
+
+    /**
+     * Shots the server fired, wrapping. Each change plays one round of fire cosmetics on the other clients, whichever way
+     * the projectiles replicate, or if they don't. Not replicated to the owner, who plays them as it fires. Push-model
+     */
+    UPROPERTY(ReplicatedUsing = OnRep_ServerShotCount)
+    uint8 ServerShotCount;
+
+    UFUNCTION()
+    void OnRep_ServerShotCount();
+
+    TDasherPushModelShadow<uint32> ReplicatedLookShadow;
+    TDasherPushModelShadow<bool> bHasRifleShadow;
+    TDasherPushModelShadow<uint8> ServerShotCountShadow;
+
+    /** Last packed look rotation the owner sent or replicated */
+    uint32 LastSentLook;
+
+    /** World time of the last ServerLook */
+    double LastLookSendTime;
+
+    /** Time of the first look input not sent to the server yet, zero if there is none */
+    double LookInputTime;
+
+    FDasherFireScheduler FireScheduler;
+
+    /** Shots not sent to the server yet, in server world time */
+    FDasherShotBatch PendingShots;
+
+    /** Platform time of the first pending shot, for input latency */
+    double PendingShotsInputTime;
+
+    /** World time of the last ServerFireBatch */
+    double LastFireSendTime;
+
+    /** World time of the last alt fire, taps faster than the weapon's hitscan rate aren't sent */
+    double LastAltFireTime;
+
+    /** ID of the next shot, matches the projectiles the owner predicts with the server's */
+    uint8 NextShotId;
+
+    /** Round trips of the owner's inputs to the server */
+    FDasherInputLatency InputLatency;
 
-    void Crouch_Internal();
-    void UnCrouch_Internal();
+    /** Input component the weapon actions are bound to, and the handles of those bindings */
+    TWeakObjectPtr<UEnhancedInputComponent> WeaponInputComponent;
+    TArray<uint32, TInlineAllocator<4>> WeaponInputBindings;
 
-    TWeakObjectPtr<UTP_WeaponComponent> ActiveWeaponComponent;
+    /** Bots, swarm clients and the fire allocation test drive the character through the same input handlers as players */
+    friend class ADasherBotController;
+    friend class UDasherSwarmSubsystem;
+    friend class UDasherFireAllocTestSubsystem;
+    /** The movement component completes the samples carried by the moves it has acknowledged */
+    friend class UDasherCharacterMovementComponent;
 };
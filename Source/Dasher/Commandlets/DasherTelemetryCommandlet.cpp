@@ -0,0 +1,119 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherTelemetryCommandlet.h"
+
+#include "Dasher.h"
+#include "Core/DasherTelemetry.h"
+
+#include "Algo/StableSort.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+
+UDasherTelemetryCommandlet::UDasherTelemetryCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+int32 UDasherTelemetryCommandlet::Main(const FString& Params)
+{
+    FString In;
+    FString Out;
+    FString Format;
+    if (!FParse::Value(*Params, TEXT("In="), In))
+    {
+        UE_LOG(LogDasher, Error, TEXT("Usage: -run=DasherTelemetry -In=Telemetry.dtlm [-Out=Telemetry.csv] [-Format=Csv|Json]"));
+        return 1;
+    }
+    FParse::Value(*Params, TEXT("Out="), Out);
+    FParse::Value(*Params, TEXT("Format="), Format);
+    if (Format.IsEmpty())
+    {
+        Format = !Out.IsEmpty() ? FPaths::GetExtension(Out) : TEXT("Csv");
+    }
+    const bool bJson = Format == TEXT("Json");
+    if (Out.IsEmpty())
+    {
+        Out = FPaths::ChangeExtension(In, bJson ? TEXT("json") : TEXT("csv"));
+    }
+
+    TUniquePtr<IMappedFileHandle> MappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*In));
+    TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile.IsValid() ? MappedFile->MapRegion() : nullptr);
+    if (!MappedRegion.IsValid() || MappedRegion->GetMappedSize() < sizeof(FDasherTelemetryFileHeader))
+    {
+        UE_LOG(LogDasher, Error, TEXT("Couldn't map %s"), *In);
+        return 1;
+    }
+
+    const uint8* Data = MappedRegion->GetMappedPtr();
+    const FDasherTelemetryFileHeader& Header = *reinterpret_cast<const FDasherTelemetryFileHeader*>(Data);
+    if (Header.Magic != FDasherTelemetryFileHeader::ExpectedMagic || Header.Version > FDasherTelemetryFileHeader::CurrentVersion
+        || Header.RecordSize != sizeof(FDasherTelemetryRecord) || Header.HeaderSize < sizeof(FDasherTelemetryFileHeader))
+    {
+        UE_LOG(LogDasher, Error, TEXT("%s isn't a telemetry file this build can read (version %u)"), *In, Header.Version);
+        return 1;
+    }
+
+    // A file cut short while recording ends in a partial record, which is left out
+    const int64 NumRecords = (MappedRegion->GetMappedSize() - Header.HeaderSize) / Header.RecordSize;
+    const FDasherTelemetryRecord* FirstRecord = reinterpret_cast<const FDasherTelemetryRecord*>(Data + Header.HeaderSize);
+
+    // Each thread's records are in order, the threads are interleaved by time
+    TArray<const FDasherTelemetryRecord*> Records;
+    Records.Reserve(NumRecords);
+    for (int64 Index = 0; Index < NumRecords; ++Index)
+    {
+        Records.Add(FirstRecord + Index);
+    }
+    Algo::StableSortBy(Records, &FDasherTelemetryRecord::Cycles);
+
+    TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Out));
+    if (!Writer.IsValid())
+    {
+        UE_LOG(LogDasher, Error, TEXT("Couldn't create %s"), *Out);
+        return 1;
+    }
+
+    FString Text;
+    const auto Flush = [&Text, &Writer]()
+    {
+        FTCHARToUTF8 Utf8(*Text);
+        Writer->Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Utf8.Length());
+        Text.Reset();
+    };
+
+    Text += bJson ? TEXT("[\n") : TEXT("Seconds,Frame,Thread,Event,ActorId,X,Y,Z,Value\n");
+    for (int32 Index = 0; Index < Records.Num(); ++Index)
+    {
+        const FDasherTelemetryRecord& Record = *Records[Index];
+        const double Seconds = static_cast<double>(static_cast<int64>(Record.Cycles - Header.StartCycles)) * Header.SecondsPerCycle;
+        const TCHAR* Event = LexToString(Record.Event);
+        if (bJson)
+        {
+            Text += FString::Printf(TEXT("  {\"Seconds\": %.6f, \"Frame\": %u, \"Thread\": %u, \"Event\": \"%s\", \"ActorId\": %u, \"X\": %.1f, \"Y\": %.1f, \"Z\": %.1f, \"Value\": %g}%s\n"),
+                Seconds, Record.Frame, Record.ThreadIndex, Event, Record.ActorId, Record.X, Record.Y, Record.Z, Record.Value, Index + 1 < Records.Num() ? TEXT(",") : TEXT(""));
+        }
+        else
+        {
+            Text += FString::Printf(TEXT("%.6f,%u,%u,%s,%u,%.1f,%.1f,%.1f,%g\n"),
+                Seconds, Record.Frame, Record.ThreadIndex, Event, Record.ActorId, Record.X, Record.Y, Record.Z, Record.Value);
+        }
+
+        if (Text.Len() > 64 * 1024)
+        {
+            Flush();
+        }
+    }
+    if (bJson)
+    {
+        Text += TEXT("]\n");
+    }
+    Flush();
+
+    UE_LOG(LogDasher, Display, TEXT("Converted %d events recorded at %s to %s"), Records.Num(), *FDateTime(Header.StartUtcTicks).ToString(), *Out);
+    return 0;
+}
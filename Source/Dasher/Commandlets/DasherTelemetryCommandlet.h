@@ -0,0 +1,26 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DasherTelemetryCommandlet.generated.h"
+
+/**
+ * Converts a telemetry file recorded by FDasherTelemetry to CSV or JSON, with the events of all threads in time order:
+ *   UnrealEditor-Cmd Dasher.uproject -run=DasherTelemetry -In=Telemetry.dtlm [-Out=Telemetry.csv] [-Format=Csv|Json]
+ * The format defaults to the extension of Out, Out defaults to In with the extension of the format.
+ */
+UCLASS()
+class UDasherTelemetryCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+
+    UDasherTelemetryCommandlet();
+
+    // UCommandlet interface
+    virtual int32 Main(const FString& Params) override;
+    // End of UCommandlet interface
+};
@@ -0,0 +1,331 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherCharacterMovementComponent.h"
+
+#include "Core/DasherPerfCounters.h"
+#include "Core/DasherTelemetry.h"
+
+#include "GameFramework/Character.h"
+
+UDasherCharacterMovementComponent::UDasherCharacterMovementComponent()
+{
+    for (float& Speed : MovementSpeeds)
+    {
+        Speed = MaxWalkSpeed;
+    }
+    MovementSpeeds[static_cast<int32>(EMovementSpeed::None)] = 0.f;
+
+    bWantsToSprint = false;
+    bWasSprinting = false;
+    bWasCrouching = false;
+
+    DashSpeed = 2400.f;
+    DashDuration = 0.2f;
+    DashCooldown = 1.f;
+    bWantsToDash = false;
+    DashTimeRemaining = 0.f;
+    DashCooldownRemaining = 0.f;
+
+    SetMoveResponseDataContainer(DasherMoveResponseDataContainer);
+}
+
+void UDasherCharacterMovementComponent::SetMovementSpeeds(const TMap<EMovementSpeed, float>& Speeds)
+{
+    // Missing speeds fall back to walking, walking falls back to MaxWalkSpeed
+    const float* WalkSpeed = Speeds.Find(EMovementSpeed::Walk);
+    MaxWalkSpeed = WalkSpeed != nullptr ? *WalkSpeed : MaxWalkSpeed;
+
+    for (int32 SpeedIndex = 0; SpeedIndex < UE_ARRAY_COUNT(MovementSpeeds); ++SpeedIndex)
+    {
+        const float* Speed = Speeds.Find(static_cast<EMovementSpeed>(SpeedIndex));
+        MovementSpeeds[SpeedIndex] = Speed != nullptr ? *Speed : MaxWalkSpeed;
+    }
+    MovementSpeeds[static_cast<int32>(EMovementSpeed::None)] = 0.f;
+}
+
+float UDasherCharacterMovementComponent::GetMaxSpeed() const
+{
+    const EMovementSpeed Speed = bWantsToSprint ? EMovementSpeed::Sprint : EMovementSpeed::Walk;
+
+    switch (MovementMode)
+    {
+    case MOVE_Walking:
+    case MOVE_NavWalking:
+        return IsCrouching() ? MaxWalkSpeedCrouched : GetMovementSpeed(Speed);
+    case MOVE_Falling:
+        return GetMovementSpeed(Speed);
+    case MOVE_Custom:
+        return IsDashing() ? DashSpeed : Super::GetMaxSpeed();
+    default:
+        return Super::GetMaxSpeed();
+    }
+}
+
+void UDasherCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+    Super::UpdateFromCompressedFlags(Flags);
+
+    bWantsToSprint = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+    bWantsToDash = (Flags & FSavedMove_Character::FLAG_Custom_1) != 0;
+}
+
+bool UDasherCharacterMovementComponent::ClientUpdatePositionAfterServerUpdate()
+{
+    // Replayed moves apply their own flags, keep the live input for the moves that follow
+    const bool bRealWantsToSprint = bWantsToSprint;
+    const bool bRealWantsToDash = bWantsToDash;
+    const bool bResult = Super::ClientUpdatePositionAfterServerUpdate();
+    bWantsToSprint = bRealWantsToSprint;
+    bWantsToDash = bRealWantsToDash;
+
+    return bResult;
+}
+
+FNetworkPredictionData_Client* UDasherCharacterMovementComponent::GetPredictionData_Client() const
+{
+    if (ClientPredictionData == nullptr)
+    {
+        UDasherCharacterMovementComponent* MutableThis = const_cast<UDasherCharacterMovementComponent*>(this);
+        MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Dasher(*this);
+    }
+
+    return ClientPredictionData;
+}
+
+void UDasherCharacterMovementComponent::ServerMovePacked_ServerReceive(const FCharacterServerMovePackedBits& PackedBits)
+{
+    ++FDasherPerfCounters::Get().MoveRPCsReceived;
+
+    Super::ServerMovePacked_ServerReceive(PackedBits);
+}
+
+bool UDasherCharacterMovementComponent::ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientWorldLocation, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode)
+{
+    const bool bError = Super::ServerCheckClientError(ClientTimeStamp, DeltaTime, Accel, ClientWorldLocation, RelativeClientLocation, ClientMovementBase, ClientBaseBoneName, ClientMovementMode);
+    if (bError)
+    {
+        const FVector ServerLocation = UpdatedComponent->GetComponentLocation();
+        FDasherTelemetry::Record(EDasherTelemetryEvent::ServerCorrection, CharacterOwner, ServerLocation, FVector::Dist(ServerLocation, ClientWorldLocation));
+    }
+    return bError;
+}
+
+bool UDasherCharacterMovementComponent::IsDashing() const
+{
+    return MovementMode == MOVE_Custom && CustomMovementMode == static_cast<uint8>(EDasherCustomMovementMode::Dash);
+}
+
+void UDasherCharacterMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+    Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+    // Recorded once by the server, clients replay the same toggles after corrections
+    if (CharacterOwner->HasAuthority())
+    {
+        if (bWantsToSprint != bWasSprinting)
+        {
+            bWasSprinting = bWantsToSprint;
+            FDasherTelemetry::Record(bWasSprinting ? EDasherTelemetryEvent::SprintStart : EDasherTelemetryEvent::SprintStop, CharacterOwner, UpdatedComponent->GetComponentLocation());
+        }
+        if (IsCrouching() != bWasCrouching)
+        {
+            bWasCrouching = IsCrouching();
+            FDasherTelemetry::Record(bWasCrouching ? EDasherTelemetryEvent::CrouchStart : EDasherTelemetryEvent::CrouchStop, CharacterOwner, UpdatedComponent->GetComponentLocation());
+        }
+    }
+
+    // A dash request only lives for the move it was made in
+    if (bWantsToDash)
+    {
+        bWantsToDash = false;
+        if (CanDash())
+        {
+            StartDash();
+        }
+    }
+}
+
+void UDasherCharacterMovementComponent::OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity)
+{
+    Super::OnMovementUpdated(DeltaSeconds, OldLocation, OldVelocity);
+
+    DashCooldownRemaining = FMath::Max(DashCooldownRemaining - DeltaSeconds, 0.f);
+}
+
+void UDasherCharacterMovementComponent::PhysCustom(float DeltaTime, int32 Iterations)
+{
+    if (CustomMovementMode == static_cast<uint8>(EDasherCustomMovementMode::Dash))
+    {
+        PhysDash(DeltaTime, Iterations);
+        return;
+    }
+
+    Super::PhysCustom(DeltaTime, Iterations);
+}
+
+void UDasherCharacterMovementComponent::ClientHandleMoveResponse(const FCharacterMoveResponseDataContainer& MoveResponse)
+{
+    // Moves replayed after a correction start from the server's dash timers
+    if (MoveResponse.IsCorrection())
+    {
+        const FDasherMoveResponseDataContainer& DasherMoveResponse = static_cast<const FDasherMoveResponseDataContainer&>(MoveResponse);
+        DashTimeRemaining = DasherMoveResponse.DashTimeRemaining;
+        DashCooldownRemaining = DasherMoveResponse.DashCooldownRemaining;
+    }
+
+    if (ADasherCharacter* DasherCharacter = Cast<ADasherCharacter>(CharacterOwner))
+    {
+        DasherCharacter->InputLatency.AckMove(MoveResponse.ClientAdjustment.TimeStamp, DasherCharacter);
+    }
+
+    Super::ClientHandleMoveResponse(MoveResponse);
+}
+
+bool UDasherCharacterMovementComponent::CanDash() const
+{
+    return DashCooldownRemaining <= 0.f && !IsDashing() && !IsCrouching() && (IsMovingOnGround() || IsFalling()) && UpdatedComponent != nullptr;
+}
+
+void UDasherCharacterMovementComponent::StartDash()
+{
+    // Dash along the movement input, or forward when standing still
+    FVector DashDirection = Acceleration.GetSafeNormal2D();
+    if (DashDirection.IsNearlyZero())
+    {
+        DashDirection = UpdatedComponent->GetForwardVector().GetSafeNormal2D();
+    }
+
+    Velocity = DashDirection * DashSpeed;
+    DashTimeRemaining = DashDuration;
+    DashCooldownRemaining = DashCooldown;
+    SetMovementMode(MOVE_Custom, static_cast<uint8>(EDasherCustomMovementMode::Dash));
+}
+
+void UDasherCharacterMovementComponent::PhysDash(float DeltaTime, int32 Iterations)
+{
+    if (DeltaTime < MIN_TICK_TIME)
+    {
+        return;
+    }
+
+    const float DashTime = FMath::Min(DeltaTime, DashTimeRemaining);
+    DashTimeRemaining -= DashTime;
+
+    // Move at full dash speed, sliding along anything in the way
+    const FVector Delta = Velocity * DashTime;
+    FHitResult Hit(1.f);
+    SafeMoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), true, Hit);
+    if (Hit.Time < 1.f)
+    {
+        HandleImpact(Hit, DashTime, Delta);
+        SlideAlongSurface(Delta, 1.f - Hit.Time, Hit.Normal, Hit, true);
+    }
+
+    if (DashTimeRemaining <= 0.f)
+    {
+        // Leave the dash at normal speed, falling finds the floor again if there is one
+        Velocity = Velocity.GetClampedToMaxSize(GetMovementSpeed(bWantsToSprint ? EMovementSpeed::Sprint : EMovementSpeed::Walk));
+        SetMovementMode(MOVE_Falling);
+        StartNewPhysics(DeltaTime - DashTime, Iterations);
+    }
+}
+
+void UDasherCharacterMovementComponent::CallServerMovePacked(const FSavedMove_Character* NewMove, const FSavedMove_Character* PendingMove, const FSavedMove_Character* OldMove)
+{
+    ++FDasherPerfCounters::Get().MoveRPCsSent;
+
+    Super::CallServerMovePacked(NewMove, PendingMove, OldMove);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FDasherMoveResponseDataContainer
+
+void FDasherMoveResponseDataContainer::ServerFillResponseData(const UCharacterMovementComponent& CharacterMovement, const FClientAdjustment& PendingAdjustment)
+{
+    Super::ServerFillResponseData(CharacterMovement, PendingAdjustment);
+
+    const UDasherCharacterMovementComponent& DasherMovement = static_cast<const UDasherCharacterMovementComponent&>(CharacterMovement);
+    DashTimeRemaining = DasherMovement.DashTimeRemaining;
+    DashCooldownRemaining = DasherMovement.DashCooldownRemaining;
+}
+
+bool FDasherMoveResponseDataContainer::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap)
+{
+    if (!Super::Serialize(CharacterMovement, Ar, PackageMap))
+    {
+        return false;
+    }
+
+    // Only corrections need the timers, acknowledged moves already agree with the server
+    if (IsCorrection())
+    {
+        Ar << DashTimeRemaining;
+        Ar << DashCooldownRemaining;
+    }
+
+    return !Ar.IsError();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FSavedMove_Dasher
+
+void FSavedMove_Dasher::Clear()
+{
+    Super::Clear();
+
+    bSavedWantsToSprint = false;
+    bSavedWantsToDash = false;
+}
+
+uint8 FSavedMove_Dasher::GetCompressedFlags() const
+{
+    uint8 Result = Super::GetCompressedFlags();
+
+    if (bSavedWantsToSprint)
+    {
+        Result |= FLAG_Custom_0;
+    }
+
+    if (bSavedWantsToDash)
+    {
+        Result |= FLAG_Custom_1;
+    }
+
+    return Result;
+}
+
+bool FSavedMove_Dasher::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+    // Keep the move that asked for a dash on its own, so the server starts it on the same frame
+    const FSavedMove_Dasher* NewDasherMove = static_cast<const FSavedMove_Dasher*>(NewMove.Get());
+    if (bSavedWantsToSprint != NewDasherMove->bSavedWantsToSprint || bSavedWantsToDash || NewDasherMove->bSavedWantsToDash)
+    {
+        return false;
+    }
+
+    return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_Dasher::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+    Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+    if (const UDasherCharacterMovementComponent* MovementComponent = Cast<UDasherCharacterMovementComponent>(C->GetCharacterMovement()))
+    {
+        bSavedWantsToSprint = MovementComponent->WantsToSprint();
+        bSavedWantsToDash = MovementComponent->WantsToDash();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FNetworkPredictionData_Client_Dasher
+
+FNetworkPredictionData_Client_Dasher::FNetworkPredictionData_Client_Dasher(const UCharacterMovementComponent& ClientMovement)
+    : Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_Dasher::AllocateNewMove()
+{
+    return FSavedMovePtr(new FSavedMove_Dasher());
+}
@@ -0,0 +1,154 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Characters/DasherCharacter.h"
+#include "DasherCharacterMovementComponent.generated.h"
+
+/** Custom movement modes used with MOVE_Custom */
+UENUM(BlueprintType)
+enum class EDasherCustomMovementMode : uint8
+{
+    None UMETA(Hidden),
+    Dash
+};
+
+/** Move response that also carries the dash timers, so corrections reconcile them with the server */
+struct FDasherMoveResponseDataContainer : public FCharacterMoveResponseDataContainer
+{
+    using Super = FCharacterMoveResponseDataContainer;
+
+    virtual void ServerFillResponseData(const UCharacterMovementComponent& CharacterMovement, const FClientAdjustment& PendingAdjustment) override;
+    virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap) override;
+
+    float DashTimeRemaining = 0.f;
+    float DashCooldownRemaining = 0.f;
+};
+
+/**
+ * Character movement with sprinting and dashing predicted on the owning client.
+ * Sprint and dash intent travel to the server in the saved move flags, crouch uses the engine's own flag.
+ */
+UCLASS()
+class DASHER_API UDasherCharacterMovementComponent : public UCharacterMovementComponent
+{
+    GENERATED_BODY()
+
+public:
+
+    UDasherCharacterMovementComponent();
+
+    /** Copies the character's speeds into the flat table used by the movement simulation */
+    void SetMovementSpeeds(const TMap<EMovementSpeed, float>& Speeds);
+
+    /** Returns the max speed for the given movement speed */
+    float GetMovementSpeed(EMovementSpeed Speed) const { return MovementSpeeds[static_cast<int32>(Speed)]; }
+
+    /** Starts or stops sprinting */
+    void SetWantsToSprint(bool bNewWantsToSprint) { bWantsToSprint = bNewWantsToSprint; }
+
+    /** Returns true if the character wants to sprint */
+    bool WantsToSprint() const { return bWantsToSprint; }
+
+    /** Asks for a dash, performed by the next move if the dash is off cooldown */
+    void RequestDash() { bWantsToDash = true; }
+
+    /** Returns true if a dash was asked for and not performed yet */
+    bool WantsToDash() const { return bWantsToDash; }
+
+    /** Returns true while dashing */
+    UFUNCTION(BlueprintCallable, Category = "Character Movement: Dash")
+    bool IsDashing() const;
+
+    /** Returns the seconds left before the next dash is allowed */
+    UFUNCTION(BlueprintCallable, Category = "Character Movement: Dash")
+    float GetDashCooldownRemaining() const { return DashCooldownRemaining; }
+
+    /** Speed of the dash */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Dash", meta = (ClampMin = "0", UIMin = "0", ForceUnits = "cm/s"))
+    float DashSpeed;
+
+    /** How long a dash lasts */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Dash", meta = (ClampMin = "0", UIMin = "0", ForceUnits = "s"))
+    float DashDuration;
+
+    /** Time between the start of a dash and the next one */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Dash", meta = (ClampMin = "0", UIMin = "0", ForceUnits = "s"))
+    float DashCooldown;
+
+    // UCharacterMovementComponent interface
+    virtual float GetMaxSpeed() const override;
+    virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+    virtual bool ClientUpdatePositionAfterServerUpdate() override;
+    virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+    virtual void ServerMovePacked_ServerReceive(const FCharacterServerMovePackedBits& PackedBits) override;
+    virtual bool ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientWorldLocation, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+    // End of UCharacterMovementComponent interface
+
+protected:
+
+    // UCharacterMovementComponent interface
+    virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+    virtual void OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity) override;
+    virtual void PhysCustom(float DeltaTime, int32 Iterations) override;
+    virtual void ClientHandleMoveResponse(const FCharacterMoveResponseDataContainer& MoveResponse) override;
+    virtual void CallServerMovePacked(const FSavedMove_Character* NewMove, const FSavedMove_Character* PendingMove, const FSavedMove_Character* OldMove) override;
+    // End of UCharacterMovementComponent interface
+
+    bool CanDash() const;
+    void StartDash();
+    void PhysDash(float DeltaTime, int32 Iterations);
+
+    /** Max speed for each EMovementSpeed, indexed by the enum */
+    float MovementSpeeds[static_cast<int32>(EMovementSpeed::MAX)];
+
+    /** Sprint intent, sent to the server with each saved move */
+    uint8 bWantsToSprint : 1;
+
+    /** Dash intent, sent to the server with the saved move it was asked for in */
+    uint8 bWantsToDash : 1;
+
+    /** Sprint and crouch state of the previous authoritative move, to record their toggles in telemetry */
+    uint8 bWasSprinting : 1;
+    uint8 bWasCrouching : 1;
+
+    /** Seconds left in the current dash */
+    float DashTimeRemaining;
+
+    /** Seconds left before the next dash, advanced by the simulation so replayed moves agree with the server */
+    float DashCooldownRemaining;
+
+    FDasherMoveResponseDataContainer DasherMoveResponseDataContainer;
+
+    friend struct FDasherMoveResponseDataContainer;
+};
+
+/** Saved move carrying the Dasher movement state */
+class DASHER_API FSavedMove_Dasher : public FSavedMove_Character
+{
+public:
+
+    typedef FSavedMove_Character Super;
+
+    virtual void Clear() override;
+    virtual uint8 GetCompressedFlags() const override;
+    virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+    virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+
+    uint8 bSavedWantsToSprint : 1;
+    uint8 bSavedWantsToDash : 1;
+};
+
+/** Client prediction data allocating Dasher saved moves */
+class DASHER_API FNetworkPredictionData_Client_Dasher : public FNetworkPredictionData_Client_Character
+{
+public:
+
+    typedef FNetworkPredictionData_Client_Character Super;
+
+    FNetworkPredictionData_Client_Dasher(const UCharacterMovementComponent& ClientMovement);
+
+    virtual FSavedMovePtr AllocateNewMove() override;
+};
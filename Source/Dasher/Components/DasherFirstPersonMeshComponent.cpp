@@ -0,0 +1,10 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherFirstPersonMeshComponent.h"
+
+UDasherFirstPersonMeshComponent::UDasherFirstPersonMeshComponent()
+{
+    SetOnlyOwnerSee(true);
+    bCastDynamicShadow = false;
+    CastShadow = false;
+}
@@ -0,0 +1,25 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "DasherFirstPersonMeshComponent.generated.h"
+
+/**
+ * The arms only their owner sees. Never loaded on dedicated servers, so neither the component nor the arms mesh and
+ * animations it references are cooked for them.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class DASHER_API UDasherFirstPersonMeshComponent : public USkeletalMeshComponent
+{
+    GENERATED_BODY()
+
+public:
+
+    UDasherFirstPersonMeshComponent();
+
+    // UObject interface
+    virtual bool NeedsLoadForServer() const override { return false; }
+    // End of UObject interface
+};
@@ -0,0 +1,234 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherInventoryComponent.h"
+
+#include "Dasher.h"
+#include "Characters/DasherCharacter.h"
+#include "Components/TP_WeaponComponent.h"
+#include "Core/DasherAllocationTracker.h"
+
+#include "Net/UnrealNetwork.h"
+
+//////////////////////////////////////////////////////////////////////////
+// FDasherInventoryEntry
+
+void FDasherInventoryEntry::PostReplicatedAdd(const FDasherInventoryList& InArraySerializer)
+{
+    if (InArraySerializer.Owner != nullptr && Weapon != nullptr)
+    {
+        InArraySerializer.Owner->OnWeaponAdded(Weapon);
+    }
+}
+
+void FDasherInventoryEntry::PostReplicatedChange(const FDasherInventoryList& InArraySerializer)
+{
+    // The weapon's actor replicated after the entry did
+    if (InArraySerializer.Owner != nullptr && Weapon != nullptr)
+    {
+        InArraySerializer.Owner->OnWeaponAdded(Weapon);
+    }
+}
+
+void FDasherInventoryEntry::PreReplicatedRemove(const FDasherInventoryList& InArraySerializer)
+{
+    if (Weapon != nullptr)
+    {
+        Weapon->SetHiddenInGame(true);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// UDasherInventoryComponent
+
+UDasherInventoryComponent::UDasherInventoryComponent()
+{
+    PrimaryComponentTick.bCanEverTick = false;
+    bWantsInitializeComponent = true;
+    SetIsReplicatedByDefault(true);
+
+    MaxWeapons = 4;
+    ActiveSlot = NoSlot;
+    AppliedSlot = NoSlot;
+    bOwnerPickedSlot = false;
+}
+
+void UDasherInventoryComponent::InitializeComponent()
+{
+    Super::InitializeComponent();
+
+    Inventory.Owner = this;
+    Inventory.Entries.Reserve(MaxWeapons);
+}
+
+void UDasherInventoryComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    DOREPLIFETIME(UDasherInventoryComponent, Inventory);
+
+    FDoRepLifetimeParams Params;
+    Params.bIsPushBased = true;
+    Params.Condition = COND_SkipOwner;
+    DOREPLIFETIME_WITH_PARAMS_FAST(UDasherInventoryComponent, ActiveSlot, Params);
+}
+
+void UDasherInventoryComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+    Super::PreReplication(ChangedPropertyTracker);
+
+    DASHER_VALIDATE_PUSH_PROPERTY(ActiveSlot);
+}
+
+bool UDasherInventoryComponent::AddWeapon(UTP_WeaponComponent* Weapon)
+{
+    if (Weapon == nullptr || GetOwnerRole() != ROLE_Authority || HasWeapon(Weapon))
+    {
+        return false;
+    }
+
+    if (Inventory.Entries.Num() >= MaxWeapons)
+    {
+        UE_LOG(LogDasher, Verbose, TEXT("%s: inventory is full, %s is not picked up"), *GetOwner()->GetName(), *Weapon->GetOwner()->GetName());
+        return false;
+    }
+
+    FDasherInventoryEntry& Entry = Inventory.Entries.AddDefaulted_GetRef();
+    Entry.Weapon = Weapon;
+    Inventory.MarkItemDirty(Entry);
+
+    OnWeaponAdded(Weapon);
+    return true;
+}
+
+void UDasherInventoryComponent::EquipSlot(int32 Slot)
+{
+    if (!ControlsSlot() || !Inventory.Entries.IsValidIndex(Slot) || Inventory.Entries[Slot].Weapon == nullptr || Slot == AppliedSlot)
+    {
+        return;
+    }
+
+    ApplyActiveSlot(static_cast<uint8>(Slot));
+    if (GetOwnerRole() == ROLE_Authority)
+    {
+        SetActiveSlot(static_cast<uint8>(Slot));
+    }
+    else
+    {
+        bOwnerPickedSlot = true;
+        ServerEquipSlot(static_cast<uint8>(Slot));
+    }
+}
+
+void UDasherInventoryComponent::CycleWeapon(int32 Direction)
+{
+    const int32 NumWeapons = Inventory.Entries.Num();
+    if (Direction == 0 || NumWeapons < 2)
+    {
+        return;
+    }
+
+    const int32 FromSlot = AppliedSlot != NoSlot ? AppliedSlot : 0;
+    const int32 Step = Direction > 0 ? 1 : NumWeapons - 1;
+    for (int32 Slot = (FromSlot + Step) % NumWeapons; Slot != FromSlot; Slot = (Slot + Step) % NumWeapons)
+    {
+        // Skip weapons whose actor hasn't replicated yet
+        if (Inventory.Entries[Slot].Weapon != nullptr)
+        {
+            EquipSlot(Slot);
+            return;
+        }
+    }
+}
+
+UTP_WeaponComponent* UDasherInventoryComponent::GetActiveWeapon() const
+{
+    return Inventory.Entries.IsValidIndex(AppliedSlot) ? Inventory.Entries[AppliedSlot].Weapon.Get() : nullptr;
+}
+
+bool UDasherInventoryComponent::HasWeapon(const UTP_WeaponComponent* Weapon) const
+{
+    return Inventory.Entries.ContainsByPredicate([Weapon](const FDasherInventoryEntry& Entry) { return Entry.Weapon == Weapon; });
+}
+
+void UDasherInventoryComponent::ServerEquipSlot_Implementation(uint8 Slot)
+{
+    if (!Inventory.Entries.IsValidIndex(Slot) || Inventory.Entries[Slot].Weapon == nullptr)
+    {
+        ClientRestoreSlot(ActiveSlot);
+        return;
+    }
+
+    ApplyActiveSlot(Slot);
+    SetActiveSlot(Slot);
+}
+
+void UDasherInventoryComponent::ClientRestoreSlot_Implementation(uint8 Slot)
+{
+    ApplyActiveSlot(Slot);
+}
+
+void UDasherInventoryComponent::ClientInitialSlot_Implementation(uint8 Slot)
+{
+    if (!bOwnerPickedSlot)
+    {
+        ApplyActiveSlot(Slot);
+    }
+}
+
+void UDasherInventoryComponent::OnRep_ActiveSlot()
+{
+    ApplyActiveSlot(ActiveSlot);
+}
+
+void UDasherInventoryComponent::SetActiveSlot(uint8 Slot)
+{
+    DASHER_SET_PUSH_PROPERTY(UDasherInventoryComponent, ActiveSlot, Slot);
+}
+
+void UDasherInventoryComponent::ApplyActiveSlot(uint8 Slot)
+{
+    DASHER_ALLOCATION_SCOPE();
+
+    AppliedSlot = Slot;
+    for (int32 Index = 0; Index < Inventory.Entries.Num(); ++Index)
+    {
+        if (UTP_WeaponComponent* Weapon = Inventory.Entries[Index].Weapon)
+        {
+            Weapon->SetHiddenInGame(Index != AppliedSlot);
+        }
+    }
+}
+
+void UDasherInventoryComponent::OnWeaponAdded(UTP_WeaponComponent* Weapon)
+{
+    ADasherCharacter* Character = Cast<ADasherCharacter>(GetOwner());
+    if (Character == nullptr)
+    {
+        return;
+    }
+
+    // Does nothing more than hand the character over if the owner already attached it when it picked it up
+    Weapon->AttachWeapon(Character, Character->IsLocallyControlled());
+
+    const int32 Slot = Inventory.Entries.IndexOfByPredicate([Weapon](const FDasherInventoryEntry& Entry) { return Entry.Weapon == Weapon; });
+    if (AppliedSlot == NoSlot && GetOwnerRole() == ROLE_Authority && Slot != INDEX_NONE)
+    {
+        // Only the server picks the first weapon, the owner would go by whichever weapon's actor replicated first
+        ApplyActiveSlot(static_cast<uint8>(Slot));
+        SetActiveSlot(static_cast<uint8>(Slot));
+        if (!Character->IsLocallyControlled() && Character->IsPlayerControlled())
+        {
+            ClientInitialSlot(static_cast<uint8>(Slot));
+        }
+    }
+    else
+    {
+        Weapon->SetHiddenInGame(Slot != AppliedSlot);
+    }
+}
+
+bool UDasherInventoryComponent::ControlsSlot() const
+{
+    const APawn* Pawn = Cast<APawn>(GetOwner());
+    return GetOwnerRole() == ROLE_Authority || (Pawn != nullptr && Pawn->IsLocallyControlled());
+}
@@ -0,0 +1,156 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Net/Serialization/FastArraySerializer.h"
+
+#include "Core/DasherPushModel.h"
+
+#include "DasherInventoryComponent.generated.h"
+
+class UDasherInventoryComponent;
+class UTP_WeaponComponent;
+
+/** A weapon in the inventory */
+USTRUCT()
+struct FDasherInventoryEntry : public FFastArraySerializerItem
+{
+    GENERATED_BODY()
+
+    /** The weapon, null on clients until its actor has replicated */
+    UPROPERTY()
+    TObjectPtr<UTP_WeaponComponent> Weapon;
+
+    void PostReplicatedAdd(const struct FDasherInventoryList& InArraySerializer);
+    void PostReplicatedChange(const struct FDasherInventoryList& InArraySerializer);
+    void PreReplicatedRemove(const struct FDasherInventoryList& InArraySerializer);
+};
+
+/** The inventory's weapons, delta replicated so a pick up only sends the entry it added */
+USTRUCT()
+struct FDasherInventoryList : public FFastArraySerializer
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    TArray<FDasherInventoryEntry> Entries;
+
+    /** Told when entries replicate, not replicated itself */
+    UPROPERTY(NotReplicated)
+    TObjectPtr<UDasherInventoryComponent> Owner;
+
+    bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+    {
+        return FFastArraySerializer::FastArrayDeltaSerialize<FDasherInventoryEntry, FDasherInventoryList>(Entries, DeltaParms, *this);
+    }
+};
+
+template<>
+struct TStructOpsTypeTraits<FDasherInventoryList> : public TStructOpsTypeTraitsBase2<FDasherInventoryList>
+{
+    enum
+    {
+        WithNetDeltaSerializer = true,
+    };
+};
+
+/**
+ * The weapons a character carries, one of them equipped.
+ * The server owns the list and equips the first weapon, telling the owner which slot it took. After that the owner equips
+ * right away and tells the server with a one byte RPC, the server sends the equipped slot, a push-model byte, to everyone else. Swapping shows one weapon and hides the others, the list is
+ * reserved up front and the weapons' assets were loaded when they were picked up, so it doesn't allocate.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class DASHER_API UDasherInventoryComponent : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Slot of an inventory with nothing equipped */
+    static constexpr uint8 NoSlot = MAX_uint8;
+
+    UDasherInventoryComponent();
+
+    /** How many weapons the inventory holds, picking up more is refused */
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category=Inventory, meta=(ClampMin=1, ClampMax=254))
+    int32 MaxWeapons;
+
+    /** Adds a weapon and attaches it to the owning character, equipping it if nothing is. Server only */
+    bool AddWeapon(UTP_WeaponComponent* Weapon);
+
+    /** Equips the weapon in a slot, predicted on the owning client */
+    UFUNCTION(BlueprintCallable, Category=Inventory)
+    void EquipSlot(int32 Slot);
+
+    /** Equips the next weapon for a positive direction and the previous one for a negative one, wrapping around */
+    UFUNCTION(BlueprintCallable, Category=Inventory)
+    void CycleWeapon(int32 Direction);
+
+    /** Returns the equipped weapon, null if there is none */
+    UTP_WeaponComponent* GetActiveWeapon() const;
+
+    /** Returns whether the weapon is in the inventory */
+    bool HasWeapon(const UTP_WeaponComponent* Weapon) const;
+
+    int32 GetNumWeapons() const { return Inventory.Entries.Num(); }
+
+    /** Returns the equipped slot, INDEX_NONE if there is none */
+    int32 GetActiveSlot() const { return AppliedSlot != NoSlot ? AppliedSlot : INDEX_NONE; }
+
+    // UActorComponent interface
+    virtual void InitializeComponent() override;
+    virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+    virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+    // End of UActorComponent interface
+
+private:
+
+    /** Equips the slot on the server */
+    UFUNCTION(Server, Reliable)
+    void ServerEquipSlot(uint8 Slot);
+
+    /** Puts the owner back on the server's slot when it equipped one the server doesn't have */
+    UFUNCTION(Client, Reliable)
+    void ClientRestoreSlot(uint8 Slot);
+
+    /** Tells the owner the slot the server equipped for it, ignored once the owner picked one itself */
+    UFUNCTION(Client, Reliable)
+    void ClientInitialSlot(uint8 Slot);
+
+    UFUNCTION()
+    void OnRep_ActiveSlot();
+
+    /** Sets the replicated slot, with authority */
+    void SetActiveSlot(uint8 Slot);
+
+    /** Shows the weapon in the slot and hides the others */
+    void ApplyActiveSlot(uint8 Slot);
+
+    /** Attaches a weapon that was added to the list, on every machine, and equips it on the server if nothing is */
+    void OnWeaponAdded(UTP_WeaponComponent* Weapon);
+
+    /** Whether this machine picks the slot: the server, and the owner which predicts it */
+    bool ControlsSlot() const;
+
+    /** The weapons, in slot order */
+    UPROPERTY(Replicated)
+    FDasherInventoryList Inventory;
+
+    /** Equipped slot, NoSlot if none. Not sent to the owner, which picked it or got ClientInitialSlot. Push-model, one byte a swap */
+    UPROPERTY(ReplicatedUsing=OnRep_ActiveSlot)
+    uint8 ActiveSlot;
+
+    TDasherPushModelShadow<uint8> ActiveSlotShadow;
+
+    /** Slot whose weapon is shown and fired, the one the owner picked on the owning client */
+    uint8 AppliedSlot;
+
+    /** Set on the owning client once it equipped a slot itself, the server's initial slot is older than its pick */
+    bool bOwnerPickedSlot;
+
+    friend struct FDasherInventoryEntry;
+    friend class FDasherPushModelClassesTest;
+};
@@ -2,30 +2,67 @@
 
 #include "TP_PickUpComponent.h"
 
+#include "Dasher.h"
+#include "Core/DasherTelemetry.h"
+#include "Subsystems/DasherPickupSubsystem.h"
+
 UTP_PickUpComponent::UTP_PickUpComponent()
 {
     // Setup the Sphere Collision
     SphereRadius = 32.f;
+
+    // The sphere only gives the pickup its reach, UDasherPickupSubsystem tests characters against it
+    SetGenerateOverlapEvents(false);
+    SetCollisionEnabled(ECollisionEnabled::NoCollision);
 }
 
 void UTP_PickUpComponent::BeginPlay()
 {
     Super::BeginPlay();
 
-    // Register our Overlap Event
-    OnComponentBeginOverlap.AddDynamic(this, &UTP_PickUpComponent::OnSphereBeginOverlap);
+    // Register with the pickup manager instead of listening for overlaps
+    if (UDasherPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<UDasherPickupSubsystem>())
+    {
+        PickupSubsystem->RegisterPickup(this);
+    }
+
+    // Nothing about a pickup lying in the world changes, it is sent once and then left alone until picked up
+    AActor* PickupActor = GetOwner();
+    if (PickupActor != nullptr && PickupActor->HasAuthority())
+    {
+        PickupActor->SetNetDormancy(DORM_DormantAll);
+    }
 }
 
-void UTP_PickUpComponent::OnSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void UTP_PickUpComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-    // Checking if it is a First Person Character overlapping
-    ADasherCharacter* Character = Cast<ADasherCharacter>(OtherActor);
-    if(Character != nullptr)
+    if (UDasherPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<UDasherPickupSubsystem>())
     {
-        // Notify that the actor is being picked up
-        OnPickUp.Broadcast(Character);
+        PickupSubsystem->UnregisterPickup(this);
+    }
 
-        // Unregister from the Overlap Event so it is no longer triggered
-        OnComponentBeginOverlap.RemoveAll(this);
+    Super::EndPlay(EndPlayReason);
+}
+
+void UTP_PickUpComponent::PickUp(ADasherCharacter* PickUpCharacter)
+{
+    DASHER_SCOPE_CYCLE_COUNTER(DasherPickUp);
+    INC_DWORD_STAT(STAT_DasherPickups);
+    FDasherTelemetry::Record(EDasherTelemetryEvent::PickUp, PickUpCharacter, GetComponentLocation());
+
+    // Whoever hands the pickup out, it can't be picked up again
+    if (UDasherPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<UDasherPickupSubsystem>())
+    {
+        PickupSubsystem->UnregisterPickup(this);
     }
+
+    // The weapon now follows its holder, its attachment and visibility have to replicate again
+    AActor* PickedUpActor = GetOwner();
+    if (PickedUpActor != nullptr && PickedUpActor->HasAuthority())
+    {
+        PickedUpActor->SetNetDormancy(DORM_Awake);
+    }
+
+    // Notify that the actor is being picked up
+    OnPickUp.Broadcast(PickUpCharacter);
 }
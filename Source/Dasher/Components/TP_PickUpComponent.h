@@ -23,12 +23,15 @@ public:
     FOnPickUp OnPickUp;
 
     UTP_PickUpComponent();
+
+    /** Gives the pickup to the character, called by the pickup subsystem when a character reaches the sphere */
+    void PickUp(ADasherCharacter* PickUpCharacter);
+
 protected:
 
     /** Called when the game starts */
     virtual void BeginPlay() override;
 
-    /** Code for when something overlaps this component */
-    UFUNCTION()
-    void OnSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
-};
\ No newline at end of file
+    /** Called when the game ends or the owner is destroyed */
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+};
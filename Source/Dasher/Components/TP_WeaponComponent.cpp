@@ -2,10 +2,25 @@
 
 #include "TP_WeaponComponent.h"
 
+#include "Dasher.h"
 #include "Characters/DasherCharacter.h"
 #include "Actors/DasherProjectile.h"
+#include "Core/DasherAllocationTracker.h"
+#include "Core/DasherFireScheduler.h"
+#include "Core/DasherPerfCounters.h"
+#include "Core/DasherTelemetry.h"
+#include "Core/DasherWeaponDefinition.h"
+#include "Subsystems/DasherProjectileManagerSubsystem.h"
+#include "Subsystems/DasherLagCompensationSubsystem.h"
+#include "Subsystems/DasherProjectilePoolSubsystem.h"
+#include "Subsystems/DasherProjectilePredictionSubsystem.h"
+#include "Subsystems/DasherSignificanceSubsystem.h"
+#include "Components/SphereComponent.h"
+#include "GameFramework/ProjectileMovementComponent.h"
 #include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
 #include "Camera/PlayerCameraManager.h"
+#include "Engine/AssetManager.h"
 #include "Kismet/GameplayStatics.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
@@ -15,61 +30,293 @@ UTP_WeaponComponent::UTP_WeaponComponent()
 {
     // Default offset from the character location for projectiles to spawn
     MuzzleOffset = FVector(100.0f, 0.0f, 10.0f);
+
+    // Same rate as a weapon definition's default
+    FireRate = 10.0f;
+    LastServerShotTime = 0.0;
+    LastServerHitscanTime = -UE_BIG_NUMBER;
+    MaxShotForwardTime = 0.125f;
+
+    // Hitscan reaches as far as a projectile flies in its lifetime, and pushes as hard
+    HitscanFireRate = 4.0f;
+    HitscanRange = 9000.0f;
+    HitscanImpulse = 300000.0f;
+    MaxHitscanOriginError = 200.0f;
 }
 
 
-void UTP_WeaponComponent::Fire()
+void UTP_WeaponComponent::Fire(int32 ShotId)
 {
     if (Character == nullptr || Character->GetController() == nullptr)
     {
         return;
     }
 
+#if !UE_SERVER
+    // Nobody sees or hears it on a dedicated server, and a montage allocates a new instance every time it plays
+    if (GetNetMode() == NM_DedicatedServer)
+    {
+        return;
+    }
+
+    if (ShotId != INDEX_NONE && GetNetMode() == NM_Client && Character->IsLocallyControlled())
+    {
+        FirePredictedProjectile(static_cast<uint8>(ShotId));
+    }
+
+    PlayFireCosmetics();
+#endif
+}
+
+void UTP_WeaponComponent::PlayFireCosmetics()
+{
+#if !UE_SERVER
+    if (Character == nullptr || GetNetMode() == NM_DedicatedServer)
+    {
+        return;
+    }
+
+    // Distant and unseen characters skip some of their cosmetics, local ones always get the most detailed tier
+    bool bPlaySound = true;
+    bool bPlayMontage = true;
+    if (UDasherSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UDasherSignificanceSubsystem>())
+    {
+        Significance->ReportActivity(Character);
+
+        const FDasherSignificanceTier& Tier = Significance->GetTier(Character);
+        bPlaySound = Tier.bPlayFireSound;
+        bPlayMontage = Tier.bPlayFireMontage;
+    }
+
     // Try and play the sound if specified
-    if (FireSound != nullptr)
+    if (Stats.FireSound != nullptr && bPlaySound)
     {
-        UGameplayStatics::PlaySoundAtLocation(this, FireSound, Character->GetActorLocation());
+        UGameplayStatics::PlaySoundAtLocation(this, Stats.FireSound, Character->GetActorLocation());
     }
     
-    // Try and play a firing animation if specified
-    if (FireAnimation != nullptr)
+    // Try and play a firing animation if specified, on the arms only their owner sees, else on the body
+    const bool bFirstPerson = Character->IsLocallyControlled();
+    UAnimMontage* const Montage = bFirstPerson ? Stats.FireAnimation : Stats.ThirdPersonFireAnimation;
+    USkeletalMeshComponent* const Mesh = bFirstPerson ? Character->GetMesh1P() : Character->GetMesh();
+    if (Montage != nullptr && bPlayMontage && Mesh != nullptr)
     {
-        // Get the animation object for the arms mesh
-        UAnimInstance* AnimInstance = Character->GetMesh1P()->GetAnimInstance();
+        UAnimInstance* AnimInstance = Mesh->GetAnimInstance();
         if (AnimInstance != nullptr)
         {
-            AnimInstance->Montage_Play(FireAnimation, 1.f);
+            AnimInstance->Montage_Play(Montage, 1.f);
         }
     }
+#endif
 }
 
+// Shot times come from the shooter's estimate of the server clock, these bound how far off it may be. Shots are also
+// refused past what the shooter's fire rate and ping allow, MaxShotAge only caps that for very high pings
+static constexpr double MaxShotTimeLead = 0.25;
+static constexpr double MaxShotAge = 1.0;
+
 // weapon doesn't know about client & server, we'll control that from the character
-void UTP_WeaponComponent::ServerFire_Implementation()
+int32 UTP_WeaponComponent::ServerFireBatch(const FDasherShotBatch& Shots)
+{
+    DASHER_SCOPE_CYCLE_COUNTER(DasherWeaponServerFire);
+    DASHER_ALLOCATION_SCOPE();
+
+    UWorld* const World = GetWorld();
+    if (Character == nullptr || Character->GetController() == nullptr || World == nullptr || Stats.ProjectileClass == nullptr || Shots.Num() == 0)
+    {
+        return 0;
+    }
+
+    // The camera rotation for players, the eyes for bots and other controllers without a camera
+    FVector ViewLocation;
+    FRotator SpawnRotation;
+    Character->GetController()->GetPlayerViewPoint(ViewLocation, SpawnRotation);
+    // MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
+    const FVector MuzzleLocation = GetOwner()->GetActorLocation() + SpawnRotation.RotateVector(Stats.MuzzleOffset);
+    const FVector Direction = SpawnRotation.Vector();
+
+    const UProjectileMovementComponent* ProjectileMovement = Stats.ProjectileClass->GetDefaultObject<ADasherProjectile>()->GetProjectileMovement();
+    const float ProjectileSpeed = ProjectileMovement != nullptr ? ProjectileMovement->InitialSpeed : 0.f;
+
+    UDasherProjectileManagerSubsystem* ProjectileManager = UDasherProjectileManagerSubsystem::IsBatchedSimulationEnabled() ? World->GetSubsystem<UDasherProjectileManagerSubsystem>() : nullptr;
+    UDasherProjectilePoolSubsystem* ProjectilePool = ProjectileManager == nullptr ? World->GetSubsystem<UDasherProjectilePoolSubsystem>() : nullptr;
+
+    // An honest batch spans one send interval at most, shots claiming to be further behind don't fly further
+    const double MaxBatchAdvance = Character->FireNetSendRate > 0.f ? 1.0 / Character->FireNetSendRate : 0.0;
+    const APlayerState* PlayerState = Character->GetPlayerState();
+    const double RoundTripTime = PlayerState != nullptr ? PlayerState->GetPingInMilliseconds() * 0.001 : 0.0;
+
+    // An honest shooter is at most MaxShotsBehind shots and a send interval behind when its batch leaves, and the batch
+    // takes half a round trip to arrive. The other half covers the error of its server clock estimate
+    const double MaxHonestShotAge = (FDasherFireScheduler::MaxShotsBehind + 1) * Stats.FireInterval + MaxBatchAdvance + RoundTripTime;
+    const int32 MaxBatchShots = FMath::CeilToInt32(MaxBatchAdvance / Stats.FireInterval) + FDasherFireScheduler::MaxShotsBehind + 1;
+
+    // Validate the whole batch first, only the shots that pass say how far behind the others are
+    const double Now = World->GetTimeSeconds();
+    const double OldestShotTime = Now - FMath::Min(MaxHonestShotAge, MaxShotAge);
+    double NewestShotTime = 0.0;
+    int32 NumAccepted = 0;
+    uint16 RejectedMask = 0;
+    for (int32 Index = 0; Index < Shots.Num(); ++Index)
+    {
+        // Shots from too far in the past or the future are refused, and a fire interval apart at most 10% early, which
+        // also covers the millisecond rounding of the shot times. A batch never fires more than an honest one could hold
+        const double ShotTime = Shots.GetShotTime(Index);
+        const double EarliestShotTime = FMath::Max(LastServerShotTime + Stats.FireInterval * 0.9, OldestShotTime);
+        if (ShotTime < EarliestShotTime || ShotTime > Now + MaxShotTimeLead || NumAccepted >= MaxBatchShots)
+        {
+            INC_DWORD_STAT(STAT_DasherShotsRejected);
+            RejectedMask |= 1 << Index;
+            continue;
+        }
+        LastServerShotTime = ShotTime;
+        NewestShotTime = ShotTime;
+        ++NumAccepted;
+    }
+
+    // A remote shooter's projectiles are where they would be had they left when it fired, by the server's measure of its
+    // ping, the way everyone else sees them. The shooter's own prediction flies ahead by as much
+    const double ForwardTime = !Character->IsLocallyControlled() ? FMath::Min(RoundTripTime * 0.5, static_cast<double>(MaxShotForwardTime)) : 0.0;
+
+    int32 NumFired = 0;
+    for (int32 Index = 0; Index < Shots.Num(); ++Index)
+    {
+        if (RejectedMask & (1 << Index))
+        {
+            continue;
+        }
+
+        // Shots sent together leave the muzzle now, each as far ahead as it would have flown since it was fired
+        const double Advance = FMath::Clamp(NewestShotTime - Shots.GetShotTime(Index), 0.0, MaxBatchAdvance) + ForwardTime;
+        const FVector SpawnLocation = AdvanceShot(MuzzleLocation, Direction, ProjectileSpeed * Advance);
+        FDasherTelemetry::Record(EDasherTelemetryEvent::Shot, Character, SpawnLocation);
+
+        // Fire an actor-less projectile when the batched simulation is enabled, else take one from the pool. A blocked
+        // muzzle fires nothing, the shooter's prediction goes with it
+        bool bFired = false;
+        if (ProjectileManager != nullptr)
+        {
+            bFired = ProjectileManager->Launch(Stats.ProjectileClass, SpawnLocation, SpawnRotation);
+        }
+        else if (ProjectilePool != nullptr)
+        {
+            if (ADasherProjectile* Projectile = ProjectilePool->Acquire(Stats.ProjectileClass, SpawnLocation, SpawnRotation, Character, Character))
+            {
+                Projectile->SetShotId(Shots.GetShotId(Index));
+                bFired = true;
+            }
+        }
+
+        if (bFired)
+        {
+            ++NumFired;
+        }
+        else
+        {
+            RejectedMask |= 1 << Index;
+        }
+    }
+
+    // A listen server's own shots aren't predicted
+    if (RejectedMask != 0 && !Character->IsLocallyControlled())
+    {
+        Character->ClientRejectShots(Shots.GetShotId(0), RejectedMask);
+    }
+
+    if (NumFired > 0)
+    {
+        Character->AddServerShots(NumFired);
+    }
+
+    FDasherPerfCounters::Get().ServerShots += NumFired;
+    return NumFired;
+}
+
+FVector UTP_WeaponComponent::AdvanceShot(const FVector& MuzzleLocation, const FVector& Direction, float Distance) const
+{
+    const USphereComponent* Collision = Stats.ProjectileClass->GetDefaultObject<ADasherProjectile>()->GetCollisionComp();
+    if (Distance <= KINDA_SMALL_NUMBER || Collision == nullptr)
+    {
+        return MuzzleLocation;
+    }
+
+    // Sweeps the projectile's own shape and collision, it stops touching what it would have hit on the way
+    const FVector End = MuzzleLocation + Direction * Distance;
+    const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(DasherShotAdvance), false, Character);
+    const FCollisionResponseParams ResponseParams(Collision->GetCollisionResponseToChannels());
+    FHitResult Hit;
+    if (GetWorld()->SweepSingleByChannel(Hit, MuzzleLocation, End, FQuat::Identity, Collision->GetCollisionObjectType(),
+        FCollisionShape::MakeSphere(Collision->GetScaledSphereRadius()), QueryParams, ResponseParams))
+    {
+        return Hit.Location;
+    }
+    return End;
+}
+
+void UTP_WeaponComponent::ServerHitscanFire(const FVector& Start, const FVector& Direction, double ClientTimestamp)
 {
     if (Character == nullptr || Character->GetController() == nullptr)
     {
         return;
     }
 
-    // Try and fire a projectile
-    if (ProjectileClass != nullptr)
+    UWorld* const World = GetWorld();
+    if (World == nullptr)
     {
-        UWorld* const World = GetWorld();
-        if (World != nullptr)
+        return;
+    }
+
+    // Shots are timed by when they arrive, the client's timestamp is only trusted for rewinding. Two shots bunched up by
+    // jitter may arrive half an interval apart, but never more than one shot per interval on average
+    const double Now = World->GetTimeSeconds();
+    const double HitscanInterval = GetHitscanInterval();
+    if (Now < LastServerHitscanTime + HitscanInterval * 0.5)
+    {
+        UE_LOG(LogDasher, Verbose, TEXT("%s: hitscan shot refused, faster than %.1f a second"), *Character->GetName(), HitscanFireRate);
+        return;
+    }
+    LastServerHitscanTime = FMath::Max(Now, LastServerHitscanTime + HitscanInterval);
+
+    // Trust the client's origin only if it is close to where we think it is shooting from
+    FVector ViewLocation;
+    FRotator ViewRotation;
+    Character->GetActorEyesViewPoint(ViewLocation, ViewRotation);
+    const FVector TraceStart = FVector::DistSquared(Start, ViewLocation) <= FMath::Square(MaxHitscanOriginError) ? Start : ViewLocation;
+    FVector TraceEnd = TraceStart + Direction.GetSafeNormal() * HitscanRange;
+    FDasherTelemetry::Record(EDasherTelemetryEvent::AltShot, Character, TraceStart);
+
+    // The world doesn't need rewinding, it stops the shot before any character behind it
+    FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(DasherHitscan), true, Character);
+    QueryParams.AddIgnoredActor(GetOwner());
+    const FCollisionObjectQueryParams ObjectQueryParams(ECC_TO_BITFIELD(ECC_WorldStatic) | ECC_TO_BITFIELD(ECC_WorldDynamic) | ECC_TO_BITFIELD(ECC_PhysicsBody));
+    FHitResult WorldHit;
+    const bool bHitWorld = World->LineTraceSingleByObjectType(WorldHit, TraceStart, TraceEnd, ObjectQueryParams, QueryParams);
+    if (bHitWorld)
+    {
+        TraceEnd = WorldHit.ImpactPoint;
+    }
+
+    if (UDasherLagCompensationSubsystem* LagCompensation = World->GetSubsystem<UDasherLagCompensationSubsystem>())
+    {
+        FDasherRewindHit RewindHit;
+        if (LagCompensation->RewindLineTrace(ClientTimestamp, TraceStart, TraceEnd, Character, RewindHit))
         {
-            APlayerController* PlayerController = Cast<APlayerController>(Character->GetController());
-            const FRotator SpawnRotation = PlayerController->PlayerCameraManager->GetCameraRotation();
-            // MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
-            const FVector SpawnLocation = GetOwner()->GetActorLocation() + SpawnRotation.RotateVector(MuzzleOffset);
-    
-            //Set Spawn Collision Handling Override
-            FActorSpawnParameters ActorSpawnParams;
-            ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
-    
-            // Spawn the projectile at the muzzle
-            World->SpawnActor<ADasherProjectile>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
+            FDasherTelemetry::Record(EDasherTelemetryEvent::HitscanHit, RewindHit.Character, RewindHit.Location);
+            OnHitscanHit.Broadcast(RewindHit.Character, RewindHit.Location);
+            return;
         }
     }
+
+    if (bHitWorld)
+    {
+        FDasherTelemetry::Record(EDasherTelemetryEvent::HitscanHit, WorldHit.GetActor(), WorldHit.ImpactPoint);
+    }
+
+    // Push physics bodies the same way projectiles do
+    UPrimitiveComponent* HitComponent = WorldHit.GetComponent();
+    if (bHitWorld && HitComponent != nullptr && HitComponent->IsSimulatingPhysics())
+    {
+        HitComponent->AddImpulseAtLocation(Direction.GetSafeNormal() * HitscanImpulse, WorldHit.ImpactPoint);
+    }
 }
 
 void UTP_WeaponComponent::AttachWeapon(ADasherCharacter* TargetCharacter, bool IsFirstPerson)
@@ -82,11 +329,152 @@ void UTP_WeaponComponent::AttachWeapon(ADasherCharacter* TargetCharacter, bool I
 
     if (IsFirstPerson)
     {
-        // Attach the weapon to the First Person Character
+        // Attach the weapon to the First Person Character, or to its capsule in dedicated server builds, which have no arms
         FAttachmentTransformRules AttachmentRules(EAttachmentRule::SnapToTarget, true);
-        AttachToComponent(Character->GetMesh1P(), AttachmentRules, FName(TEXT("GripPoint")));
+        if (Character->GetMesh1P() != nullptr)
+        {
+            AttachToComponent(Character->GetMesh1P(), AttachmentRules, FName(TEXT("GripPoint")));
+        }
+        else
+        {
+            AttachToComponent(Character->GetRootComponent(), AttachmentRules);
+        }
     }
     
+    LoadAssets();
+
+    // Have projectiles ready before the first shot
+    if (FiresProjectiles())
+    {
+        if (UDasherProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UDasherProjectilePoolSubsystem>())
+        {
+            ProjectilePool->Prewarm(Stats.ProjectileClass);
+        }
+    }
+
     // switch character into gun mode
     Character->SetHasRifle(true);
 }
+
+void UTP_WeaponComponent::LoadAssets()
+{
+    // Already loading or loaded, the weapon was picked up before
+    if (AssetsHandle.IsValid())
+    {
+        return;
+    }
+
+    const TSoftClassPtr<ADasherProjectile>& SoftProjectileClass = WeaponDefinition != nullptr ? WeaponDefinition->ProjectileClass : ProjectileClass;
+
+    // The first shot can't wait for its projectile, neither can its prediction, the rest only shows up on screen and streams in
+    if (FiresProjectiles())
+    {
+        Stats.ProjectileClass = SoftProjectileClass.LoadSynchronous();
+    }
+
+#if UE_SERVER
+    const bool bLoadCosmetics = false;
+#else
+    const bool bLoadCosmetics = GetNetMode() != NM_DedicatedServer;
+#endif
+
+    const TArray<FName> Bundles = { bLoadCosmetics ? UDasherWeaponDefinition::ClientBundle : UDasherWeaponDefinition::ServerBundle };
+    AssetsHandle = UAssetManager::Get().LoadPrimaryAsset(GetWeaponAssetId(), Bundles, FStreamableDelegate::CreateUObject(this, &UTP_WeaponComponent::OnAssetsLoaded));
+
+    // Nothing to load, or the weapon isn't known to the Asset Manager, take whatever is in memory
+    if (!AssetsHandle.IsValid())
+    {
+        OnAssetsLoaded();
+    }
+}
+
+FPrimaryAssetId UTP_WeaponComponent::GetWeaponAssetId() const
+{
+    if (WeaponDefinition != nullptr)
+    {
+        return WeaponDefinition->GetPrimaryAssetId();
+    }
+
+    // Named after the weapon's class, and bundled from the properties of the first of its weapons picked up
+    UAssetManager& AssetManager = UAssetManager::Get();
+    const UClass* WeaponClass = GetOwner()->GetClass();
+    const FPrimaryAssetId AssetId(UDasherWeaponDefinition::PrimaryAssetType, WeaponClass->GetFName());
+    if (!AssetManager.GetPrimaryAssetPath(AssetId).IsValid())
+    {
+        FAssetBundleData BundleData;
+        if (!ProjectileClass.IsNull())
+        {
+            BundleData.AddBundleAsset(UDasherWeaponDefinition::ServerBundle, ProjectileClass.ToSoftObjectPath().GetAssetPath());
+            BundleData.AddBundleAsset(UDasherWeaponDefinition::ClientBundle, ProjectileClass.ToSoftObjectPath().GetAssetPath());
+        }
+        if (!FireSound.IsNull())
+        {
+            BundleData.AddBundleAsset(UDasherWeaponDefinition::ClientBundle, FireSound.ToSoftObjectPath().GetAssetPath());
+        }
+        if (!FireAnimation.IsNull())
+        {
+            BundleData.AddBundleAsset(UDasherWeaponDefinition::ClientBundle, FireAnimation.ToSoftObjectPath().GetAssetPath());
+        }
+        if (!ThirdPersonFireAnimation.IsNull())
+        {
+            BundleData.AddBundleAsset(UDasherWeaponDefinition::ClientBundle, ThirdPersonFireAnimation.ToSoftObjectPath().GetAssetPath());
+        }
+        AssetManager.AddDynamicAsset(AssetId, FSoftObjectPath(WeaponClass), BundleData);
+    }
+    return AssetId;
+}
+
+void UTP_WeaponComponent::OnAssetsLoaded()
+{
+    float ShotsPerSecond;
+    if (WeaponDefinition != nullptr)
+    {
+        Stats.ProjectileClass = WeaponDefinition->ProjectileClass.Get();
+        Stats.FireSound = WeaponDefinition->FireSound.Get();
+        Stats.FireAnimation = WeaponDefinition->FireAnimation.Get();
+        Stats.ThirdPersonFireAnimation = WeaponDefinition->ThirdPersonFireAnimation.Get();
+        Stats.MuzzleOffset = WeaponDefinition->MuzzleOffset;
+        ShotsPerSecond = WeaponDefinition->FireRate;
+    }
+    else
+    {
+        Stats.ProjectileClass = ProjectileClass.Get();
+        Stats.FireSound = FireSound.Get();
+        Stats.FireAnimation = FireAnimation.Get();
+        Stats.ThirdPersonFireAnimation = ThirdPersonFireAnimation.Get();
+        Stats.MuzzleOffset = MuzzleOffset;
+        ShotsPerSecond = FireRate;
+    }
+    // Every weapon fires full auto at a rate the server checks, however often the fire input comes
+    Stats.FireInterval = 1.f / (ShotsPerSecond > 0.f ? FMath::Min(ShotsPerSecond, FDasherWeaponStats::MaxFireRate) : FDasherWeaponStats::MaxFireRate);
+}
+
+void UTP_WeaponComponent::FirePredictedProjectile(uint8 ShotId)
+{
+    UWorld* const World = GetWorld();
+    UDasherProjectilePoolSubsystem* ProjectilePool = World->GetSubsystem<UDasherProjectilePoolSubsystem>();
+    UDasherProjectilePredictionSubsystem* Prediction = World->GetSubsystem<UDasherProjectilePredictionSubsystem>();
+    if (Stats.ProjectileClass == nullptr || ProjectilePool == nullptr || Prediction == nullptr)
+    {
+        return;
+    }
+
+    // Leaves the muzzle the way the server's will
+    FVector ViewLocation;
+    FRotator SpawnRotation;
+    Character->GetController()->GetPlayerViewPoint(ViewLocation, SpawnRotation);
+    const FVector SpawnLocation = GetOwner()->GetActorLocation() + SpawnRotation.RotateVector(Stats.MuzzleOffset);
+
+    ADasherProjectile* Projectile = ProjectilePool->Acquire(Stats.ProjectileClass, SpawnLocation, SpawnRotation, Character, Character);
+    if (Projectile == nullptr)
+    {
+        return;
+    }
+    Projectile->SetPredicted(true);
+    Prediction->AddPredictedShot(Character, ShotId, Projectile);
+}
+
+bool UTP_WeaponComponent::FiresProjectiles() const
+{
+    return GetOwner()->HasAuthority() || (GetNetMode() == NM_Client && Character != nullptr && Character->IsLocallyControlled());
+}
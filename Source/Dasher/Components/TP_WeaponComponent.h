@@ -4,9 +4,17 @@
 
 #include "CoreMinimal.h"
 #include "Components/SkeletalMeshComponent.h"
+
+#include "Core/DasherWeaponDefinition.h"
+
 #include "TP_WeaponComponent.generated.h"
 
 class ADasherCharacter;
+class ADasherProjectile;
+struct FDasherShotBatch;
+struct FStreamableHandle;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnHitscanHit, ADasherCharacter*, HitCharacter, FVector, HitLocation);
 
 UCLASS(Blueprintable, BlueprintType, ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class DASHER_API UTP_WeaponComponent : public USkeletalMeshComponent
@@ -14,22 +22,61 @@ class DASHER_API UTP_WeaponComponent : public USkeletalMeshComponent
     GENERATED_BODY()
 
 public:
-    /** Projectile class to spawn */
+    /**
+     * What the weapon is, its assets loaded by bundle when it is picked up. The properties below are used if not set, the
+     * weapon's class then registers them as the bundles of a dynamic DasherWeapon asset, so they load the same way
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Weapon)
+    TObjectPtr<UDasherWeaponDefinition> WeaponDefinition;
+
+    /** Projectile class to spawn, loaded when the weapon is picked up */
     UPROPERTY(EditDefaultsOnly, Category=Projectile)
-    TSubclassOf<class ADasherProjectile> ProjectileClass;
+    TSoftClassPtr<ADasherProjectile> ProjectileClass;
 
-    /** Sound to play each time we fire */
+    /** Sound to play each time we fire, streamed in on clients when the weapon is picked up */
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
-    USoundBase* FireSound;
+    TSoftObjectPtr<USoundBase> FireSound;
     
-    /** AnimMontage to play each time we fire */
+    /** AnimMontage to play on the arms each time we fire, streamed in on clients when the weapon is picked up */
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
-    UAnimMontage* FireAnimation;
+    TSoftObjectPtr<UAnimMontage> FireAnimation;
+
+    /** AnimMontage to play on the body each time someone else fires, streamed in on clients when the weapon is picked up */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
+    TSoftObjectPtr<UAnimMontage> ThirdPersonFireAnimation;
 
     /** Gun muzzle's offset from the characters location */
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
     FVector MuzzleOffset;
 
+    /** Shots per second, up to FDasherWeaponStats::MaxFireRate, which zero also fires at */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay, meta=(ClampMin=0))
+    float FireRate;
+
+    /** Most seconds a remote shooter's projectiles are moved forward by, to make up for the half round trip their shots took to arrive */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Projectile, meta=(ClampMin=0))
+    float MaxShotForwardTime;
+
+    /** Hitscan shots per second, the server refuses shots that come in faster */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Hitscan, meta=(ClampMin=0.1))
+    float HitscanFireRate;
+
+    /** How far hitscan shots reach */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Hitscan)
+    float HitscanRange;
+
+    /** Impulse given to physics bodies hit by hitscan shots */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Hitscan)
+    float HitscanImpulse;
+
+    /** How far the client's shot origin may be from the server's view point before the server's is used instead */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Hitscan)
+    float MaxHitscanOriginError;
+
+    /** Called on the server when a hitscan shot hits a character */
+    UPROPERTY(BlueprintAssignable, Category=Hitscan)
+    FOnHitscanHit OnHitscanHit;
+
     /** Sets default values for this component's properties */
     UTP_WeaponComponent();
 
@@ -37,15 +84,67 @@ public:
     UFUNCTION(BlueprintCallable, Category="Weapon")
     void AttachWeapon(ADasherCharacter* TargetCharacter, bool IsFirstPerson);
 
-    /** Make the weapon Fire a Projectile */
+    /** Plays the cosmetics of a shot, the projectiles are fired by the server. A shooter's client predicts the projectile of a numbered shot */
     UFUNCTION(BlueprintCallable, Category="Weapon")
-    void Fire();
+    void Fire(int32 ShotId = -1);
+
+    /**
+     * Plays the fire sound and montage, as much of them as the shooter's significance allows. The shooter's own machine
+     * plays them from Fire with the arms montage, other machines when the shooter's server shot count replicates, with the
+     * third person montage. Not on dedicated servers
+     */
+    void PlayFireCosmetics();
+
+    /** Fires a projectile for every shot of the batch the fire rate allows, on the server. Returns how many were fired */
+    int32 ServerFireBatch(const FDasherShotBatch& Shots);
 
-    /** Make the weapon Fire a Projectile on the server */
-    UFUNCTION(Server, Reliable)
-    void ServerFire();
+    /** Fires an instant hit on the server, checking characters where they were at the client's timestamp */
+    void ServerHitscanFire(const FVector& Start, const FVector& Direction, double ClientTimestamp);
+
+    /** Returns the least time between two hitscan shots */
+    double GetHitscanInterval() const { return 1.0 / FMath::Max(HitscanFireRate, 0.1f); }
+
+    /** Returns the projectile class once loaded, null before the weapon is picked up */
+    TSubclassOf<ADasherProjectile> GetProjectileClass() const { return Stats.ProjectileClass; }
+
+    /** Returns what firing uses, resolved once the weapon's assets are loaded */
+    const FDasherWeaponStats& GetStats() const { return Stats; }
+
+    /** Returns the character holding the weapon, null until it is picked up */
+    ADasherCharacter* GetCharacter() const { return Character; }
 
 private:
+    /** Loads what this machine needs of the weapon's assets: the projectile class right away with authority, the cosmetics asynchronously on clients */
+    void LoadAssets();
+
+    /** Returns the Asset Manager ID of the weapon's assets: its definition's, or its class', registered from its properties the first time */
+    FPrimaryAssetId GetWeaponAssetId() const;
+
+    /** Flattens the definition, or the properties without one, into Stats */
+    void OnAssetsLoaded();
+
+    /** Moves a shot Distance along its aim from the muzzle, stopping where its projectile would hit something on the way */
+    FVector AdvanceShot(const FVector& MuzzleLocation, const FVector& Direction, float Distance) const;
+
+    /** Fires a local projectile for a shot ahead of the server's, on the shooter's client */
+    void FirePredictedProjectile(uint8 ShotId);
+
+    /** Whether this machine fires the weapon's projectiles, itself or ahead of the server */
+    bool FiresProjectiles() const;
+
     /** The Character holding this weapon*/
     ADasherCharacter* Character;
+
+    /** Keeps the loaded assets in memory for as long as the weapon is around */
+    TSharedPtr<FStreamableHandle> AssetsHandle;
+
+    /** Resolved once loaded, so firing neither looks soft references up nor reads the definition */
+    UPROPERTY(Transient)
+    FDasherWeaponStats Stats;
+
+    /** Time of the last shot the server fired */
+    double LastServerShotTime;
+
+    /** Time the server's last hitscan shot was scheduled at, up to an interval ahead of when it came in */
+    double LastServerHitscanTime;
 };
@@ -0,0 +1,23 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherActorChannel.h"
+
+#include "Core/DasherPerfCounters.h"
+
+#include "Net/DataBunch.h"
+
+UDasherActorChannel::UDasherActorChannel(const FObjectInitializer& ObjectInitializer)
+    : Super(ObjectInitializer)
+{
+}
+
+FPacketIdRange UDasherActorChannel::SendBunch(FOutBunch* Bunch, bool Merge)
+{
+    // Property updates and RPCs alike, the bunch header isn't counted. Only while the overlay shows them
+    if (FDasherPerfCounters::ShouldCountSentBytes() && Actor != nullptr && Bunch != nullptr && !Bunch->IsError())
+    {
+        FDasherPerfCounters::Get().SentBytesByClass.FindOrAdd(Actor->GetClass()) += Bunch->GetNumBytes();
+    }
+
+    return Super::SendBunch(Bunch, Merge);
+}
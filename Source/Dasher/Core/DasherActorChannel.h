@@ -0,0 +1,25 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/ActorChannel.h"
+#include "DasherActorChannel.generated.h"
+
+/**
+ * Actor channel that counts the bytes it sends by actor class while the perf overlay is on.
+ * Replaces the engine's actor channel in the net driver's channel definitions, see DefaultEngine.ini.
+ */
+UCLASS(transient, customConstructor)
+class DASHER_API UDasherActorChannel : public UActorChannel
+{
+    GENERATED_BODY()
+
+public:
+
+    UDasherActorChannel(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+    // UChannel interface
+    virtual FPacketIdRange SendBunch(FOutBunch* Bunch, bool Merge) override;
+    // End of UChannel interface
+};
@@ -0,0 +1,301 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherAllocationTracker.h"
+
+#include "Dasher.h"
+
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformStackWalk.h"
+#include "Misc/CommandLine.h"
+#include "UObject/Class.h"
+#include "UObject/UObjectArray.h"
+
+int32 FDasherAllocationTracker::ScopeDepth = 0;
+std::atomic<bool> FDasherAllocationTracker::bTracking(false);
+
+#if DASHER_ALLOCATION_TRACKING
+
+/** What was counted since the tracker started, the game thread counts are written by the game thread only */
+struct FDasherAllocationCounts
+{
+    static constexpr int32 MaxStackDepth = 32;
+
+    uint64 NumAllocations = 0;
+    uint64 NumScopedAllocations = 0;
+    uint64 NumBytes = 0;
+    uint64 NumObjects = 0;
+
+    uint64 FirstAllocationStack[MaxStackDepth];
+    uint32 FirstAllocationStackDepth = 0;
+    SIZE_T FirstAllocationSize = 0;
+
+    FName FirstObjectClass;
+};
+
+static FDasherAllocationCounts AllocationCounts;
+static std::atomic<uint64> NumOtherThreadAllocations(0);
+
+/** Forwards everything to the allocator it wraps, counting the allocations made while tracking */
+class FDasherCountingMalloc final : public FMalloc
+{
+public:
+
+    explicit FDasherCountingMalloc(FMalloc* InInner)
+        : Inner(InInner)
+    {
+    }
+
+    virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+    {
+        CountAllocation(Count);
+        return Inner->Malloc(Count, Alignment);
+    }
+
+    virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+    {
+        CountAllocation(Count);
+        return Inner->TryMalloc(Count, Alignment);
+    }
+
+    virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+    {
+        // Growing or shrinking may move the block, only a realloc to zero is a plain free
+        if (Count > 0)
+        {
+            CountAllocation(Count);
+        }
+        return Inner->Realloc(Original, Count, Alignment);
+    }
+
+    virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+    {
+        if (Count > 0)
+        {
+            CountAllocation(Count);
+        }
+        return Inner->TryRealloc(Original, Count, Alignment);
+    }
+
+    virtual void Free(void* Original) override { Inner->Free(Original); }
+    virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+    virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+    virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+    virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+    virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+    virtual void InitializeStatsMetadata() override { Inner->InitializeStatsMetadata(); }
+    virtual void UpdateStats() override { Inner->UpdateStats(); }
+    virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+    virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+    virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+    virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+    virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+    virtual void OnMallocInitialized() override { Inner->OnMallocInitialized(); }
+    virtual void OnPreFork() override { Inner->OnPreFork(); }
+    virtual void OnPostFork() override { Inner->OnPostFork(); }
+
+    FMalloc* const Inner;
+
+private:
+
+    static void CountAllocation(SIZE_T Size)
+    {
+        if (!FDasherAllocationTracker::IsTracking())
+        {
+            return;
+        }
+
+        if (!IsInGameThread())
+        {
+            NumOtherThreadAllocations.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        if (AllocationCounts.NumAllocations == 0)
+        {
+            // Capturing uses the system allocator, not GMalloc, so it can't come back here
+            AllocationCounts.FirstAllocationSize = Size;
+            AllocationCounts.FirstAllocationStackDepth = FPlatformStackWalk::CaptureStackBackTrace(AllocationCounts.FirstAllocationStack, FDasherAllocationCounts::MaxStackDepth);
+        }
+        ++AllocationCounts.NumAllocations;
+        AllocationCounts.NumBytes += Size;
+
+        // Other threads never touch the scope depth, so it is only read on the game thread
+        if (FDasherAllocationTracker::ScopeDepth > 0)
+        {
+            ++AllocationCounts.NumScopedAllocations;
+        }
+    }
+};
+
+/** Counts the UObjects created on the game thread while tracking */
+class FDasherObjectCreateListener final : public FUObjectArray::FUObjectCreateListener
+{
+public:
+
+    virtual void NotifyUObjectCreated(const UObjectBase* Object, int32 Index) override
+    {
+        if (!IsInGameThread() || !FDasherAllocationTracker::IsTracking())
+        {
+            return;
+        }
+
+        if (AllocationCounts.NumObjects == 0)
+        {
+            AllocationCounts.FirstObjectClass = Object->GetClass()->GetFName();
+        }
+        ++AllocationCounts.NumObjects;
+    }
+
+    virtual void OnUObjectArrayShutdown() override
+    {
+        GUObjectArray.RemoveUObjectCreateListener(this);
+    }
+};
+
+/** Installed once at startup and never deleted, other threads may hold on to it at any time */
+static FDasherCountingMalloc* CountingMalloc = nullptr;
+static FDasherObjectCreateListener ObjectCreateListener;
+
+#endif // DASHER_ALLOCATION_TRACKING
+
+void FDasherAllocationTracker::Install()
+{
+#if DASHER_ALLOCATION_TRACKING && !PLATFORM_USES_FIXED_GMalloc_CLASS
+    check(IsInGameThread());
+    if (CountingMalloc != nullptr || !FParse::Param(FCommandLine::Get(), TEXT("DasherTrackAllocations")))
+    {
+        return;
+    }
+
+    // Blocks allocated before this are freed through the proxy, which hands them back to the allocator they came from
+    CountingMalloc = new FDasherCountingMalloc(GMalloc);
+    GMalloc = CountingMalloc;
+    UE_LOG(LogDasher, Log, TEXT("Allocation tracking installed around %s"), CountingMalloc->Inner->GetDescriptiveName());
+#endif
+}
+
+bool FDasherAllocationTracker::CanTrack()
+{
+#if DASHER_ALLOCATION_TRACKING && !PLATFORM_USES_FIXED_GMalloc_CLASS
+    return CountingMalloc != nullptr;
+#else
+    return false;
+#endif
+}
+
+bool FDasherAllocationTracker::Start()
+{
+#if DASHER_ALLOCATION_TRACKING && !PLATFORM_USES_FIXED_GMalloc_CLASS
+    check(IsInGameThread());
+    if (IsTracking())
+    {
+        return true;
+    }
+
+    if (CountingMalloc == nullptr)
+    {
+        UE_LOG(LogDasher, Warning, TEXT("Allocations are only tracked when started with -DasherTrackAllocations"));
+        return false;
+    }
+
+    AllocationCounts = FDasherAllocationCounts();
+    NumOtherThreadAllocations.store(0, std::memory_order_relaxed);
+    GUObjectArray.AddUObjectCreateListener(&ObjectCreateListener);
+
+    bTracking.store(true, std::memory_order_relaxed);
+    return true;
+#else
+    UE_LOG(LogDasher, Warning, TEXT("Allocations can't be tracked in this build"));
+    return false;
+#endif
+}
+
+void FDasherAllocationTracker::Stop()
+{
+#if DASHER_ALLOCATION_TRACKING && !PLATFORM_USES_FIXED_GMalloc_CLASS
+    check(IsInGameThread());
+    if (!IsTracking())
+    {
+        return;
+    }
+    bTracking.store(false, std::memory_order_relaxed);
+
+    GUObjectArray.RemoveUObjectCreateListener(&ObjectCreateListener);
+#endif
+}
+
+uint64 FDasherAllocationTracker::GetNumAllocations()
+{
+#if DASHER_ALLOCATION_TRACKING
+    return AllocationCounts.NumAllocations;
+#else
+    return 0;
+#endif
+}
+
+uint64 FDasherAllocationTracker::GetNumScopedAllocations()
+{
+#if DASHER_ALLOCATION_TRACKING
+    return AllocationCounts.NumScopedAllocations;
+#else
+    return 0;
+#endif
+}
+
+uint64 FDasherAllocationTracker::GetNumOtherThreadAllocations()
+{
+#if DASHER_ALLOCATION_TRACKING
+    return NumOtherThreadAllocations.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+uint64 FDasherAllocationTracker::GetNumAllocatedBytes()
+{
+#if DASHER_ALLOCATION_TRACKING
+    return AllocationCounts.NumBytes;
+#else
+    return 0;
+#endif
+}
+
+uint64 FDasherAllocationTracker::GetNumObjects()
+{
+#if DASHER_ALLOCATION_TRACKING
+    return AllocationCounts.NumObjects;
+#else
+    return 0;
+#endif
+}
+
+void FDasherAllocationTracker::LogReport(const TCHAR* What)
+{
+#if DASHER_ALLOCATION_TRACKING
+    const bool bClean = AllocationCounts.NumAllocations == 0 && AllocationCounts.NumObjects == 0;
+    UE_LOG(LogDasher, Log, TEXT("%s: %llu heap allocations on the game thread (%llu bytes, %llu in Dasher's hot paths), %llu new objects, %llu heap allocations on other threads"), What,
+        AllocationCounts.NumAllocations, AllocationCounts.NumBytes, AllocationCounts.NumScopedAllocations, AllocationCounts.NumObjects,
+        NumOtherThreadAllocations.load(std::memory_order_relaxed));
+    if (bClean)
+    {
+        return;
+    }
+
+    if (AllocationCounts.NumObjects > 0)
+    {
+        UE_LOG(LogDasher, Warning, TEXT("First new object was a %s"), *AllocationCounts.FirstObjectClass.ToString());
+    }
+
+    if (AllocationCounts.NumAllocations > 0)
+    {
+        UE_LOG(LogDasher, Warning, TEXT("First heap allocation was %llu bytes, from:"), static_cast<uint64>(AllocationCounts.FirstAllocationSize));
+        for (uint32 Depth = 0; Depth < AllocationCounts.FirstAllocationStackDepth; ++Depth)
+        {
+            ANSICHAR Frame[1024];
+            Frame[0] = '\0';
+            FPlatformStackWalk::ProgramCounterToHumanReadableString(Depth, AllocationCounts.FirstAllocationStack[Depth], Frame, sizeof(Frame));
+            UE_LOG(LogDasher, Warning, TEXT("    %s"), ANSI_TO_TCHAR(Frame));
+        }
+    }
+#endif
+}
@@ -0,0 +1,85 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <atomic>
+
+/** Allocation tracking wraps the allocator, which shipping builds don't allow */
+#define DASHER_ALLOCATION_TRACKING (!UE_BUILD_SHIPPING)
+
+/**
+ * Counts the heap allocations and new UObjects made while tracking, to check that hot paths stay allocation-free once
+ * warmed up. Everything the game thread allocates between Start and Stop counts, including the engine's work on our
+ * behalf such as projectile movement, actor channels and replication; DASHER_ALLOCATION_SCOPE only tells apart what our
+ * own hot paths allocated. Allocations on other threads are counted separately, render and audio threads allocate
+ * whatever the game does.
+ * Counting needs a proxy around GMalloc, which is only installed at startup with -DasherTrackAllocations and never
+ * removed: it forwards everything to the allocator it wraps, so blocks allocated before it went in are freed by the same
+ * allocator. Without the switch CanTrack is false and Start fails. For sizes and callstacks of every allocation across
+ * all threads, use the Insights memory trace (-trace=memory) instead.
+ * The callstack of the first game thread allocation is kept, so the report says where it came from.
+ * Start, Stop and the counts are game thread only.
+ */
+class DASHER_API FDasherAllocationTracker
+{
+public:
+
+    /** Wraps GMalloc in the counting proxy, once, if the command line has -DasherTrackAllocations. Called at startup */
+    static void Install();
+
+    /** Starts counting from zero, returns false if allocations can't be tracked in this process */
+    static bool Start();
+
+    /** Stops counting, the counts are kept until the next start */
+    static void Stop();
+
+    static bool IsTracking() { return bTracking.load(std::memory_order_relaxed); }
+
+    /** Returns false unless the proxy was installed at startup, Start fails then */
+    static bool CanTrack();
+
+    /** Heap allocations and reallocations counted on the game thread since the last start */
+    static uint64 GetNumAllocations();
+
+    /** The part of GetNumAllocations made inside DASHER_ALLOCATION_SCOPE */
+    static uint64 GetNumScopedAllocations();
+
+    /** Heap allocations and reallocations counted on other threads since the last start */
+    static uint64 GetNumOtherThreadAllocations();
+
+    /** Bytes asked for by the counted game thread allocations */
+    static uint64 GetNumAllocatedBytes();
+
+    /** UObjects created on the game thread since the last start */
+    static uint64 GetNumObjects();
+
+    /** Logs the counts, and the callstack and object of the first counted allocations if there were any */
+    static void LogReport(const TCHAR* What);
+
+    /** Marks the scope as one of our hot paths, see DASHER_ALLOCATION_SCOPE */
+    struct FScope
+    {
+        FORCEINLINE FScope() { ++ScopeDepth; }
+        FORCEINLINE ~FScope() { --ScopeDepth; }
+    };
+
+private:
+
+    /** Only the game thread opens scopes, so it is only read there */
+    static int32 ScopeDepth;
+
+    /** Read by every thread that allocates */
+    static std::atomic<bool> bTracking;
+
+    friend class FDasherCountingMalloc;
+    friend class FDasherObjectCreateListener;
+};
+
+#if DASHER_ALLOCATION_TRACKING
+/** Attributes the game thread allocations of the enclosing scope to our hot paths while FDasherAllocationTracker is tracking */
+#define DASHER_ALLOCATION_SCOPE() FDasherAllocationTracker::FScope PREPROCESSOR_JOIN(DasherAllocationScope, __LINE__)
+#else
+#define DASHER_ALLOCATION_SCOPE()
+#endif
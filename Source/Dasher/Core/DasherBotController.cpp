@@ -0,0 +1,161 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherBotController.h"
+
+#include "Characters/DasherCharacter.h"
+
+#include "InputActionValue.h"
+
+ADasherBotController::ADasherBotController()
+{
+    PrimaryActorTick.bCanEverTick = true;
+
+    // Bots show up in the game state like players do
+    bWantsPlayerState = true;
+
+    // The control rotation is turned by the character's Look handler, the pawn follows it
+    bSetControlRotationFromPawnOrientation = false;
+
+    Pattern = EDasherBotPattern::RandomWalk;
+    TargetYaw = 0.f;
+    NextWaypoint = 0;
+    TimeUntilDecision = 0.f;
+    TimeUntilFire = 0.f;
+    TimeBlocked = 0.f;
+    bSprinting = false;
+    bCrouching = false;
+    bFiring = false;
+}
+
+void ADasherBotController::InitializeBot(int32 Seed, EDasherBotPattern InPattern)
+{
+    Random.Initialize(Seed);
+    Pattern = InPattern;
+
+    // Spread bots along the loop so they don't walk it in a single file
+    NextWaypoint = Waypoints.Num() > 0 ? Random.RandHelper(Waypoints.Num()) : 0;
+}
+
+void ADasherBotController::SetChances(float InSprintChance, float InCrouchChance, float InFireChance)
+{
+    SprintChance = InSprintChance;
+    CrouchChance = InCrouchChance;
+    FireChance = InFireChance;
+
+    // Rolled again right away rather than at the end of the current interval
+    TimeUntilDecision = 0.f;
+}
+
+void ADasherBotController::OnPossess(APawn* InPawn)
+{
+    Super::OnPossess(InPawn);
+
+    TargetYaw = InPawn->GetActorRotation().Yaw;
+    SetControlRotation(FRotator(0.f, TargetYaw, 0.f));
+}
+
+void ADasherBotController::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    ADasherCharacter* DasherCharacter = Cast<ADasherCharacter>(GetPawn());
+    if (DasherCharacter == nullptr)
+    {
+        return;
+    }
+
+    TimeUntilDecision -= DeltaSeconds;
+    if (TimeUntilDecision <= 0.f)
+    {
+        TimeUntilDecision += DecisionInterval;
+        Decide(DasherCharacter);
+    }
+
+    // Turn towards the heading no faster than a player would flick
+    const float DesiredYaw = UpdateTargetYaw(DasherCharacter, DeltaSeconds);
+    const float MaxTurn = TurnRate * DeltaSeconds;
+    const float YawDelta = FMath::Clamp(FMath::FindDeltaAngleDegrees(GetControlRotation().Yaw, DesiredYaw), -MaxTurn, MaxTurn);
+    if (!FMath::IsNearlyZero(YawDelta))
+    {
+        DasherCharacter->Look(FInputActionValue(FVector2D(YawDelta, 0.f)));
+    }
+
+    // Always walking forward, the heading does the steering
+    DasherCharacter->Move(FInputActionValue(FVector2D(0.f, 1.f)));
+
+    // Sprint is a triggered action, it has to be held every frame
+    if (bSprinting)
+    {
+        DasherCharacter->Sprint(FInputActionValue(true));
+    }
+
+    if (bFiring)
+    {
+        TimeUntilFire -= DeltaSeconds;
+        if (TimeUntilFire <= 0.f)
+        {
+            TimeUntilFire += FireInterval;
+            DasherCharacter->Fire(FInputActionValue(true));
+        }
+    }
+}
+
+void ADasherBotController::Decide(ADasherCharacter* DasherCharacter)
+{
+    const bool bWantsToSprint = Random.FRand() < SprintChance;
+    if (bSprinting && !bWantsToSprint)
+    {
+        DasherCharacter->StopSprinting(FInputActionValue(false));
+    }
+    bSprinting = bWantsToSprint;
+
+    const bool bWantsToCrouch = !bSprinting && Random.FRand() < CrouchChance;
+    if (bWantsToCrouch && !bCrouching)
+    {
+        DasherCharacter->TryCrouch(FInputActionValue(true));
+    }
+    else if (!bWantsToCrouch && bCrouching)
+    {
+        DasherCharacter->TryUnCrouch(FInputActionValue(false));
+    }
+    bCrouching = bWantsToCrouch;
+
+    const bool bWantsToFire = Random.FRand() < FireChance;
+    if (bWantsToFire && !bFiring)
+    {
+        TimeUntilFire = 0.f;
+    }
+    bFiring = bWantsToFire;
+
+    if (Pattern == EDasherBotPattern::RandomWalk)
+    {
+        TargetYaw = FRotator::NormalizeAxis(TargetYaw + Random.FRandRange(-90.f, 90.f));
+    }
+}
+
+float ADasherBotController::UpdateTargetYaw(const ADasherCharacter* DasherCharacter, float DeltaSeconds)
+{
+    const FVector Location = DasherCharacter->GetActorLocation();
+
+    if (Pattern == EDasherBotPattern::Waypoints && Waypoints.Num() > 0)
+    {
+        FVector ToWaypoint = Waypoints[NextWaypoint] - Location;
+        if (ToWaypoint.SizeSquared2D() < FMath::Square(WaypointAcceptanceRadius))
+        {
+            NextWaypoint = (NextWaypoint + 1) % Waypoints.Num();
+            ToWaypoint = Waypoints[NextWaypoint] - Location;
+        }
+        TargetYaw = ToWaypoint.Rotation().Yaw;
+        return TargetYaw;
+    }
+
+    // Turn around when walking into a wall, the character barely moves while it pushes against it
+    const bool bBlocked = DasherCharacter->GetVelocity().SizeSquared2D() < FMath::Square(10.f);
+    TimeBlocked = bBlocked ? TimeBlocked + DeltaSeconds : 0.f;
+    if (TimeBlocked > 0.5f)
+    {
+        TargetYaw = FRotator::NormalizeAxis(TargetYaw + Random.FRandRange(90.f, 270.f));
+        TimeBlocked = 0.f;
+    }
+    return TargetYaw;
+}
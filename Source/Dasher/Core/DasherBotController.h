@@ -0,0 +1,101 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "DasherBotController.generated.h"
+
+class ADasherCharacter;
+
+/** How a bot picks where to go */
+UENUM()
+enum class EDasherBotPattern : uint8
+{
+    /** Walks in a random direction, turning every now and then or when blocked */
+    RandomWalk,
+    /** Walks the configured waypoint loop */
+    Waypoints
+};
+
+/**
+ * Server-side bot for load testing.
+ * Plays an ADasherCharacter through the same input handlers a player's input actions call, so bots cost the server
+ * what players do: predicted movement, look replication, sprinting, crouching and firing.
+ * All random choices come from a seeded stream, so a run with the same seed makes the same decisions.
+ */
+UCLASS(config=Game)
+class DASHER_API ADasherBotController : public AAIController
+{
+    GENERATED_BODY()
+
+public:
+
+    ADasherBotController();
+
+    /** Seeds the bot's decisions and picks its pattern, call before it possesses a character */
+    void InitializeBot(int32 Seed, EDasherBotPattern InPattern);
+
+    /** Replaces the configured sprint, crouch and fire chances, for scenarios that need every bot doing the same */
+    void SetChances(float InSprintChance, float InCrouchChance, float InFireChance);
+
+    virtual void Tick(float DeltaSeconds) override;
+
+protected:
+
+    virtual void OnPossess(APawn* InPawn) override;
+
+    /** Waypoint loop walked by bots with the Waypoints pattern, in world space */
+    UPROPERTY(Config)
+    TArray<FVector> Waypoints;
+
+    /** How close to a waypoint counts as reaching it */
+    UPROPERTY(Config)
+    float WaypointAcceptanceRadius = 150.f;
+
+    /** Fastest the bot turns, in degrees per second */
+    UPROPERTY(Config)
+    float TurnRate = 180.f;
+
+    /** How often the bot rethinks sprinting, crouching, firing and, for random walks, its heading */
+    UPROPERTY(Config)
+    float DecisionInterval = 2.f;
+
+    /** Chance to sprint for the next decision interval */
+    UPROPERTY(Config)
+    float SprintChance = 0.3f;
+
+    /** Chance to crouch for the next decision interval */
+    UPROPERTY(Config)
+    float CrouchChance = 0.1f;
+
+    /** Chance to hold the trigger for the next decision interval */
+    UPROPERTY(Config)
+    float FireChance = 0.5f;
+
+    /** Seconds between shots while the trigger is held */
+    UPROPERTY(Config)
+    float FireInterval = 0.25f;
+
+private:
+
+    /** Rolls the choices for the next decision interval */
+    void Decide(ADasherCharacter* DasherCharacter);
+
+    /** Returns the yaw the bot wants to face */
+    float UpdateTargetYaw(const ADasherCharacter* DasherCharacter, float DeltaSeconds);
+
+    FRandomStream Random;
+
+    EDasherBotPattern Pattern;
+
+    float TargetYaw;
+    int32 NextWaypoint;
+    float TimeUntilDecision;
+    float TimeUntilFire;
+    float TimeBlocked;
+
+    bool bSprinting;
+    bool bCrouching;
+    bool bFiring;
+};
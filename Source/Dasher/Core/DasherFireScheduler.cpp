@@ -0,0 +1,116 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherFireScheduler.h"
+
+//////////////////////////////////////////////////////////////////////////
+// FDasherShotBatch
+
+bool FDasherShotBatch::Add(uint8 ShotId, double ShotTime)
+{
+    if (NumShots == 0)
+    {
+        FirstShotId = ShotId;
+        FirstShotTime = ShotTime;
+        ShotOffsetsMs[NumShots++] = 0;
+        return true;
+    }
+
+    const int64 OffsetMs = FMath::RoundToInt64((ShotTime - FirstShotTime) * 1000.0);
+    if (NumShots >= MaxShots || OffsetMs > MAX_uint16 || ShotId != GetShotId(NumShots))
+    {
+        return false;
+    }
+
+    // Shots queued in the same frame share its time, they never go back in time
+    ShotOffsetsMs[NumShots] = static_cast<uint16>(FMath::Max<int64>(OffsetMs, ShotOffsetsMs[NumShots - 1]));
+    ++NumShots;
+    return true;
+}
+
+int32 FDasherShotBatch::GetNetSize() const
+{
+    // 5 bits of count, the first shot's ID and time and the other shots' offsets
+    return NumShots > 0 ? 1 + sizeof(FirstShotId) + sizeof(FirstShotTime) + (NumShots - 1) * sizeof(uint16) : 1;
+}
+
+bool FDasherShotBatch::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+    uint32 Count = NumShots;
+    Ar.SerializeInt(Count, MaxShots + 1);
+    if (Ar.IsLoading())
+    {
+        NumShots = static_cast<uint8>(FMath::Min<uint32>(Count, MaxShots));
+    }
+
+    if (NumShots > 0)
+    {
+        Ar << FirstShotId;
+        Ar << FirstShotTime;
+        ShotOffsetsMs[0] = 0;
+        for (int32 Index = 1; Index < NumShots; ++Index)
+        {
+            Ar << ShotOffsetsMs[Index];
+        }
+    }
+
+    bOutSuccess = !Ar.IsError();
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FDasherFireScheduler
+
+void FDasherFireScheduler::PullTrigger(double Now, float FireInterval)
+{
+    LastPullFrame = GFrameCounter;
+
+    if (FireInterval <= 0.f)
+    {
+        NumQueuedShots = FMath::Min(NumQueuedShots + 1, FDasherShotBatch::MaxShots);
+        return;
+    }
+
+    // A new pull fires right away once the weapon has cooled down
+    if (!bTriggerHeld)
+    {
+        bTriggerHeld = true;
+        NextShotTime = FMath::Max(NextShotTime, Now);
+    }
+}
+
+void FDasherFireScheduler::ReleaseTrigger()
+{
+    bTriggerHeld = false;
+}
+
+bool FDasherFireScheduler::TakeDueShot(double Now, float FireInterval, double& OutShotTime)
+{
+    if (NumQueuedShots > 0)
+    {
+        --NumQueuedShots;
+        OutShotTime = Now;
+        return true;
+    }
+
+    if (!bTriggerHeld || FireInterval <= 0.f)
+    {
+        return false;
+    }
+
+    // Fire input comes every frame the trigger is held, a frame without it let go
+    if (GFrameCounter > LastPullFrame + 1)
+    {
+        bTriggerHeld = false;
+        return false;
+    }
+
+    if (NextShotTime > Now)
+    {
+        return false;
+    }
+
+    NextShotTime = FMath::Max(NextShotTime, Now - MaxShotsBehind * FireInterval);
+    OutShotTime = NextShotTime;
+    NextShotTime += FireInterval;
+    return true;
+}
@@ -0,0 +1,91 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DasherFireScheduler.generated.h"
+
+/**
+ * Shots fired since the last ServerFireBatch, at the server world time the shooter fired them. Shots are numbered by
+ * the shooter, so the projectiles it predicted can be matched with the server's, and a batch holds consecutive ones.
+ * Serialized as the shot count, the first shot's ID and time, and a 16 bit millisecond offset for each of the others.
+ */
+USTRUCT()
+struct DASHER_API FDasherShotBatch
+{
+    GENERATED_BODY()
+
+    static constexpr int32 MaxShots = 16;
+
+    /** Adds the shot following the previous one, no earlier than it. Returns false if it doesn't fit and the batch has to be sent first */
+    bool Add(uint8 ShotId, double ShotTime);
+
+    int32 Num() const { return NumShots; }
+
+    double GetShotTime(int32 Index) const { return FirstShotTime + ShotOffsetsMs[Index] * 0.001; }
+
+    uint8 GetShotId(int32 Index) const { return static_cast<uint8>(FirstShotId + Index); }
+
+    void Reset() { NumShots = 0; }
+
+    /** Bytes the batch takes on the wire, rounded up */
+    int32 GetNetSize() const;
+
+    bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+private:
+
+    double FirstShotTime = 0.0;
+    uint16 ShotOffsetsMs[MaxShots] = {};
+    uint8 FirstShotId = 0;
+    uint8 NumShots = 0;
+};
+
+template<>
+struct TStructOpsTypeTraits<FDasherShotBatch> : public TStructOpsTypeTraitsBase2<FDasherShotBatch>
+{
+    enum
+    {
+        WithNetSerializer = true,
+    };
+};
+
+/**
+ * Turns fire input into shots on a fixed timestep at the weapon's fire interval, whatever the frame rate.
+ * The trigger stays held for as long as fire input comes every frame. Every shot due since the last update is taken at
+ * the time it was due, so a frame rate below the fire rate fires several shots in a frame instead of firing slower.
+ * Releasing the trigger keeps the interval, tapping can't fire faster than holding.
+ * Weapons without a fire interval fire once per fire input instead.
+ */
+class DASHER_API FDasherFireScheduler
+{
+public:
+
+    /** Shots a hitch can leave behind, the ones due before that are dropped. Also bounds how far behind the server accepts shots */
+    static constexpr int32 MaxShotsBehind = 4;
+
+    /** Fire input for this frame */
+    void PullTrigger(double Now, float FireInterval);
+
+    /** Fire input stopped */
+    void ReleaseTrigger();
+
+    /** Takes the next shot due by Now, returns false once there are none left */
+    bool TakeDueShot(double Now, float FireInterval, double& OutShotTime);
+
+    /** Whether the trigger is held or shots are waiting to be taken */
+    bool IsActive() const { return bTriggerHeld || NumQueuedShots > 0; }
+
+private:
+
+    /** Time the next shot is due at, later than now while the weapon cools down */
+    double NextShotTime = 0.0;
+
+    /** Frame of the last fire input */
+    uint64 LastPullFrame = 0;
+
+    /** Fire inputs of weapons without a fire interval, not taken yet */
+    int32 NumQueuedShots = 0;
+
+    bool bTriggerHeld = false;
+};
@@ -2,13 +2,72 @@
 
 #include "DasherGameMode.h"
 #include "Characters/DasherCharacter.h"
-#include "UObject/ConstructorHelpers.h"
+#include "Core/DasherSwarmPlayerController.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "GameFramework/DefaultPawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Kismet/GameplayStatics.h"
 
 ADasherGameMode::ADasherGameMode()
     : Super()
 {
-    // set default pawn class to our Blueprinted character
-    static ConstructorHelpers::FClassFinder<APawn> PlayerPawnClassFinder(TEXT("/Game/FirstPerson/Blueprints/BP_FirstPersonCharacter"));
-    DefaultPawnClass = PlayerPawnClassFinder.Class;
+}
+
+void ADasherGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+    Super::InitGame(MapName, Options, ErrorMessage);
+
+    // set default pawn class to our Blueprinted character, unless a Blueprinted game mode picked one. It streams in
+    // while the map finishes loading, a synchronous load here would stall the game thread
+    if (DefaultPawnClass == ADefaultPawn::StaticClass() && !PlayerPawnClass.IsNull())
+    {
+        PlayerPawnClassHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(PlayerPawnClass.ToSoftObjectPath(),
+            FStreamableDelegate::CreateUObject(this, &ADasherGameMode::OnPlayerPawnClassLoaded), FStreamableManager::AsyncLoadHighPriority);
+
+        // Nothing to load, take whatever is in memory
+        if (!PlayerPawnClassHandle.IsValid())
+        {
+            OnPlayerPawnClassLoaded();
+        }
+    }
+}
+
+void ADasherGameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
+{
+    // Spawning now would give the player the placeholder pawn
+    if (PlayerPawnClassHandle.IsValid() && PlayerPawnClassHandle->IsLoadingInProgress())
+    {
+        PlayersWaitingForPawnClass.Add(NewPlayer);
+        return;
+    }
 
+    Super::HandleStartingNewPlayer_Implementation(NewPlayer);
+}
+
+void ADasherGameMode::OnPlayerPawnClassLoaded()
+{
+    if (UClass* PawnClass = PlayerPawnClass.Get())
+    {
+        DefaultPawnClass = PawnClass;
+    }
+
+    for (const TWeakObjectPtr<APlayerController>& Player : PlayersWaitingForPawnClass)
+    {
+        if (Player.IsValid())
+        {
+            Super::HandleStartingNewPlayer_Implementation(Player.Get());
+        }
+    }
+    PlayersWaitingForPawnClass.Empty();
+}
+
+APlayerController* ADasherGameMode::SpawnPlayerController(ENetRole InRemoteRole, const FString& Options)
+{
+    // Connections from a swarm process need a controller that can share its client world
+    if (UGameplayStatics::HasOption(Options, TEXT("DasherSwarm")))
+    {
+        return SpawnPlayerControllerCommon(InRemoteRole, FVector::ZeroVector, FRotator::ZeroRotator, ADasherSwarmPlayerController::StaticClass());
+    }
+    return Super::SpawnPlayerController(InRemoteRole, Options);
 }
@@ -6,13 +6,41 @@
 #include "GameFramework/GameModeBase.h"
 #include "DasherGameMode.generated.h"
 
-UCLASS(minimalapi)
+struct FStreamableHandle;
+
+UCLASS(minimalapi, config=Game)
 class ADasherGameMode : public AGameModeBase
 {
     GENERATED_BODY()
 
 public:
     ADasherGameMode();
+
+    // AGameModeBase interface
+    virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+    virtual APlayerController* SpawnPlayerController(ENetRole InRemoteRole, const FString& Options) override;
+    virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
+    // End of AGameModeBase interface
+
+protected:
+
+    /**
+     * Pawn for players when DefaultPawnClass isn't set, streamed in through the Asset Manager when the game starts instead
+     * of with the module. Players who join before it is in wait for it to spawn
+     */
+    UPROPERTY(Config)
+    TSoftClassPtr<APawn> PlayerPawnClass;
+
+private:
+
+    /** Makes the loaded PlayerPawnClass the default pawn and starts the players who waited for it */
+    void OnPlayerPawnClassLoaded();
+
+    /** Keeps PlayerPawnClass in memory for as long as the game mode is around, loading while it is active */
+    TSharedPtr<FStreamableHandle> PlayerPawnClassHandle;
+
+    /** Players who joined while PlayerPawnClass was loading */
+    TArray<TWeakObjectPtr<APlayerController>> PlayersWaitingForPawnClass;
 };
 
 
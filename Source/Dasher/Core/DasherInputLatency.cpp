@@ -0,0 +1,254 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherInputLatency.h"
+
+#include "Dasher.h"
+#include "Characters/DasherCharacter.h"
+#include "Core/DasherTelemetry.h"
+
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/Actor.h"
+
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Fire Latency P50 (ms)"), STAT_DasherFireLatencyP50, STATGROUP_Dasher);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Fire Latency P95 (ms)"), STAT_DasherFireLatencyP95, STATGROUP_Dasher);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Fire Latency P99 (ms)"), STAT_DasherFireLatencyP99, STATGROUP_Dasher);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Look Latency P50 (ms)"), STAT_DasherLookLatencyP50, STATGROUP_Dasher);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Look Latency P95 (ms)"), STAT_DasherLookLatencyP95, STATGROUP_Dasher);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Look Latency P99 (ms)"), STAT_DasherLookLatencyP99, STATGROUP_Dasher);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Sprint Latency P50 (ms)"), STAT_DasherSprintLatencyP50, STATGROUP_Dasher);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Sprint Latency P95 (ms)"), STAT_DasherSprintLatencyP95, STATGROUP_Dasher);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Sprint Latency P99 (ms)"), STAT_DasherSprintLatencyP99, STATGROUP_Dasher);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Crouch Latency P50 (ms)"), STAT_DasherCrouchLatencyP50, STATGROUP_Dasher);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Crouch Latency P95 (ms)"), STAT_DasherCrouchLatencyP95, STATGROUP_Dasher);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Crouch Latency P99 (ms)"), STAT_DasherCrouchLatencyP99, STATGROUP_Dasher);
+
+static TAutoConsoleVariable<bool> CVarLatencyEnabled(
+    TEXT("dasher.Latency.Enabled"),
+    true,
+    TEXT("When true, locally controlled characters stamp inputs and measure their round trip to the server."));
+
+/** Samples not echoed after this long were lost with an unreliable RPC */
+static constexpr double DasherLostSampleSeconds = 2.0;
+
+static FDasherLatencyHistogram DasherProcessHistograms[static_cast<int32>(EDasherInputKind::Num)];
+
+static void LogLatencyHistograms(const TCHAR* Name, TFunctionRef<const FDasherLatencyHistogram&(EDasherInputKind)> GetHistogram)
+{
+    UE_LOG(LogDasher, Display, TEXT("Input latency of %s"), Name);
+    for (int32 Kind = 0; Kind < static_cast<int32>(EDasherInputKind::Num); ++Kind)
+    {
+        const FDasherLatencyHistogram& Histogram = GetHistogram(static_cast<EDasherInputKind>(Kind));
+        UE_LOG(LogDasher, Display, TEXT("  %-8s %6d samples, p50 %5.0f ms, p95 %5.0f ms, p99 %5.0f ms"), LexToString(static_cast<EDasherInputKind>(Kind)),
+            Histogram.GetNumSamples(), Histogram.GetPercentile(0.5f), Histogram.GetPercentile(0.95f), Histogram.GetPercentile(0.99f));
+    }
+}
+
+static FAutoConsoleCommandWithWorld LatencyDumpCommand(
+    TEXT("dasher.Latency.Dump"),
+    TEXT("Logs the input latency percentiles of each locally controlled character and of the whole process."),
+    FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+    {
+        if (World != nullptr)
+        {
+            for (TActorIterator<ADasherCharacter> It(World); It; ++It)
+            {
+                if (It->IsLocallyControlled())
+                {
+                    const FDasherInputLatency& InputLatency = It->GetInputLatency();
+                    LogLatencyHistograms(*It->GetName(), [&InputLatency](EDasherInputKind Kind) -> const FDasherLatencyHistogram& { return InputLatency.GetHistogram(Kind); });
+                }
+            }
+        }
+        LogLatencyHistograms(TEXT("the process"), &FDasherInputLatency::GetProcessHistogram);
+    }));
+
+static FAutoConsoleCommandWithWorld LatencyResetCommand(
+    TEXT("dasher.Latency.Reset"),
+    TEXT("Clears the input latency histograms, to measure from now on."),
+    FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+    {
+        if (World != nullptr)
+        {
+            for (TActorIterator<ADasherCharacter> It(World); It; ++It)
+            {
+                It->ResetInputLatency();
+            }
+        }
+        FDasherInputLatency::ResetProcessHistograms();
+    }));
+
+const TCHAR* LexToString(EDasherInputKind Kind)
+{
+    switch (Kind)
+    {
+    case EDasherInputKind::Fire: return TEXT("Fire");
+    case EDasherInputKind::Look: return TEXT("Look");
+    case EDasherInputKind::Sprint: return TEXT("Sprint");
+    case EDasherInputKind::Crouch: return TEXT("Crouch");
+    default: return TEXT("Unknown");
+    }
+}
+
+void FDasherLatencyHistogram::Add(float LatencyMs)
+{
+    ++Buckets[FMath::Clamp(FMath::FloorToInt(LatencyMs / BucketMs), 0, NumBuckets - 1)];
+    ++NumSamples;
+}
+
+float FDasherLatencyHistogram::GetPercentile(float Fraction) const
+{
+    if (NumSamples == 0)
+    {
+        return 0.f;
+    }
+
+    const uint32 Target = FMath::Max(FMath::CeilToInt(NumSamples * Fraction), 1);
+    uint32 Count = 0;
+    for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+    {
+        Count += Buckets[Bucket];
+        if (Count >= Target)
+        {
+            return (Bucket + 1) * BucketMs;
+        }
+    }
+    return NumBuckets * BucketMs;
+}
+
+void FDasherLatencyHistogram::Reset()
+{
+    FMemory::Memzero(Buckets);
+    NumSamples = 0;
+}
+
+uint8 FDasherInputLatency::StampRPC(EDasherInputKind Kind, double InputTime)
+{
+    FPendingSample& Pending = PendingSamples[static_cast<int32>(Kind)];
+    if (!CanStamp(Pending, InputTime))
+    {
+        return 0;
+    }
+
+    // Zero means not sampled
+    Pending.Sequence = NextSequence;
+    NextSequence = NextSequence == MAX_uint8 ? 1 : NextSequence + 1;
+    Pending.InputTime = InputTime;
+    Pending.bInFlight = true;
+    return Pending.Sequence;
+}
+
+void FDasherInputLatency::AckRPC(EDasherInputKind Kind, uint8 Sequence, const UObject* Owner)
+{
+    FPendingSample& Pending = PendingSamples[static_cast<int32>(Kind)];
+    if (Pending.bInFlight && Pending.Sequence == Sequence)
+    {
+        Complete(Kind, Pending, Owner);
+    }
+}
+
+void FDasherInputLatency::StampMove(EDasherInputKind Kind, float LastMoveTimeStamp, double InputTime)
+{
+    FPendingSample& Pending = PendingSamples[static_cast<int32>(Kind)];
+    if (CanStamp(Pending, InputTime))
+    {
+        Pending.MoveTimeStamp = LastMoveTimeStamp;
+        Pending.InputTime = InputTime;
+        Pending.bInFlight = true;
+    }
+}
+
+void FDasherInputLatency::AckMove(float AckedMoveTimeStamp, const UObject* Owner)
+{
+    for (const EDasherInputKind Kind : { EDasherInputKind::Sprint, EDasherInputKind::Crouch })
+    {
+        // Move timestamps are reset every few minutes, a sample across a reset is left to expire
+        FPendingSample& Pending = PendingSamples[static_cast<int32>(Kind)];
+        if (Pending.bInFlight && AckedMoveTimeStamp > Pending.MoveTimeStamp)
+        {
+            Complete(Kind, Pending, Owner);
+        }
+    }
+}
+
+void FDasherInputLatency::Reset()
+{
+    for (int32 Kind = 0; Kind < static_cast<int32>(EDasherInputKind::Num); ++Kind)
+    {
+        PendingSamples[Kind] = FPendingSample();
+        Histograms[Kind].Reset();
+    }
+}
+
+const FDasherLatencyHistogram& FDasherInputLatency::GetProcessHistogram(EDasherInputKind Kind)
+{
+    return DasherProcessHistograms[static_cast<int32>(Kind)];
+}
+
+void FDasherInputLatency::ResetProcessHistograms()
+{
+    for (FDasherLatencyHistogram& Histogram : DasherProcessHistograms)
+    {
+        Histogram.Reset();
+    }
+}
+
+bool FDasherInputLatency::CanStamp(FPendingSample& Pending, double Now) const
+{
+    if (!CVarLatencyEnabled.GetValueOnGameThread())
+    {
+        return false;
+    }
+
+    if (Pending.bInFlight && Now - Pending.InputTime > DasherLostSampleSeconds)
+    {
+        Pending.bInFlight = false;
+    }
+    return !Pending.bInFlight;
+}
+
+void FDasherInputLatency::Complete(EDasherInputKind Kind, FPendingSample& Pending, const UObject* Owner)
+{
+    Pending.bInFlight = false;
+
+    const float LatencyMs = static_cast<float>((FPlatformTime::Seconds() - Pending.InputTime) * 1000.0);
+    Histograms[static_cast<int32>(Kind)].Add(LatencyMs);
+
+    FDasherLatencyHistogram& ProcessHistogram = DasherProcessHistograms[static_cast<int32>(Kind)];
+    ProcessHistogram.Add(LatencyMs);
+
+    const AActor* OwnerActor = Cast<AActor>(Owner);
+    FDasherTelemetry::Record(static_cast<EDasherTelemetryEvent>(static_cast<uint8>(EDasherTelemetryEvent::FireLatency) + static_cast<uint8>(Kind)),
+        Owner, OwnerActor != nullptr ? OwnerActor->GetActorLocation() : FVector::ZeroVector, LatencyMs);
+
+#if STATS
+    const float P50 = ProcessHistogram.GetPercentile(0.5f);
+    const float P95 = ProcessHistogram.GetPercentile(0.95f);
+    const float P99 = ProcessHistogram.GetPercentile(0.99f);
+    switch (Kind)
+    {
+    case EDasherInputKind::Fire:
+        SET_FLOAT_STAT(STAT_DasherFireLatencyP50, P50);
+        SET_FLOAT_STAT(STAT_DasherFireLatencyP95, P95);
+        SET_FLOAT_STAT(STAT_DasherFireLatencyP99, P99);
+        break;
+    case EDasherInputKind::Look:
+        SET_FLOAT_STAT(STAT_DasherLookLatencyP50, P50);
+        SET_FLOAT_STAT(STAT_DasherLookLatencyP95, P95);
+        SET_FLOAT_STAT(STAT_DasherLookLatencyP99, P99);
+        break;
+    case EDasherInputKind::Sprint:
+        SET_FLOAT_STAT(STAT_DasherSprintLatencyP50, P50);
+        SET_FLOAT_STAT(STAT_DasherSprintLatencyP95, P95);
+        SET_FLOAT_STAT(STAT_DasherSprintLatencyP99, P99);
+        break;
+    case EDasherInputKind::Crouch:
+        SET_FLOAT_STAT(STAT_DasherCrouchLatencyP50, P50);
+        SET_FLOAT_STAT(STAT_DasherCrouchLatencyP95, P95);
+        SET_FLOAT_STAT(STAT_DasherCrouchLatencyP99, P99);
+        break;
+    default:
+        break;
+    }
+#endif
+}
@@ -0,0 +1,98 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DasherInputLatency.generated.h"
+
+/** Inputs whose round trip to the server is measured */
+UENUM()
+enum class EDasherInputKind : uint8
+{
+    /** Fire input to the server firing the projectile */
+    Fire,
+    /** Look input to the server applying the look rotation */
+    Look,
+    /** Sprint input to the server acknowledging the move that started it */
+    Sprint,
+    /** Crouch input to the server acknowledging the move that started it */
+    Crouch,
+
+    Num UMETA(Hidden)
+};
+
+DASHER_API const TCHAR* LexToString(EDasherInputKind Kind);
+
+/** Round trip latencies in 2 ms buckets, the last bucket holds everything slower */
+struct DASHER_API FDasherLatencyHistogram
+{
+    static constexpr int32 NumBuckets = 256;
+    static constexpr float BucketMs = 2.f;
+
+    void Add(float LatencyMs);
+
+    /** Returns the upper edge of the bucket holding the given fraction of samples, zero without samples */
+    float GetPercentile(float Fraction) const;
+
+    int32 GetNumSamples() const { return NumSamples; }
+
+    void Reset();
+
+private:
+
+    uint32 Buckets[NumBuckets] = {};
+    int32 NumSamples = 0;
+};
+
+/**
+ * Measures one locally controlled character's input latency, from the input handler to the server echoing it back.
+ * Inputs sent in an RPC carry a sequence ID the server echoes with ClientAckInput. Sprint and crouch travel in the
+ * saved moves instead, the move's timestamp is their sequence and the server's move acknowledgement their echo.
+ * One input of each kind is in flight at a time, the ones in between aren't sampled.
+ * Results go into this character's histograms, the process-wide ones behind the latency stats, and the telemetry log.
+ */
+class DASHER_API FDasherInputLatency
+{
+public:
+
+    /** Stamps an input sent in an RPC, returns the sequence ID to send with it, zero if this one isn't sampled */
+    uint8 StampRPC(EDasherInputKind Kind, double InputTime);
+
+    /** Completes the sample the server echoed, if it is still in flight */
+    void AckRPC(EDasherInputKind Kind, uint8 Sequence, const UObject* Owner);
+
+    /** Stamps an input carried by the first move saved after LastMoveTimeStamp */
+    void StampMove(EDasherInputKind Kind, float LastMoveTimeStamp, double InputTime);
+
+    /** Completes the samples whose move the server acknowledged */
+    void AckMove(float AckedMoveTimeStamp, const UObject* Owner);
+
+    const FDasherLatencyHistogram& GetHistogram(EDasherInputKind Kind) const { return Histograms[static_cast<int32>(Kind)]; }
+
+    void Reset();
+
+    /** All locally controlled characters of the process together */
+    static const FDasherLatencyHistogram& GetProcessHistogram(EDasherInputKind Kind);
+
+    static void ResetProcessHistograms();
+
+private:
+
+    struct FPendingSample
+    {
+        double InputTime = 0.0;
+        float MoveTimeStamp = 0.f;
+        uint8 Sequence = 0;
+        bool bInFlight = false;
+    };
+
+    /** Returns whether a new sample of the kind can start, giving up on one that was lost */
+    bool CanStamp(FPendingSample& Pending, double Now) const;
+
+    void Complete(EDasherInputKind Kind, FPendingSample& Pending, const UObject* Owner);
+
+    FPendingSample PendingSamples[static_cast<int32>(EDasherInputKind::Num)];
+    FDasherLatencyHistogram Histograms[static_cast<int32>(EDasherInputKind::Num)];
+
+    uint8 NextSequence = 1;
+};
@@ -0,0 +1,508 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherInputRecording.h"
+
+#include "Dasher.h"
+#include "Characters/DasherCharacter.h"
+
+#include "Algo/StableSort.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "UObject/ObjectKey.h"
+
+bool FDasherInputRecorder::bRecording = false;
+
+static FAutoConsoleCommand InputRecordStartCommand(
+    TEXT("dasher.InputRecord.Start"),
+    TEXT("Starts recording the inputs of player controlled characters. Usage: dasher.InputRecord.Start [File]"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        FDasherInputRecorder::Start(Args.Num() > 0 ? Args[0] : FString());
+    }));
+
+static FAutoConsoleCommand InputRecordStopCommand(
+    TEXT("dasher.InputRecord.Stop"),
+    TEXT("Stops recording inputs and closes the recording."),
+    FConsoleCommandDelegate::CreateLambda([]()
+    {
+        FDasherInputRecorder::Stop();
+    }));
+
+/** File format */
+static constexpr uint32 InputRecordingMagic = 0x504E4944; // "DINP"
+static constexpr uint32 InputRecordingVersion = 2;
+
+enum class EDasherInputRecordTag : uint8
+{
+    /** Zigzag varint of the frame's delta time in microseconds, minus the previous frame's */
+    EndFrame,
+    /** Varint name length, UTF-8 name, location and yaw as floats */
+    AddPlayer,
+    /** Varint player */
+    RemovePlayer,
+    /** Varint player, input, value type in bits 3-4 and changed components in bits 0-2, then the changed components as floats */
+    Input,
+    /** Varint name length, UTF-8 name of the map the following players play on. Version 2 */
+    Map
+};
+
+/** Recording state */
+static TUniquePtr<FArchive> RecordingFile;
+static TArray<uint8> RecordingBuffer;
+static TMap<TObjectKey<ADasherCharacter>, int32> RecordingPlayers;
+static TArray<FVector> RecordingLastValues;
+static FString RecordingMap;
+static int32 RecordingNumPlayers = 0;
+static int64 RecordingLastDeltaMicros = 0;
+static FDelegateHandle RecordingEndFrameHandle;
+
+static void WriteByte(uint8 Byte)
+{
+    RecordingBuffer.Add(Byte);
+}
+
+static void WriteVarUint(uint32 Value)
+{
+    while (Value >= 0x80)
+    {
+        RecordingBuffer.Add(static_cast<uint8>(Value | 0x80));
+        Value >>= 7;
+    }
+    RecordingBuffer.Add(static_cast<uint8>(Value));
+}
+
+static void WriteFloat(float Value)
+{
+    RecordingBuffer.Append(reinterpret_cast<const uint8*>(&Value), sizeof(Value));
+}
+
+static void FlushRecording()
+{
+    if (RecordingBuffer.Num() > 0)
+    {
+        RecordingFile->Serialize(RecordingBuffer.GetData(), RecordingBuffer.Num());
+        RecordingBuffer.Reset();
+    }
+}
+
+const TCHAR* LexToString(EDasherRecordedInput Input)
+{
+    switch (Input)
+    {
+    case EDasherRecordedInput::Jump: return TEXT("Jump");
+    case EDasherRecordedInput::StopJumping: return TEXT("StopJumping");
+    case EDasherRecordedInput::Move: return TEXT("Move");
+    case EDasherRecordedInput::Look: return TEXT("Look");
+    case EDasherRecordedInput::Sprint: return TEXT("Sprint");
+    case EDasherRecordedInput::StopSprinting: return TEXT("StopSprinting");
+    case EDasherRecordedInput::Crouch: return TEXT("Crouch");
+    case EDasherRecordedInput::UnCrouch: return TEXT("UnCrouch");
+    case EDasherRecordedInput::Dash: return TEXT("Dash");
+    case EDasherRecordedInput::Fire: return TEXT("Fire");
+    case EDasherRecordedInput::StopFire: return TEXT("StopFire");
+    case EDasherRecordedInput::AltFire: return TEXT("AltFire");
+    case EDasherRecordedInput::SwapWeapon: return TEXT("SwapWeapon");
+    default: return TEXT("Unknown");
+    }
+}
+
+bool FDasherInputRecorder::Start(const FString& Filename)
+{
+    check(IsInGameThread());
+
+    if (bRecording)
+    {
+        UE_LOG(LogDasher, Warning, TEXT("Inputs are already being recorded"));
+        return false;
+    }
+
+    const FString Path = !Filename.IsEmpty() ? Filename : FPaths::ProfilingDir() / TEXT("Inputs") / FString::Printf(TEXT("Inputs-%s.dinp"), *FDateTime::Now().ToString());
+    RecordingFile.Reset(IFileManager::Get().CreateFileWriter(*Path));
+    if (!RecordingFile.IsValid())
+    {
+        UE_LOG(LogDasher, Error, TEXT("Input recorder couldn't create %s"), *Path);
+        return false;
+    }
+
+    uint32 Magic = InputRecordingMagic;
+    uint32 Version = InputRecordingVersion;
+    int64 StartUtcTicks = FDateTime::UtcNow().GetTicks();
+    *RecordingFile << Magic << Version << StartUtcTicks;
+
+    RecordingBuffer.Reset();
+    RecordingPlayers.Reset();
+    RecordingLastValues.Reset();
+    RecordingMap.Reset();
+    RecordingNumPlayers = 0;
+    RecordingLastDeltaMicros = 0;
+    RecordingEndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&FDasherInputRecorder::EndFrame);
+    bRecording = true;
+
+    UE_LOG(LogDasher, Log, TEXT("Recording inputs to %s"), *Path);
+    return true;
+}
+
+void FDasherInputRecorder::Stop()
+{
+    check(IsInGameThread());
+
+    if (!bRecording)
+    {
+        return;
+    }
+
+    // The frame in progress keeps what was recorded of it
+    EndFrame();
+    FlushRecording();
+    bRecording = false;
+
+    FCoreDelegates::OnEndFrame.Remove(RecordingEndFrameHandle);
+    RecordingFile->Close();
+    RecordingFile.Reset();
+
+    UE_LOG(LogDasher, Log, TEXT("Input recording stopped, %d players recorded"), RecordingNumPlayers);
+}
+
+static void WriteString(const FString& String)
+{
+    const FTCHARToUTF8 Utf8(*String);
+    WriteVarUint(Utf8.Length());
+    RecordingBuffer.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+}
+
+int32 FDasherInputRecorder::AddPlayer(const ADasherCharacter* Character)
+{
+    check(IsInGameThread());
+
+    if (const int32* FoundPlayer = RecordingPlayers.Find(Character))
+    {
+        return *FoundPlayer;
+    }
+
+    // Written again only when a player shows up on another map, a recording normally names its map once
+    const FString Map = UWorld::RemovePIEPrefix(Character->GetWorld()->GetMapName());
+    if (Map != RecordingMap)
+    {
+        RecordingMap = Map;
+        WriteByte(static_cast<uint8>(EDasherInputRecordTag::Map));
+        WriteString(Map);
+    }
+
+    const int32 Player = RecordingNumPlayers++;
+    RecordingPlayers.Add(Character, Player);
+    RecordingLastValues.AddZeroed(static_cast<int32>(EDasherRecordedInput::Num));
+
+    const APlayerState* PlayerState = Character->GetPlayerState();
+    const FVector Location = Character->GetActorLocation();
+
+    WriteByte(static_cast<uint8>(EDasherInputRecordTag::AddPlayer));
+    WriteString(PlayerState != nullptr ? PlayerState->GetPlayerName() : Character->GetName());
+    WriteFloat(static_cast<float>(Location.X));
+    WriteFloat(static_cast<float>(Location.Y));
+    WriteFloat(static_cast<float>(Location.Z));
+    WriteFloat(static_cast<float>(Character->GetActorRotation().Yaw));
+    return Player;
+}
+
+void FDasherInputRecorder::RecordInput(const ADasherCharacter* Character, EDasherRecordedInput Input, const FInputActionValue& Value)
+{
+    check(IsInGameThread());
+
+    // Characters come into play through AddCharacter, the ones already in play when recording started are added where
+    // they stand at their first input
+    const int32 Player = AddPlayer(Character);
+
+    FVector& LastValue = RecordingLastValues[Player * static_cast<int32>(EDasherRecordedInput::Num) + static_cast<int32>(Input)];
+    const FVector NewValue = Value.Get<FVector>();
+    uint8 ChangedMask = 0;
+    for (int32 Component = 0; Component < 3; ++Component)
+    {
+        ChangedMask |= NewValue[Component] != LastValue[Component] ? 1 << Component : 0;
+    }
+
+    WriteByte(static_cast<uint8>(EDasherInputRecordTag::Input));
+    WriteVarUint(Player);
+    WriteByte(static_cast<uint8>(Input));
+    WriteByte(static_cast<uint8>(static_cast<uint8>(Value.GetValueType()) << 3 | ChangedMask));
+    for (int32 Component = 0; Component < 3; ++Component)
+    {
+        if (ChangedMask & (1 << Component))
+        {
+            WriteFloat(static_cast<float>(NewValue[Component]));
+        }
+    }
+    LastValue = NewValue;
+}
+
+void FDasherInputRecorder::RemovePlayer(const ADasherCharacter* Character)
+{
+    int32 Player = INDEX_NONE;
+    if (RecordingPlayers.RemoveAndCopyValue(Character, Player))
+    {
+        WriteByte(static_cast<uint8>(EDasherInputRecordTag::RemovePlayer));
+        WriteVarUint(Player);
+    }
+}
+
+void FDasherInputRecorder::EndFrame()
+{
+    // Frame times jitter around the same value, the difference mostly fits a byte or two
+    const int64 DeltaMicros = FMath::RoundToInt64(FApp::GetDeltaTime() * 1000000.0);
+    const int32 Difference = static_cast<int32>(DeltaMicros - RecordingLastDeltaMicros);
+    RecordingLastDeltaMicros = DeltaMicros;
+
+    WriteByte(static_cast<uint8>(EDasherInputRecordTag::EndFrame));
+    WriteVarUint((static_cast<uint32>(Difference) << 1) ^ static_cast<uint32>(Difference >> 31));
+
+    if (RecordingBuffer.Num() >= 64 * 1024)
+    {
+        FlushRecording();
+    }
+}
+
+bool FDasherInputRecording::Load(const FString& Filename)
+{
+    TArray<uint8> Data;
+    if (!FFileHelper::LoadFileToArray(Data, *Filename))
+    {
+        UE_LOG(LogDasher, Error, TEXT("Couldn't read input recording %s"), *Filename);
+        return false;
+    }
+
+    FMemoryReader Reader(Data);
+    uint32 Magic = 0;
+    uint32 Version = 0;
+    Reader << Magic << Version << StartUtcTicks;
+    if (Reader.IsError() || Magic != InputRecordingMagic || Version > InputRecordingVersion)
+    {
+        UE_LOG(LogDasher, Error, TEXT("%s isn't an input recording this build can read"), *Filename);
+        return false;
+    }
+
+    Map.Reset();
+    Players.Reset();
+    Frames.Reset();
+    Events.Reset();
+
+    int64 Offset = Reader.Tell();
+    bool bTruncated = false;
+    const auto ReadByte = [&Data, &Offset, &bTruncated]() -> uint8
+    {
+        bTruncated |= Offset >= Data.Num();
+        return !bTruncated ? Data[Offset++] : 0;
+    };
+    const auto ReadVarUint = [&ReadByte, &bTruncated]() -> uint32
+    {
+        uint32 Value = 0;
+        for (int32 Shift = 0; Shift < 32 && !bTruncated; Shift += 7)
+        {
+            const uint8 Byte = ReadByte();
+            Value |= static_cast<uint32>(Byte & 0x7F) << Shift;
+            if ((Byte & 0x80) == 0)
+            {
+                break;
+            }
+        }
+        return Value;
+    };
+    const auto ReadFloat = [&Data, &Offset, &bTruncated]() -> float
+    {
+        float Value = 0.f;
+        bTruncated |= Offset + static_cast<int64>(sizeof(Value)) > Data.Num();
+        if (!bTruncated)
+        {
+            FMemory::Memcpy(&Value, &Data[Offset], sizeof(Value));
+            Offset += sizeof(Value);
+        }
+        return Value;
+    };
+
+    TArray<FVector> LastValues;
+    int64 DeltaMicros = 0;
+    int32 FirstEvent = 0;
+    while (Offset < Data.Num() && !bTruncated)
+    {
+        FDasherRecordedEvent Event;
+        switch (static_cast<EDasherInputRecordTag>(ReadByte()))
+        {
+        case EDasherInputRecordTag::EndFrame:
+        {
+            const uint32 ZigZag = ReadVarUint();
+            DeltaMicros += static_cast<int32>(ZigZag >> 1) ^ -static_cast<int32>(ZigZag & 1);
+
+            FDasherRecordedFrame& Frame = Frames.AddDefaulted_GetRef();
+            Frame.DeltaSeconds = static_cast<float>(DeltaMicros / 1000000.0);
+            Frame.FirstEvent = FirstEvent;
+            Frame.NumEvents = Events.Num() - FirstEvent;
+            FirstEvent = Events.Num();
+            continue;
+        }
+        case EDasherInputRecordTag::AddPlayer:
+        {
+            const uint32 NameLength = ReadVarUint();
+            bTruncated |= Offset + static_cast<int64>(NameLength) > Data.Num();
+            if (bTruncated)
+            {
+                break;
+            }
+            FDasherRecordedPlayer& Player = Players.AddDefaulted_GetRef();
+            Player.Name = FString(FUTF8ToTCHAR(reinterpret_cast<const ANSICHAR*>(&Data[Offset]), NameLength));
+            Offset += NameLength;
+            const float X = ReadFloat();
+            const float Y = ReadFloat();
+            const float Z = ReadFloat();
+            const float Yaw = ReadFloat();
+            Player.Transform = FTransform(FRotator(0.f, Yaw, 0.f), FVector(X, Y, Z));
+            LastValues.AddZeroed(static_cast<int32>(EDasherRecordedInput::Num));
+
+            Event.Player = Players.Num() - 1;
+            Event.Type = FDasherRecordedEvent::EType::AddPlayer;
+            break;
+        }
+        case EDasherInputRecordTag::Map:
+        {
+            const uint32 NameLength = ReadVarUint();
+            bTruncated |= Offset + static_cast<int64>(NameLength) > Data.Num();
+            if (bTruncated)
+            {
+                break;
+            }
+            const FString RecordedMap(FUTF8ToTCHAR(reinterpret_cast<const ANSICHAR*>(&Data[Offset]), NameLength));
+            Offset += NameLength;
+            if (Map.IsEmpty())
+            {
+                Map = RecordedMap;
+            }
+            else if (Map != RecordedMap)
+            {
+                UE_LOG(LogDasher, Warning, TEXT("Input recording %s goes on from %s to %s, its players are replayed on one map"), *Filename, *Map, *RecordedMap);
+            }
+            continue;
+        }
+        case EDasherInputRecordTag::RemovePlayer:
+        {
+            Event.Player = ReadVarUint();
+            Event.Type = FDasherRecordedEvent::EType::RemovePlayer;
+            break;
+        }
+        case EDasherInputRecordTag::Input:
+        {
+            Event.Player = ReadVarUint();
+            Event.Type = FDasherRecordedEvent::EType::Input;
+            Event.Input = static_cast<EDasherRecordedInput>(ReadByte());
+            const uint8 TypeAndMask = ReadByte();
+            if (!Players.IsValidIndex(Event.Player) || Event.Input >= EDasherRecordedInput::Num)
+            {
+                bTruncated = true;
+                break;
+            }
+
+            FVector& Value = LastValues[Event.Player * static_cast<int32>(EDasherRecordedInput::Num) + static_cast<int32>(Event.Input)];
+            for (int32 Component = 0; Component < 3; ++Component)
+            {
+                if (TypeAndMask & (1 << Component))
+                {
+                    Value[Component] = ReadFloat();
+                }
+            }
+            Event.Value = FInputActionValue(static_cast<EInputActionValueType>(TypeAndMask >> 3), Value);
+            break;
+        }
+        default:
+            bTruncated = true;
+            break;
+        }
+
+        if (!bTruncated)
+        {
+            Events.Add(Event);
+        }
+    }
+
+    // A recording cut short ends in a partial frame or record, everything before it is kept
+    Events.SetNum(FirstEvent);
+    if (bTruncated)
+    {
+        UE_LOG(LogDasher, Warning, TEXT("Input recording %s ends early, replaying the %d whole frames"), *Filename, Frames.Num());
+    }
+    return true;
+}
+
+void FDasherInputRecording::Merge(TConstArrayView<FDasherInputRecording> Recordings, float FrameSeconds)
+{
+    Map.Reset();
+    StartUtcTicks = 0;
+    Players.Reset();
+    Frames.Reset();
+    Events.Reset();
+    if (Recordings.Num() == 0 || FrameSeconds <= 0.f)
+    {
+        return;
+    }
+
+    StartUtcTicks = Recordings[0].StartUtcTicks;
+    for (const FDasherInputRecording& Recording : Recordings)
+    {
+        StartUtcTicks = FMath::Min(StartUtcTicks, Recording.StartUtcTicks);
+        if (Map.IsEmpty())
+        {
+            Map = Recording.Map;
+        }
+        else if (!Recording.Map.IsEmpty() && Recording.Map != Map)
+        {
+            UE_LOG(LogDasher, Warning, TEXT("Merging input recordings of %s and %s, their players are replayed on one map"), *Map, *Recording.Map);
+        }
+    }
+
+    // Every source frame goes into the merged frame its end falls in, in the order the recordings were given so each
+    // keeps the order of its own events
+    struct FMergedEvent
+    {
+        int32 Frame;
+        FDasherRecordedEvent Event;
+    };
+    TArray<FMergedEvent> MergedEvents;
+    int32 NumFrames = 0;
+    for (const FDasherInputRecording& Recording : Recordings)
+    {
+        const int32 FirstPlayer = Players.Num();
+        Players.Append(Recording.Players);
+
+        double FrameEndTime = static_cast<double>(Recording.StartUtcTicks - StartUtcTicks) / ETimespan::TicksPerSecond;
+        for (const FDasherRecordedFrame& Frame : Recording.Frames)
+        {
+            FrameEndTime += Frame.DeltaSeconds;
+            const int32 MergedFrame = FMath::FloorToInt32(FrameEndTime / FrameSeconds);
+            NumFrames = FMath::Max(NumFrames, MergedFrame + 1);
+            for (int32 EventIndex = Frame.FirstEvent; EventIndex < Frame.FirstEvent + Frame.NumEvents; ++EventIndex)
+            {
+                FMergedEvent& Merged = MergedEvents.AddDefaulted_GetRef();
+                Merged.Frame = MergedFrame;
+                Merged.Event = Recording.Events[EventIndex];
+                Merged.Event.Player += FirstPlayer;
+            }
+        }
+    }
+    Algo::StableSortBy(MergedEvents, &FMergedEvent::Frame);
+
+    Frames.SetNum(NumFrames);
+    Events.Reserve(MergedEvents.Num());
+    int32 NextEvent = 0;
+    for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+    {
+        FDasherRecordedFrame& Frame = Frames[FrameIndex];
+        Frame.DeltaSeconds = FrameSeconds;
+        Frame.FirstEvent = Events.Num();
+        while (NextEvent < MergedEvents.Num() && MergedEvents[NextEvent].Frame == FrameIndex)
+        {
+            Events.Add(MergedEvents[NextEvent++].Event);
+        }
+        Frame.NumEvents = Events.Num() - Frame.FirstEvent;
+    }
+}
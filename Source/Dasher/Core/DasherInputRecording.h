@@ -0,0 +1,153 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InputActionValue.h"
+
+class ADasherCharacter;
+
+/** Input handlers of ADasherCharacter that are recorded. Part of the file format, only append */
+enum class EDasherRecordedInput : uint8
+{
+    Jump,
+    StopJumping,
+    Move,
+    Look,
+    Sprint,
+    StopSprinting,
+    Crouch,
+    UnCrouch,
+    Dash,
+    Fire,
+    StopFire,
+    AltFire,
+    SwapWeapon,
+
+    Num
+};
+
+DASHER_API const TCHAR* LexToString(EDasherRecordedInput Input);
+
+/** One thing that happened during a recorded frame, in the order it happened */
+struct FDasherRecordedEvent
+{
+    enum class EType : uint8
+    {
+        /** The player's character came into play */
+        AddPlayer,
+        /** The player's character left play */
+        RemovePlayer,
+        /** An input handler of the player's character was called */
+        Input
+    };
+
+    int32 Player = 0;
+    EType Type = EType::Input;
+    EDasherRecordedInput Input = EDasherRecordedInput::Num;
+    FInputActionValue Value;
+};
+
+/** A recorded frame, its events are a range of FDasherInputRecording::Events */
+struct FDasherRecordedFrame
+{
+    float DeltaSeconds = 0.f;
+    int32 FirstEvent = 0;
+    int32 NumEvents = 0;
+};
+
+/** A recorded character, as it was when it came into play, or when recording started for one already in play */
+struct FDasherRecordedPlayer
+{
+    FString Name;
+    FTransform Transform;
+};
+
+/** A whole recording, decoded */
+struct DASHER_API FDasherInputRecording
+{
+    /** Loads and decodes a recording, returns false if the file can't be read or isn't one */
+    bool Load(const FString& Filename);
+
+    /**
+     * Replaces this recording with the recordings of several machines of the same session, each of which recorded its own
+     * players. They are lined up by when they started recording, and their events are played in frames of FrameSeconds,
+     * each source frame in the merged frame its end falls in
+     */
+    void Merge(TConstArrayView<FDasherInputRecording> Recordings, float FrameSeconds);
+
+    /** Map the players were recorded on, without a PIE prefix. Empty for recordings from before maps were recorded */
+    FString Map;
+
+    /** FDateTime ticks, UTC, when recording started */
+    int64 StartUtcTicks = 0;
+
+    TArray<FDasherRecordedPlayer> Players;
+    TArray<FDasherRecordedFrame> Frames;
+    TArray<FDasherRecordedEvent> Events;
+};
+
+/**
+ * Records every input handler call of player controlled ADasherCharacters, frame by frame, to replay them later.
+ * Characters played by a player controller are recorded, which is the local player on a client and every swarm client
+ * in a swarm process. Bots aren't, their seed plays them again. Inputs only go through the handlers on the machine that
+ * plays the character, so a dedicated server records nothing: record on the clients and merge their files on replay.
+ * The file is a small header followed by tagged records. A frame ends with its delta time, in microseconds relative to
+ * the previous frame's, and each input only stores the components that changed since the same input of the same player.
+ * A held move or sprint costs four bytes a frame.
+ * Starts with -DasherInputRecord[=File] or dasher.InputRecord.Start, replay with UDasherInputReplaySubsystem.
+ * Game thread only.
+ */
+class DASHER_API FDasherInputRecorder
+{
+public:
+
+    /** Starts recording to the file, the profiling directory is used if Filename is empty */
+    static bool Start(const FString& Filename = FString());
+
+    /** Stops recording and closes the file */
+    static void Stop();
+
+    static bool IsRecording() { return bRecording; }
+
+    /** Records the character coming into play where it stands, does nothing while not recording */
+    static FORCEINLINE void AddCharacter(const ADasherCharacter* Character)
+    {
+        if (bRecording)
+        {
+            AddPlayer(Character);
+        }
+    }
+
+    /** Records an input handler call, does nothing while not recording */
+    static FORCEINLINE void Record(const ADasherCharacter* Character, EDasherRecordedInput Input, const FInputActionValue& Value)
+    {
+        if (bRecording)
+        {
+            RecordInput(Character, Input, Value);
+        }
+    }
+
+    /** Records the character leaving play, if it was recorded */
+    static FORCEINLINE void RemoveCharacter(const ADasherCharacter* Character)
+    {
+        if (bRecording)
+        {
+            RemovePlayer(Character);
+        }
+    }
+
+private:
+
+    static void RecordInput(const ADasherCharacter* Character, EDasherRecordedInput Input, const FInputActionValue& Value);
+
+    /** Returns the character's player, adding it first if it isn't recorded yet */
+    static int32 AddPlayer(const ADasherCharacter* Character);
+
+    static void RemovePlayer(const ADasherCharacter* Character);
+
+    /** Ends the frame's record, at the end of every engine frame while recording */
+    static void EndFrame();
+
+    static bool bRecording;
+};
@@ -0,0 +1,11 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherPerfCounters.h"
+
+std::atomic<int32> FDasherPerfCounters::NumSentBytesReaders(0);
+
+FDasherPerfCounters& FDasherPerfCounters::Get()
+{
+    static FDasherPerfCounters Counters;
+    return Counters;
+}
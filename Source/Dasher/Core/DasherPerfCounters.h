@@ -0,0 +1,79 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+#include <atomic>
+
+/**
+ * Running totals read by the perf overlay, kept in every build configuration so a live server can be triaged without stats.
+ * They only ever grow, readers diff two snapshots. Game thread only.
+ */
+struct DASHER_API FDasherPerfCounters
+{
+    /** Cycles spent simulating batched projectiles */
+    uint64 ProjectileSimulationCycles = 0;
+
+    /** Cycles spent testing characters against pickups */
+    uint64 PickupCheckCycles = 0;
+
+    /** Look RPCs sent by clients, and received by the server */
+    uint64 LookRPCsSent = 0;
+    uint64 LookRPCsReceived = 0;
+
+    /** Packed character move RPCs sent by clients, and received by the server */
+    uint64 MoveRPCsSent = 0;
+    uint64 MoveRPCsReceived = 0;
+
+    /** Fire batch RPCs sent by clients, and received by the server */
+    uint64 FireRPCsSent = 0;
+    uint64 FireRPCsReceived = 0;
+
+    /** Projectiles fired by the server */
+    uint64 ServerShots = 0;
+
+    /** Projectiles a client predicted for its own shots, and how many of them the server's matched or rejected */
+    uint64 PredictedShots = 0;
+    uint64 PredictedShotsMatched = 0;
+    uint64 PredictedShotsRejected = 0;
+
+    /** Bytes sent on actor channels, by actor class, only counted while something reads them, see AddSentBytesReader */
+    TMap<TObjectKey<UClass>, uint64> SentBytesByClass;
+
+    static FDasherPerfCounters& Get();
+
+    /** Whether SentBytesByClass is counted, read for every bunch sent */
+    static bool ShouldCountSentBytes() { return NumSentBytesReaders.load(std::memory_order_relaxed) > 0; }
+
+    /** Starts and stops counting SentBytesByClass for a reader, counting goes on while any reader is left */
+    static void AddSentBytesReader() { NumSentBytesReaders.fetch_add(1, std::memory_order_relaxed); }
+    static void RemoveSentBytesReader() { NumSentBytesReaders.fetch_sub(1, std::memory_order_relaxed); }
+
+private:
+
+    static std::atomic<int32> NumSentBytesReaders;
+};
+
+/** Adds the cycles the enclosing scope takes to a counter */
+class FDasherScopedCycleCounter
+{
+public:
+
+    explicit FDasherScopedCycleCounter(uint64& InCounter)
+        : Counter(InCounter)
+        , StartCycles(FPlatformTime::Cycles64())
+    {
+    }
+
+    ~FDasherScopedCycleCounter()
+    {
+        Counter += FPlatformTime::Cycles64() - StartCycles;
+    }
+
+private:
+
+    uint64& Counter;
+    uint64 StartCycles;
+};
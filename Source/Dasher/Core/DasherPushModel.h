@@ -0,0 +1,44 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Net/Core/PushModel/PushModel.h"
+
+/** Non-shipping builds check that every push-model property was marked dirty when it changed */
+#define DASHER_WITH_PUSH_MODEL_VALIDATION (WITH_PUSH_MODEL && !UE_BUILD_SHIPPING)
+
+/**
+ * Last value a push-model property was set to through DASHER_SET_PUSH_PROPERTY.
+ * Declare one next to each push-model property, named <Property>Shadow. It takes no space when validation is compiled out.
+ */
+template<typename T>
+struct TDasherPushModelShadow
+{
+#if DASHER_WITH_PUSH_MODEL_VALIDATION
+    void Set(const T& InValue) { Value = InValue; }
+    bool Matches(const T& Current) const { return Value == Current; }
+
+private:
+    T Value = T();
+#else
+    void Set(const T&) {}
+    bool Matches(const T&) const { return true; }
+#endif
+};
+
+/** Writes a push-model property of this object and marks it dirty. Every write to a push-model property must go through here */
+#define DASHER_SET_PUSH_PROPERTY(ClassName, PropertyName, NewValue) \
+    do \
+    { \
+        PropertyName = (NewValue); \
+        MARK_PROPERTY_DIRTY_FROM_NAME(ClassName, PropertyName, this); \
+        PropertyName##Shadow.Set(PropertyName); \
+    } while (0)
+
+/** Whether a push-model property still has the value DASHER_SET_PUSH_PROPERTY last gave it, always true without validation */
+#define DASHER_IS_PUSH_PROPERTY_MARKED(PropertyName) (PropertyName##Shadow.Matches(PropertyName))
+
+/** Fires an ensure if a push-model property changed without DASHER_SET_PUSH_PROPERTY, call it from PreReplication */
+#define DASHER_VALIDATE_PUSH_PROPERTY(PropertyName) \
+    ensureMsgf(DASHER_IS_PUSH_PROPERTY_MARKED(PropertyName), TEXT("%s: push model property %s changed without being marked dirty, it will not replicate"), *GetName(), TEXT(#PropertyName))
@@ -0,0 +1,212 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherReplicationGraph.h"
+
+#include "Actors/DasherProjectile.h"
+#include "Characters/DasherCharacter.h"
+#include "Components/TP_PickUpComponent.h"
+#include "Components/TP_WeaponComponent.h"
+
+#include "Engine/LevelScriptActor.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "UObject/UObjectIterator.h"
+
+UDasherReplicationGraph::UDasherReplicationGraph()
+{
+    GridCellSize = 10000.f;
+    SpatialBias = FVector2D(-150000.f, -150000.f);
+    CharacterCullDistance = 15000.f;
+    ProjectileCullDistance = 10000.f;
+}
+
+void UDasherReplicationGraph::InitGlobalActorClassSettings()
+{
+    Super::InitGlobalActorClassSettings();
+
+    // Give every replicated class a routing policy and replication settings from its defaults
+    for (TObjectIterator<UClass> ClassIt; ClassIt; ++ClassIt)
+    {
+        UClass* Class = *ClassIt;
+        const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject(false));
+        if (ActorCDO == nullptr || !ActorCDO->GetIsReplicated() || Class->HasAnyClassFlags(CLASS_Abstract | CLASS_Deprecated | CLASS_NewerVersionExists))
+        {
+            continue;
+        }
+
+        // Skeleton and reinstanced Blueprint classes are never spawned
+        if (Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_")))
+        {
+            continue;
+        }
+
+        const EDasherClassRepNodeMapping Mapping = GetMappingPolicy(Class);
+        ClassRepNodePolicies.Set(Class, Mapping);
+
+        float CullDistance = 0.f;
+        if (Mapping == EDasherClassRepNodeMapping::Spatialize_Static || Mapping == EDasherClassRepNodeMapping::Spatialize_Dynamic || Mapping == EDasherClassRepNodeMapping::Spatialize_Dormancy)
+        {
+            CullDistance = FMath::Sqrt(ActorCDO->NetCullDistanceSquared);
+            if (Class->IsChildOf(ADasherCharacter::StaticClass()))
+            {
+                CullDistance = CharacterCullDistance;
+            }
+            else if (Class->IsChildOf(ADasherProjectile::StaticClass()))
+            {
+                CullDistance = ProjectileCullDistance;
+            }
+        }
+
+        FClassReplicationInfo ClassInfo;
+        InitClassReplicationInfo(ClassInfo, Class, CullDistance);
+        GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+    }
+}
+
+void UDasherReplicationGraph::InitGlobalGraphNodes()
+{
+    GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+    GridNode->CellSize = GridCellSize;
+    GridNode->SpatialBias = SpatialBias;
+    AddGlobalGraphNode(GridNode);
+
+    AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+    AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UDasherReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+    Super::InitConnectionGraphNodes(RepGraphConnection);
+
+    UDasherReplicationGraphNode_AlwaysRelevant_ForConnection* AlwaysRelevantConnectionNode = CreateNewNode<UDasherReplicationGraphNode_AlwaysRelevant_ForConnection>();
+    AddConnectionGraphNode(AlwaysRelevantConnectionNode, RepGraphConnection);
+}
+
+void UDasherReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+    switch (GetMappingPolicy(ActorInfo.Actor))
+    {
+    case EDasherClassRepNodeMapping::RelevantAllConnections:
+        AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+        break;
+
+    case EDasherClassRepNodeMapping::Spatialize_Static:
+        GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+        break;
+
+    case EDasherClassRepNodeMapping::Spatialize_Dynamic:
+        GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+        break;
+
+    case EDasherClassRepNodeMapping::Spatialize_Dormancy:
+        GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void UDasherReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+    switch (GetMappingPolicy(ActorInfo.Actor))
+    {
+    case EDasherClassRepNodeMapping::RelevantAllConnections:
+        AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+        break;
+
+    case EDasherClassRepNodeMapping::Spatialize_Static:
+        GridNode->RemoveActor_Static(ActorInfo);
+        break;
+
+    case EDasherClassRepNodeMapping::Spatialize_Dynamic:
+        GridNode->RemoveActor_Dynamic(ActorInfo);
+        break;
+
+    case EDasherClassRepNodeMapping::Spatialize_Dormancy:
+        GridNode->RemoveActor_Dormancy(ActorInfo);
+        break;
+
+    default:
+        break;
+    }
+}
+
+EDasherClassRepNodeMapping UDasherReplicationGraph::GetMappingPolicy(UClass* Class) const
+{
+    const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject());
+
+    // Controllers and anything else only relevant to its owner go through the per-connection nodes
+    if (ActorCDO->bOnlyRelevantToOwner)
+    {
+        return EDasherClassRepNodeMapping::NotRouted;
+    }
+
+    if (ActorCDO->bAlwaysRelevant || Class->IsChildOf(AGameStateBase::StaticClass()) || Class->IsChildOf(APlayerState::StaticClass()) || Class->IsChildOf(ALevelScriptActor::StaticClass()))
+    {
+        return EDasherClassRepNodeMapping::RelevantAllConnections;
+    }
+
+    if (Class->IsChildOf(ADasherCharacter::StaticClass()) || Class->IsChildOf(ADasherProjectile::StaticClass()))
+    {
+        return EDasherClassRepNodeMapping::Spatialize_Dynamic;
+    }
+
+    // Actors that never move don't need their grid cells updated
+    const USceneComponent* RootComponent = ActorCDO->GetRootComponent();
+    if (RootComponent != nullptr && RootComponent->Mobility == EComponentMobility::Static)
+    {
+        return EDasherClassRepNodeMapping::Spatialize_Static;
+    }
+
+    return EDasherClassRepNodeMapping::Spatialize_Dynamic;
+}
+
+EDasherClassRepNodeMapping UDasherReplicationGraph::GetMappingPolicy(AActor* Actor)
+{
+    // Weapon pickups sit still and dormant until someone picks them up, the grid moves them between cells as they wake up
+    if (Actor->FindComponentByClass<UTP_PickUpComponent>() != nullptr)
+    {
+        return EDasherClassRepNodeMapping::Spatialize_Dormancy;
+    }
+
+    if (const EDasherClassRepNodeMapping* Mapping = ClassRepNodePolicies.Get(Actor->GetClass()))
+    {
+        return *Mapping;
+    }
+
+    return GetMappingPolicy(Actor->GetClass());
+}
+
+void UDasherReplicationGraph::InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, float CullDistance) const
+{
+    const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject());
+    Info.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(ActorCDO->NetUpdateFrequency);
+    Info.SetCullDistanceSquared(FMath::Square(CullDistance));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// UDasherReplicationGraphNode_AlwaysRelevant_ForConnection
+
+void UDasherReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+    Super::GatherActorListsForConnection(Params);
+
+    WeaponActorList.Reset();
+    for (const FNetViewer& Viewer : Params.Viewers)
+    {
+        const APlayerController* PlayerController = Cast<APlayerController>(Viewer.InViewer);
+        const ADasherCharacter* Character = PlayerController != nullptr ? Cast<ADasherCharacter>(PlayerController->GetPawn()) : nullptr;
+        const UTP_WeaponComponent* WeaponComponent = Character != nullptr ? Character->GetActiveWeaponComponent() : nullptr;
+        if (WeaponComponent != nullptr && WeaponComponent->GetOwner() != nullptr)
+        {
+            WeaponActorList.ConditionalAdd(WeaponComponent->GetOwner());
+        }
+    }
+
+    if (WeaponActorList.Num() > 0)
+    {
+        Params.OutGatheredReplicationLists.AddReplicationActorList(WeaponActorList);
+    }
+}
@@ -0,0 +1,90 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "DasherReplicationGraph.generated.h"
+
+class UReplicationGraphNode_GridSpatialization2D;
+class UReplicationGraphNode_ActorList;
+
+/** How actors of a class are routed into the replication graph */
+enum class EDasherClassRepNodeMapping : uint8
+{
+    NotRouted,
+    RelevantAllConnections,
+    Spatialize_Static,
+    Spatialize_Dynamic,
+    Spatialize_Dormancy
+};
+
+/**
+ * Replication graph for Dasher.
+ * Characters and projectiles are found through a 2D spatial grid, weapon pickups are tracked by dormancy in the same grid,
+ * game state is relevant to everyone and each connection always gets the weapon its own pawn is holding.
+ * Pass -NoDasherRepGraph to the server to fall back to the default net driver relevancy, e.g. for benchmarking.
+ */
+UCLASS(transient, config=Engine)
+class DASHER_API UDasherReplicationGraph : public UReplicationGraph
+{
+    GENERATED_BODY()
+
+public:
+
+    UDasherReplicationGraph();
+
+    // UReplicationGraph interface
+    virtual void InitGlobalActorClassSettings() override;
+    virtual void InitGlobalGraphNodes() override;
+    virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+    virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+    virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+    // End of UReplicationGraph interface
+
+    /** Size of a spatial grid cell */
+    UPROPERTY(Config)
+    float GridCellSize;
+
+    /** Offset applied to actor locations so the grid starts at the edge of the map */
+    UPROPERTY(Config)
+    FVector2D SpatialBias;
+
+    /** Distance beyond which characters are no longer relevant */
+    UPROPERTY(Config)
+    float CharacterCullDistance;
+
+    /** Distance beyond which projectiles are no longer relevant */
+    UPROPERTY(Config)
+    float ProjectileCullDistance;
+
+    UPROPERTY()
+    TObjectPtr<UReplicationGraphNode_GridSpatialization2D> GridNode;
+
+    UPROPERTY()
+    TObjectPtr<UReplicationGraphNode_ActorList> AlwaysRelevantNode;
+
+private:
+
+    EDasherClassRepNodeMapping GetMappingPolicy(UClass* Class) const;
+    EDasherClassRepNodeMapping GetMappingPolicy(AActor* Actor);
+
+    void InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, float CullDistance) const;
+
+    TClassMap<EDasherClassRepNodeMapping> ClassRepNodePolicies;
+};
+
+/** Per-connection node that, on top of the viewer and its pawn, always replicates the weapon the viewer's pawn is holding */
+UCLASS()
+class DASHER_API UDasherReplicationGraphNode_AlwaysRelevant_ForConnection : public UReplicationGraphNode_AlwaysRelevant_ForConnection
+{
+    GENERATED_BODY()
+
+public:
+
+    virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+private:
+
+    FActorRepListRefView WeaponActorList;
+};
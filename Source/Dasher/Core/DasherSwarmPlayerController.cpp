@@ -0,0 +1,30 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherSwarmPlayerController.h"
+
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+
+void ADasherSwarmPlayerController::OnActorChannelOpen(FInBunch& InBunch, UNetConnection* Connection)
+{
+    // Skip APlayerController, which hands the first local player over to the controller that just arrived
+    AActor::OnActorChannelOpen(InBunch, Connection);
+
+    // RPCs have to leave through the connection this controller came from
+    SetNetDriverName(Connection->Driver->NetDriverName);
+    NetConnection = Connection;
+    Connection->PlayerController = this;
+    Connection->OwningActor = this;
+}
+
+void ADasherSwarmPlayerController::AcknowledgePossession(APawn* P)
+{
+    Super::AcknowledgePossession(P);
+
+    // The base version only acknowledges for local players, the server needs it before it accepts moves for the pawn
+    if (Player == nullptr && P != nullptr && AcknowledgedPawn != P)
+    {
+        AcknowledgedPawn = P;
+        ServerAcknowledgePossession(P);
+    }
+}
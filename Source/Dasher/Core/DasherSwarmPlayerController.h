@@ -0,0 +1,28 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerController.h"
+#include "DasherSwarmPlayerController.generated.h"
+
+/**
+ * Player controller given to connections opened by UDasherSwarmSubsystem, which log in with the DasherSwarm option.
+ * On the server it is a plain player controller. On the swarm process it binds to its own connection
+ * instead of taking over the process's local player, so many of them can live in one client world.
+ */
+UCLASS()
+class DASHER_API ADasherSwarmPlayerController : public APlayerController
+{
+    GENERATED_BODY()
+
+public:
+
+    // AActor interface
+    virtual void OnActorChannelOpen(FInBunch& InBunch, UNetConnection* Connection) override;
+    // End of AActor interface
+
+    // APlayerController interface
+    virtual void AcknowledgePossession(APawn* P) override;
+    // End of APlayerController interface
+};
@@ -0,0 +1,233 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherTelemetry.h"
+
+#include "Dasher.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+std::atomic<bool> FDasherTelemetry::bRecording(false);
+std::atomic<uint64> FDasherTelemetry::NumDropped(0);
+
+static FAutoConsoleCommand TelemetryStartCommand(
+    TEXT("dasher.Telemetry.Start"),
+    TEXT("Starts recording gameplay events to a binary telemetry file. Usage: dasher.Telemetry.Start [File]"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        FDasherTelemetry::Start(Args.Num() > 0 ? Args[0] : FString());
+    }));
+
+static FAutoConsoleCommand TelemetryStopCommand(
+    TEXT("dasher.Telemetry.Stop"),
+    TEXT("Stops recording gameplay events and closes the telemetry file."),
+    FConsoleCommandDelegate::CreateLambda([]()
+    {
+        FDasherTelemetry::Stop();
+    }));
+
+/** Single producer, single consumer ring of one recording thread */
+struct FDasherTelemetryRing
+{
+    static constexpr uint32 Capacity = 1 << 14;
+
+    FDasherTelemetryRecord Records[Capacity];
+
+    /** Next record to write, advanced by the recording thread only */
+    alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> Head{0};
+
+    /** Next record to drain, advanced by the writer thread only */
+    alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> Tail{0};
+
+    uint8 ThreadIndex = 0;
+};
+
+/** Every ring ever created, they live as long as the process so a thread's ring can't go away under it */
+static FCriticalSection TelemetryRingsLock;
+static TArray<FDasherTelemetryRing*> TelemetryRings;
+static thread_local FDasherTelemetryRing* TelemetryLocalRing = nullptr;
+
+/** Drains the rings into the file until stopped */
+class FDasherTelemetryWriter : public FRunnable
+{
+public:
+
+    explicit FDasherTelemetryWriter(FArchive* InFile)
+        : File(InFile)
+    {
+    }
+
+    virtual uint32 Run() override
+    {
+        while (!bStopping.load(std::memory_order_relaxed))
+        {
+            Drain();
+            FPlatformProcess::Sleep(0.05f);
+        }
+
+        // Whatever was recorded before stopping
+        Drain();
+        File->Close();
+        return 0;
+    }
+
+    virtual void Stop() override
+    {
+        bStopping.store(true, std::memory_order_relaxed);
+    }
+
+private:
+
+    void Drain()
+    {
+        FScopeLock Lock(&TelemetryRingsLock);
+        for (FDasherTelemetryRing* Ring : TelemetryRings)
+        {
+            const uint32 Head = Ring->Head.load(std::memory_order_acquire);
+            uint32 Index = Ring->Tail.load(std::memory_order_relaxed);
+            while (Index != Head)
+            {
+                // Up to the end of the ring at most, the rest wraps around to the start
+                const uint32 First = Index & (FDasherTelemetryRing::Capacity - 1);
+                const uint32 Count = FMath::Min(Head - Index, FDasherTelemetryRing::Capacity - First);
+                File->Serialize(&Ring->Records[First], Count * sizeof(FDasherTelemetryRecord));
+                Index += Count;
+            }
+            Ring->Tail.store(Head, std::memory_order_release);
+        }
+    }
+
+    TUniquePtr<FArchive> File;
+
+    std::atomic<bool> bStopping{false};
+};
+
+static FDasherTelemetryWriter* TelemetryWriter = nullptr;
+static FRunnableThread* TelemetryWriterThread = nullptr;
+
+const TCHAR* LexToString(EDasherTelemetryEvent Event)
+{
+    switch (Event)
+    {
+    case EDasherTelemetryEvent::Shot: return TEXT("Shot");
+    case EDasherTelemetryEvent::AltShot: return TEXT("AltShot");
+    case EDasherTelemetryEvent::ProjectileHit: return TEXT("ProjectileHit");
+    case EDasherTelemetryEvent::HitscanHit: return TEXT("HitscanHit");
+    case EDasherTelemetryEvent::PickUp: return TEXT("PickUp");
+    case EDasherTelemetryEvent::SprintStart: return TEXT("SprintStart");
+    case EDasherTelemetryEvent::SprintStop: return TEXT("SprintStop");
+    case EDasherTelemetryEvent::CrouchStart: return TEXT("CrouchStart");
+    case EDasherTelemetryEvent::CrouchStop: return TEXT("CrouchStop");
+    case EDasherTelemetryEvent::ServerCorrection: return TEXT("ServerCorrection");
+    case EDasherTelemetryEvent::FireLatency: return TEXT("FireLatency");
+    case EDasherTelemetryEvent::LookLatency: return TEXT("LookLatency");
+    case EDasherTelemetryEvent::SprintLatency: return TEXT("SprintLatency");
+    case EDasherTelemetryEvent::CrouchLatency: return TEXT("CrouchLatency");
+    default: return TEXT("Unknown");
+    }
+}
+
+bool FDasherTelemetry::Start(const FString& Filename)
+{
+    check(IsInGameThread());
+
+    if (IsRecording())
+    {
+        UE_LOG(LogDasher, Warning, TEXT("Telemetry is already recording"));
+        return false;
+    }
+
+    const FString Path = !Filename.IsEmpty() ? Filename : FPaths::ProfilingDir() / TEXT("Telemetry") / FString::Printf(TEXT("Telemetry-%s.dtlm"), *FDateTime::Now().ToString());
+    FArchive* File = IFileManager::Get().CreateFileWriter(*Path);
+    if (File == nullptr)
+    {
+        UE_LOG(LogDasher, Error, TEXT("Telemetry couldn't create %s"), *Path);
+        return false;
+    }
+
+    FDasherTelemetryFileHeader Header;
+    FMemory::Memzero(Header);
+    Header.Magic = FDasherTelemetryFileHeader::ExpectedMagic;
+    Header.Version = FDasherTelemetryFileHeader::CurrentVersion;
+    Header.HeaderSize = sizeof(FDasherTelemetryFileHeader);
+    Header.RecordSize = sizeof(FDasherTelemetryRecord);
+    Header.SecondsPerCycle = FPlatformTime::GetSecondsPerCycle64();
+    Header.StartCycles = FPlatformTime::Cycles64();
+    Header.StartUtcTicks = FDateTime::UtcNow().GetTicks();
+    File->Serialize(&Header, sizeof(Header));
+
+    // Nothing recorded since the last recording stopped belongs in this file
+    {
+        FScopeLock Lock(&TelemetryRingsLock);
+        for (FDasherTelemetryRing* Ring : TelemetryRings)
+        {
+            Ring->Tail.store(Ring->Head.load(std::memory_order_acquire), std::memory_order_release);
+        }
+    }
+    NumDropped.store(0, std::memory_order_relaxed);
+
+    TelemetryWriter = new FDasherTelemetryWriter(File);
+    TelemetryWriterThread = FRunnableThread::Create(TelemetryWriter, TEXT("DasherTelemetryWriter"), 0, TPri_BelowNormal);
+    bRecording.store(true, std::memory_order_release);
+
+    UE_LOG(LogDasher, Log, TEXT("Telemetry recording to %s"), *Path);
+    return true;
+}
+
+void FDasherTelemetry::Stop()
+{
+    check(IsInGameThread());
+
+    if (!IsRecording())
+    {
+        return;
+    }
+    bRecording.store(false, std::memory_order_release);
+
+    // Kill asks the writer to stop and waits for its last drain
+    TelemetryWriterThread->Kill(true);
+    delete TelemetryWriterThread;
+    delete TelemetryWriter;
+    TelemetryWriterThread = nullptr;
+    TelemetryWriter = nullptr;
+
+    UE_LOG(LogDasher, Log, TEXT("Telemetry stopped, %llu events dropped"), GetNumDropped());
+}
+
+void FDasherTelemetry::RecordEvent(EDasherTelemetryEvent Event, const UObject* Object, const FVector& Location, float Value)
+{
+    FDasherTelemetryRing* Ring = TelemetryLocalRing;
+    if (Ring == nullptr)
+    {
+        // First event from this thread
+        Ring = new FDasherTelemetryRing();
+        FScopeLock Lock(&TelemetryRingsLock);
+        Ring->ThreadIndex = static_cast<uint8>(FMath::Min(TelemetryRings.Num(), MAX_uint8));
+        TelemetryRings.Add(Ring);
+        TelemetryLocalRing = Ring;
+    }
+
+    const uint32 Head = Ring->Head.load(std::memory_order_relaxed);
+    if (Head - Ring->Tail.load(std::memory_order_acquire) >= FDasherTelemetryRing::Capacity)
+    {
+        NumDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    FDasherTelemetryRecord& Record = Ring->Records[Head & (FDasherTelemetryRing::Capacity - 1)];
+    Record.Cycles = FPlatformTime::Cycles64();
+    Record.Frame = static_cast<uint32>(GFrameCounter);
+    Record.ActorId = Object != nullptr ? Object->GetUniqueID() : 0;
+    Record.X = static_cast<float>(Location.X);
+    Record.Y = static_cast<float>(Location.Y);
+    Record.Z = static_cast<float>(Location.Z);
+    Record.Value = Value;
+    Record.Event = Event;
+    Record.ThreadIndex = Ring->ThreadIndex;
+    FMemory::Memzero(Record.Pad);
+
+    Ring->Head.store(Head + 1, std::memory_order_release);
+}
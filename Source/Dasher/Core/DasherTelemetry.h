@@ -0,0 +1,131 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <atomic>
+
+/** Gameplay events recorded by the telemetry log. Append only, the file format depends on the values */
+enum class EDasherTelemetryEvent : uint8
+{
+    /** A projectile was fired, about the shooting character */
+    Shot,
+    /** A hitscan shot was fired, about the shooting character */
+    AltShot,
+    /** A projectile hit something, about the actor it hit */
+    ProjectileHit,
+    /** A hitscan shot hit something, about the actor it hit */
+    HitscanHit,
+    /** A pickup was picked up, about the picking character */
+    PickUp,
+    SprintStart,
+    SprintStop,
+    CrouchStart,
+    CrouchStop,
+    /** The server corrected a client's move, the value is the error in cm */
+    ServerCorrection,
+    /** A fire input's round trip to the server, measured on the owning client, the value is in ms */
+    FireLatency,
+    /** A look input's round trip to the server, measured on the owning client, the value is in ms */
+    LookLatency,
+    /** A sprint input's round trip to the server, measured on the owning client, the value is in ms */
+    SprintLatency,
+    /** A crouch input's round trip to the server, measured on the owning client, the value is in ms */
+    CrouchLatency,
+
+    Num
+};
+
+DASHER_API const TCHAR* LexToString(EDasherTelemetryEvent Event);
+
+/** One recorded event, written to the file as is */
+struct FDasherTelemetryRecord
+{
+    /** FPlatformTime::Cycles64 when recorded */
+    uint64 Cycles;
+
+    /** Low bits of GFrameCounter */
+    uint32 Frame;
+
+    /** Unique id of the actor the event is about, zero for none */
+    uint32 ActorId;
+
+    float X;
+    float Y;
+    float Z;
+
+    /** Meaning depends on the event */
+    float Value;
+
+    EDasherTelemetryEvent Event;
+
+    /** Order in which the recording thread first recorded */
+    uint8 ThreadIndex;
+
+    uint8 Pad[6];
+};
+static_assert(sizeof(FDasherTelemetryRecord) == 40, "FDasherTelemetryRecord is part of the file format");
+
+/** Start of a telemetry file, followed by the records up to the end of the file */
+struct FDasherTelemetryFileHeader
+{
+    static constexpr uint32 ExpectedMagic = 0x4D4C5444; // "DTLM"
+    static constexpr uint32 CurrentVersion = 1;
+
+    uint32 Magic;
+    uint32 Version;
+    uint32 HeaderSize;
+    uint32 RecordSize;
+
+    /** Converts record cycles to seconds */
+    double SecondsPerCycle;
+
+    /** Cycles when recording started */
+    uint64 StartCycles;
+
+    /** FDateTime ticks, UTC, when recording started */
+    int64 StartUtcTicks;
+
+    uint8 Pad[24];
+};
+static_assert(sizeof(FDasherTelemetryFileHeader) == 64, "FDasherTelemetryFileHeader is part of the file format");
+
+/**
+ * Binary log of gameplay events for post-mortems.
+ * Record is cheap enough for any hot path: it copies one fixed-size record into a lock-free ring owned by the calling
+ * thread. A writer thread drains the rings into a flat file, a header followed by records, that can be memory mapped.
+ * Records are in order per thread only, sort them by cycles to interleave threads.
+ * Starts with -DasherTelemetry[=File] or dasher.Telemetry.Start, convert files with -run=DasherTelemetry.
+ */
+class DASHER_API FDasherTelemetry
+{
+public:
+
+    /** Starts recording to the file, the profiling directory is used if Filename is empty */
+    static bool Start(const FString& Filename = FString());
+
+    /** Stops recording and writes whatever is left in the rings */
+    static void Stop();
+
+    static bool IsRecording() { return bRecording.load(std::memory_order_relaxed); }
+
+    /** Records an event from any thread, does nothing while not recording */
+    static FORCEINLINE void Record(EDasherTelemetryEvent Event, const UObject* Object, const FVector& Location, float Value = 0.f)
+    {
+        if (IsRecording())
+        {
+            RecordEvent(Event, Object, Location, Value);
+        }
+    }
+
+    /** Events dropped because a ring was full since recording started */
+    static uint64 GetNumDropped() { return NumDropped.load(std::memory_order_relaxed); }
+
+private:
+
+    static void RecordEvent(EDasherTelemetryEvent Event, const UObject* Object, const FVector& Location, float Value);
+
+    static std::atomic<bool> bRecording;
+    static std::atomic<uint64> NumDropped;
+};
@@ -0,0 +1,12 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherWeaponDefinition.h"
+
+const FPrimaryAssetType UDasherWeaponDefinition::PrimaryAssetType(TEXT("DasherWeapon"));
+const FName UDasherWeaponDefinition::ServerBundle(TEXT("Server"));
+const FName UDasherWeaponDefinition::ClientBundle(TEXT("Client"));
+
+FPrimaryAssetId UDasherWeaponDefinition::GetPrimaryAssetId() const
+{
+    return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
@@ -0,0 +1,95 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "DasherWeaponDefinition.generated.h"
+
+class ADasherProjectile;
+class UAnimMontage;
+class USoundBase;
+
+/**
+ * A weapon flattened into what firing reads, resolved once when the weapon's assets are loaded.
+ * Comes from the weapon's definition, or from the weapon component's own properties if it has none.
+ */
+USTRUCT()
+struct FDasherWeaponStats
+{
+    GENERATED_BODY()
+
+    UPROPERTY(Transient)
+    TSubclassOf<ADasherProjectile> ProjectileClass;
+
+    /** Null on dedicated servers, which don't load cosmetics */
+    UPROPERTY(Transient)
+    TObjectPtr<USoundBase> FireSound;
+
+    /** Null on dedicated servers, which don't load cosmetics */
+    UPROPERTY(Transient)
+    TObjectPtr<UAnimMontage> FireAnimation;
+
+    /** Null on dedicated servers, which don't load cosmetics */
+    UPROPERTY(Transient)
+    TObjectPtr<UAnimMontage> ThirdPersonFireAnimation;
+
+    /** Muzzle offset from the character location, in view space */
+    FVector MuzzleOffset = FVector::ZeroVector;
+
+    /** Fastest any weapon fires, also the rate of weapons without one, so the server always has a rate to check shots against */
+    static constexpr float MaxFireRate = 30.f;
+
+    /** Seconds between two shots, never zero once resolved */
+    float FireInterval = 1.f / MaxFireRate;
+};
+
+/**
+ * Everything that makes a weapon, with its assets referenced softly and loaded by bundle through the Asset Manager when the weapon is picked up.
+ * The Server bundle has what firing needs, the Client bundle adds the cosmetics, so dedicated servers never load those.
+ * Scanned as DasherWeapon primary assets, see AssetManagerSettings in DefaultGame.ini.
+ */
+UCLASS(BlueprintType)
+class DASHER_API UDasherWeaponDefinition : public UPrimaryDataAsset
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Type of the definitions, and of the weapons without one, which register themselves as dynamic assets */
+    static const FPrimaryAssetType PrimaryAssetType;
+
+    /** Bundle loaded on servers */
+    static const FName ServerBundle;
+
+    /** Bundle loaded on clients, which also fire and see the projectiles */
+    static const FName ClientBundle;
+
+    /** Shots per second, up to FDasherWeaponStats::MaxFireRate, which zero also fires at */
+    UPROPERTY(EditDefaultsOnly, Category=Gameplay, meta=(ClampMin=0))
+    float FireRate = 10.f;
+
+    /** Gun muzzle's offset from the characters location, in view space */
+    UPROPERTY(EditDefaultsOnly, Category=Gameplay)
+    FVector MuzzleOffset = FVector(100.0f, 0.0f, 10.0f);
+
+    /** Projectile class to spawn */
+    UPROPERTY(EditDefaultsOnly, Category=Projectile, meta=(AssetBundles="Server,Client"))
+    TSoftClassPtr<ADasherProjectile> ProjectileClass;
+
+    /** Sound to play each time we fire */
+    UPROPERTY(EditDefaultsOnly, Category=Gameplay, meta=(AssetBundles="Client"))
+    TSoftObjectPtr<USoundBase> FireSound;
+
+    /** AnimMontage to play on the arms each time we fire */
+    UPROPERTY(EditDefaultsOnly, Category=Gameplay, meta=(AssetBundles="Client"))
+    TSoftObjectPtr<UAnimMontage> FireAnimation;
+
+    /** AnimMontage to play on the body each time someone else fires */
+    UPROPERTY(EditDefaultsOnly, Category=Gameplay, meta=(AssetBundles="Client"))
+    TSoftObjectPtr<UAnimMontage> ThirdPersonFireAnimation;
+
+    // UObject interface
+    virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+    // End of UObject interface
+};
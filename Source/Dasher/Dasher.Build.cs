@@ -10,6 +10,6 @@ public class Dasher : ModuleRules
 
         PublicIncludePaths.AddRange(new string[] { "Dasher" });
 
-        PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "EnhancedInput" });
+        PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "EnhancedInput", "AIModule", "NetCore", "PacketHandler", "ReplicationGraph", "Json", "JsonUtilities" });
     }
 }
@@ -1,7 +1,82 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "Dasher.h"
+#include "Core/DasherAllocationTracker.h"
+#include "Core/DasherInputRecording.h"
+#include "Core/DasherReplicationGraph.h"
+#include "Core/DasherTelemetry.h"
+
+#include "Engine/NetDriver.h"
+#include "Engine/ReplicationDriver.h"
+#include "Misc/CommandLine.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Dasher, "Dasher" );
- 
\ No newline at end of file
+DEFINE_LOG_CATEGORY(LogDasher);
+
+UE_TRACE_CHANNEL_DEFINE(DasherChannel);
+
+DEFINE_STAT(STAT_DasherCharacterMove);
+DEFINE_STAT(STAT_DasherCharacterLook);
+DEFINE_STAT(STAT_DasherCharacterFire);
+DEFINE_STAT(STAT_DasherWeaponServerFire);
+DEFINE_STAT(STAT_DasherProjectileHit);
+DEFINE_STAT(STAT_DasherPickUp);
+
+DEFINE_STAT(STAT_DasherProjectilesSpawned);
+DEFINE_STAT(STAT_DasherProjectilesDestroyed);
+DEFINE_STAT(STAT_DasherServerFireRPCsSent);
+DEFINE_STAT(STAT_DasherServerFireRPCBytes);
+DEFINE_STAT(STAT_DasherShotsRejected);
+DEFINE_STAT(STAT_DasherServerAltFireRPCsSent);
+DEFINE_STAT(STAT_DasherServerLookRPCsSent);
+DEFINE_STAT(STAT_DasherServerLookRPCBytes);
+DEFINE_STAT(STAT_DasherPickups);
+
+DEFINE_STAT(STAT_DasherPredictedShots);
+DEFINE_STAT(STAT_DasherPredictedShotsMatched);
+DEFINE_STAT(STAT_DasherPredictedShotsRejected);
+DEFINE_STAT(STAT_DasherPredictedShotsUnmatched);
+
+class FDasherGameModule : public FDefaultGameModuleImpl
+{
+public:
+
+    virtual void StartupModule() override
+    {
+        // -DasherTrackAllocations wraps the allocator for FDasherAllocationTracker, as early as the game gets to
+        FDasherAllocationTracker::Install();
+
+        // The game net driver uses the Dasher replication graph unless the server runs with -NoDasherRepGraph
+        UReplicationDriver::CreateReplicationDriverDelegate().BindLambda([](UNetDriver* ForNetDriver, const FURL& URL, UWorld* World) -> UReplicationDriver*
+        {
+            if (ForNetDriver->NetDriverName != NAME_GameNetDriver || FParse::Param(FCommandLine::Get(), TEXT("NoDasherRepGraph")))
+            {
+                return nullptr;
+            }
+            return NewObject<UDasherReplicationGraph>(GetTransientPackage());
+        });
+
+        // -DasherTelemetry records gameplay events from the start, to the file given with -DasherTelemetry=<File>
+        FString TelemetryFile;
+        if (FParse::Value(FCommandLine::Get(), TEXT("DasherTelemetry="), TelemetryFile) || FParse::Param(FCommandLine::Get(), TEXT("DasherTelemetry")))
+        {
+            FDasherTelemetry::Start(TelemetryFile);
+        }
+
+        // -DasherInputRecord records the players' inputs from the start, to the file given with -DasherInputRecord=<File>
+        FString InputRecordFile;
+        if (FParse::Value(FCommandLine::Get(), TEXT("DasherInputRecord="), InputRecordFile) || FParse::Param(FCommandLine::Get(), TEXT("DasherInputRecord")))
+        {
+            FDasherInputRecorder::Start(InputRecordFile);
+        }
+    }
+
+    virtual void ShutdownModule() override
+    {
+        FDasherInputRecorder::Stop();
+        FDasherTelemetry::Stop();
+        UReplicationDriver::CreateReplicationDriverDelegate().Unbind();
+    }
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FDasherGameModule, Dasher, "Dasher" );
@@ -3,3 +3,47 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+
+DASHER_API DECLARE_LOG_CATEGORY_EXTERN(LogDasher, Log, All);
+
+/** Stat group for all Dasher gameplay systems, shown with 'stat Dasher' */
+DECLARE_STATS_GROUP(TEXT("Dasher"), STATGROUP_Dasher, STATCAT_Advanced);
+
+/** Insights channel for Dasher gameplay scopes, captured with -trace=default,Dasher or 'Trace.Enable Dasher' */
+UE_TRACE_CHANNEL_EXTERN(DasherChannel, DASHER_API);
+
+// Gameplay hot paths, timed with DASHER_SCOPE_CYCLE_COUNTER
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Character Move"), STAT_DasherCharacterMove, STATGROUP_Dasher, DASHER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Character Look"), STAT_DasherCharacterLook, STATGROUP_Dasher, DASHER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Character Fire"), STAT_DasherCharacterFire, STATGROUP_Dasher, DASHER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Weapon Server Fire"), STAT_DasherWeaponServerFire, STATGROUP_Dasher, DASHER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Projectile Hit"), STAT_DasherProjectileHit, STATGROUP_Dasher, DASHER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pick Up"), STAT_DasherPickUp, STATGROUP_Dasher, DASHER_API);
+
+// Per frame counters
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Projectiles Spawned"), STAT_DasherProjectilesSpawned, STATGROUP_Dasher, DASHER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Projectiles Destroyed"), STAT_DasherProjectilesDestroyed, STATGROUP_Dasher, DASHER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("ServerFireBatch RPCs Sent"), STAT_DasherServerFireRPCsSent, STATGROUP_Dasher, DASHER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("ServerFireBatch RPC Payload Bytes"), STAT_DasherServerFireRPCBytes, STATGROUP_Dasher, DASHER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Shots Rejected"), STAT_DasherShotsRejected, STATGROUP_Dasher, DASHER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("ServerAltFire RPCs Sent"), STAT_DasherServerAltFireRPCsSent, STATGROUP_Dasher, DASHER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("ServerLook RPCs Sent"), STAT_DasherServerLookRPCsSent, STATGROUP_Dasher, DASHER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("ServerLook RPC Payload Bytes"), STAT_DasherServerLookRPCBytes, STATGROUP_Dasher, DASHER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pickups"), STAT_DasherPickups, STATGROUP_Dasher, DASHER_API);
+
+// Running totals of the shots a client predicted, see UDasherProjectilePredictionSubsystem
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Predicted Shots"), STAT_DasherPredictedShots, STATGROUP_Dasher, DASHER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Predicted Shots Matched"), STAT_DasherPredictedShotsMatched, STATGROUP_Dasher, DASHER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Predicted Shots Rejected"), STAT_DasherPredictedShotsRejected, STATGROUP_Dasher, DASHER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Predicted Shots Unmatched"), STAT_DasherPredictedShotsUnmatched, STATGROUP_Dasher, DASHER_API);
+
+/**
+ * Times the enclosing scope with STAT_<Name> for 'stat Dasher' and as a <Name> CPU event on the Dasher trace channel.
+ * Both compile out of builds without stats and trace.
+ */
+#define DASHER_SCOPE_CYCLE_COUNTER(Name) \
+    SCOPE_CYCLE_COUNTER(STAT_##Name); \
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Name, DasherChannel)
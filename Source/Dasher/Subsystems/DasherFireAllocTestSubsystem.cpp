@@ -0,0 +1,236 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherFireAllocTestSubsystem.h"
+
+#include "Dasher.h"
+#include "Characters/DasherCharacter.h"
+#include "Core/DasherAllocationTracker.h"
+#include "Core/DasherBotController.h"
+#include "Core/DasherPerfCounters.h"
+#include "Subsystems/DasherLoadTestSubsystem.h"
+
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+
+static FAutoConsoleCommandWithWorldAndArgs FireAllocTestCommand(
+    TEXT("dasher.FireAllocTest"),
+    TEXT("Fires from a bot on the server and fails if the fire path allocates once warmed up. Usage: dasher.FireAllocTest [Shots=10000]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+    {
+        if (UDasherFireAllocTestSubsystem* FireAllocTest = World != nullptr ? World->GetSubsystem<UDasherFireAllocTestSubsystem>() : nullptr)
+        {
+            FireAllocTest->StartTest(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10000);
+        }
+    }));
+
+void UDasherFireAllocTestSubsystem::Deinitialize()
+{
+    // The world is going away with the bot, only the tracker is ours to stop
+    if (IsRunning())
+    {
+        FDasherAllocationTracker::Stop();
+        Phase = EPhase::Idle;
+    }
+
+    Super::Deinitialize();
+}
+
+void UDasherFireAllocTestSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    int32 Shots = 0;
+    if (InWorld.GetNetMode() == NM_Client || !FParse::Value(FCommandLine::Get(), TEXT("DasherFireAllocTest="), Shots))
+    {
+        return;
+    }
+
+    bExitWhenDone = !GIsEditor;
+    if (!StartTest(Shots) && bExitWhenDone)
+    {
+        FPlatformMisc::RequestExitWithStatus(false, 1);
+    }
+}
+
+bool UDasherFireAllocTestSubsystem::StartTest(int32 Shots)
+{
+    if (IsRunning())
+    {
+        UE_LOG(LogDasher, Warning, TEXT("Fire allocation test is already running"));
+        return false;
+    }
+
+    if (!FDasherAllocationTracker::CanTrack())
+    {
+        UE_LOG(LogDasher, Error, TEXT("Fire allocation test can't track allocations, start with -DasherTrackAllocations in a non-shipping build"));
+        return false;
+    }
+
+    UDasherLoadTestSubsystem* LoadTest = GetWorld()->GetSubsystem<UDasherLoadTestSubsystem>();
+    if (LoadTest == nullptr || LoadTest->IsRunning())
+    {
+        UE_LOG(LogDasher, Error, TEXT("Fire allocation test needs an idle load test for its bot"));
+        return false;
+    }
+
+    LoadTest->StartLoadTest(1, 0.f, FPaths::ProfilingDir() / TEXT("FireAllocTest") / TEXT("LoadTest.csv"));
+    if (!LoadTest->IsRunning())
+    {
+        return false;
+    }
+
+    // The bot only walks, every shot is fired by the test at its own rate
+    for (const TWeakObjectPtr<ADasherBotController>& Bot : LoadTest->GetBots())
+    {
+        if (Bot.IsValid())
+        {
+            Bot->SetChances(0.f, 0.f, 0.f);
+        }
+    }
+
+    NumShots = FMath::Max(Shots, 1);
+    PhaseShots = 0;
+    bCompleted = false;
+    Shooter.Reset();
+    Phase = EPhase::WaitingForShooter;
+    PhaseEndTime = GetWorld()->GetTimeSeconds() + ShooterTimeout;
+
+    UE_LOG(LogDasher, Log, TEXT("Fire allocation test started: %d shots after %d to warm up"), NumShots, WarmUpShots);
+    return true;
+}
+
+void UDasherFireAllocTestSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    if (Phase == EPhase::Idle)
+    {
+        return;
+    }
+
+    const double WorldTime = GetWorld()->GetTimeSeconds();
+    switch (Phase)
+    {
+    case EPhase::WaitingForShooter:
+        if (const UDasherLoadTestSubsystem* LoadTest = GetWorld()->GetSubsystem<UDasherLoadTestSubsystem>())
+        {
+            for (const TWeakObjectPtr<ADasherBotController>& Bot : LoadTest->GetBots())
+            {
+                ADasherCharacter* Character = Bot.IsValid() ? Cast<ADasherCharacter>(Bot->GetPawn()) : nullptr;
+                if (Character != nullptr && Character->GetActiveWeaponComponent() != nullptr)
+                {
+                    Shooter = Character;
+                    Phase = EPhase::WarmingUp;
+                    PhaseStartServerShots = FDasherPerfCounters::Get().ServerShots;
+                    return;
+                }
+            }
+        }
+        if (WorldTime >= PhaseEndTime)
+        {
+            UE_LOG(LogDasher, Error, TEXT("Fire allocation test has no armed bot after %.0f seconds, check the load test's BotWeaponClass"), ShooterTimeout);
+            FinishTest(false);
+        }
+        break;
+
+    case EPhase::WarmingUp:
+        if (!FireShots())
+        {
+            FinishTest(false);
+        }
+        else if (PhaseShots >= WarmUpShots)
+        {
+            if (!FDasherAllocationTracker::Start())
+            {
+                FinishTest(false);
+                return;
+            }
+            Phase = EPhase::Measuring;
+            PhaseShots = 0;
+            PhaseStartServerShots = FDasherPerfCounters::Get().ServerShots;
+        }
+        break;
+
+    case EPhase::Measuring:
+        if (!FireShots())
+        {
+            FinishTest(false);
+        }
+        else if (PhaseShots >= NumShots)
+        {
+            // Shots already due still come out of this frame's update, they are counted while draining
+            Shooter->StopFire(FInputActionValue(false));
+            Phase = EPhase::Draining;
+            PhaseEndTime = WorldTime + DrainSeconds;
+        }
+        break;
+
+    case EPhase::Draining:
+        if (WorldTime >= PhaseEndTime)
+        {
+            FinishTest(true);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+TStatId UDasherFireAllocTestSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UDasherFireAllocTestSubsystem, STATGROUP_Tickables);
+}
+
+bool UDasherFireAllocTestSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UDasherFireAllocTestSubsystem::FireShots()
+{
+    ADasherCharacter* Character = Shooter.Get();
+    AController* Controller = Character != nullptr ? Character->GetController() : nullptr;
+    if (Controller == nullptr || Character->GetActiveWeaponComponent() == nullptr)
+    {
+        UE_LOG(LogDasher, Error, TEXT("Fire allocation test lost its bot or its weapon"));
+        return false;
+    }
+
+    // Bots view from their eyes, which follow the control rotation
+    Controller->SetControlRotation(FRotator(AimPitch, Controller->GetControlRotation().Yaw, 0.f));
+
+    // Fire input comes once a frame while the trigger is held, the scheduler fires at the weapon's rate. Only the shots
+    // the server fired count, the scheduler fires nothing on frames between two shots
+    Character->Fire(FInputActionValue(true));
+    PhaseShots = static_cast<int32>(FDasherPerfCounters::Get().ServerShots - PhaseStartServerShots);
+    return true;
+}
+
+void UDasherFireAllocTestSubsystem::FinishTest(bool bInCompleted)
+{
+    bCompleted = bInCompleted;
+    const bool bMeasured = FDasherAllocationTracker::IsTracking();
+    FDasherAllocationTracker::Stop();
+    Phase = EPhase::Idle;
+
+    if (UDasherLoadTestSubsystem* LoadTest = GetWorld()->GetSubsystem<UDasherLoadTestSubsystem>())
+    {
+        LoadTest->StopLoadTest();
+    }
+
+    if (bMeasured)
+    {
+        FDasherAllocationTracker::LogReport(*FString::Printf(TEXT("Fire allocation test, %d of %d shots"), PhaseShots, NumShots));
+    }
+
+    const bool bPassed = bCompleted && FDasherAllocationTracker::GetNumAllocations() == 0 && FDasherAllocationTracker::GetNumObjects() == 0;
+    UE_LOG(LogDasher, Display, TEXT("Fire allocation test %s"), bPassed ? TEXT("passed") : TEXT("FAILED"));
+
+    if (bExitWhenDone)
+    {
+        FPlatformMisc::RequestExitWithStatus(false, bPassed ? 0 : 1);
+    }
+}
@@ -0,0 +1,111 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DasherFireAllocTestSubsystem.generated.h"
+
+class ADasherCharacter;
+
+/**
+ * Checks that sustained fire doesn't allocate once warmed up. A load test bot holds the trigger through
+ * ADasherCharacter::Fire once a frame, the way a player's input does, and the fire scheduler fires at the weapon's rate,
+ * first to warm the projectile pool up, then for the measured shots. Shots are counted as the server fires them. Meanwhile
+ * FDasherAllocationTracker counts every heap allocation and new UObject of the game thread: the fire handler and the
+ * scheduler update, ServerFireBatch, projectile movement, the projectiles hitting and the pool expiring them, and the
+ * replication of all that. Any allocation fails the test, and the callstack of the first one is logged.
+ * The Dasher.Performance.FireAllocation automation test runs it and asserts on the tracker's counts. It can also run on a
+ * headless server for CI, the process exits with 0 when nothing was allocated and 1 otherwise:
+ *   UnrealEditor-Cmd Dasher.uproject FirstPersonMap -server -nullrhi -log -DasherTrackAllocations -DasherFireAllocTest=10000
+ * In a running game use dasher.FireAllocTest [Shots]. Needs -DasherTrackAllocations, and isn't available in
+ * shipping builds, which can't track allocations.
+ */
+UCLASS(config=Game)
+class DASHER_API UDasherFireAllocTestSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Starts firing, returns false if allocations can't be tracked or the world isn't a server */
+    bool StartTest(int32 Shots);
+
+    bool IsRunning() const { return Phase != EPhase::Idle; }
+
+    /** Whether the last test fired all its shots, whatever it allocated */
+    bool HasCompleted() const { return bCompleted; }
+
+    /** Shots the server fired in the phase the last test got to, the measured ones if it completed */
+    int32 GetNumShotsFired() const { return PhaseShots; }
+
+    // USubsystem interface
+    virtual void Deinitialize() override;
+    // End of USubsystem interface
+
+    // UWorldSubsystem interface
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    // End of UWorldSubsystem interface
+
+    // UTickableWorldSubsystem interface
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    // End of UTickableWorldSubsystem interface
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    /** Shots fired before counting, enough to fill the projectile pool to its high-water mark a few times over */
+    UPROPERTY(Config)
+    int32 WarmUpShots = 100;
+
+    /** Pitch the bot aims at, downwards so projectiles hit the floor and bounce */
+    UPROPERTY(Config)
+    float AimPitch = -30.f;
+
+    /** Seconds still counted after the last shot, so its projectile hits and expires while counting */
+    UPROPERTY(Config)
+    float DrainSeconds = 4.f;
+
+    /** Seconds to wait for the bot to spawn armed */
+    UPROPERTY(Config)
+    float ShooterTimeout = 10.f;
+
+private:
+
+    enum class EPhase : uint8
+    {
+        Idle,
+        WaitingForShooter,
+        WarmingUp,
+        Measuring,
+        Draining
+    };
+
+    /** Holds the trigger for this frame and counts the shots the server fired since. Returns false if the shooter is gone */
+    bool FireShots();
+
+    /** Stops counting and the bot, logs the result and exits if started from the command line */
+    void FinishTest(bool bInCompleted);
+
+    EPhase Phase = EPhase::Idle;
+
+    TWeakObjectPtr<ADasherCharacter> Shooter;
+
+    /** Shots measured */
+    int32 NumShots = 0;
+
+    /** Shots the server fired in the current phase */
+    int32 PhaseShots = 0;
+
+    /** FDasherPerfCounters::ServerShots when the current phase started */
+    uint64 PhaseStartServerShots = 0;
+
+    double PhaseEndTime = 0.0;
+
+    /** Set when started from the command line, the process exits when the test is over */
+    bool bExitWhenDone = false;
+
+    bool bCompleted = false;
+};
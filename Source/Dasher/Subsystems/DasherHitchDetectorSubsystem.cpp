@@ -0,0 +1,176 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherHitchDetectorSubsystem.h"
+
+#include "Dasher.h"
+#include "Characters/DasherCharacter.h"
+#include "Subsystems/DasherPickupSubsystem.h"
+#include "Subsystems/DasherProjectileManagerSubsystem.h"
+#include "Subsystems/DasherProjectilePoolSubsystem.h"
+
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "JsonObjectConverter.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/TraceAuxiliary.h"
+#include "Trace/Trace.h"
+
+static FAutoConsoleCommandWithWorld HitchDumpCommand(
+    TEXT("dasher.Hitch.Dump"),
+    TEXT("Writes the trace of the last few seconds and the live actor counts, as if this frame had hitched."),
+    FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+    {
+        if (UDasherHitchDetectorSubsystem* HitchDetector = World != nullptr ? World->GetSubsystem<UDasherHitchDetectorSubsystem>() : nullptr)
+        {
+            HitchDetector->DumpHitch(0.f);
+        }
+    }));
+
+void UDasherHitchDetectorSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // The enabled channels cost every frame whether or not anything hitches, so servers opt in
+    bEnabled = FParse::Param(FCommandLine::Get(), TEXT("DasherHitchDetector"));
+    if (!bEnabled)
+    {
+        return;
+    }
+
+    FParse::Value(FCommandLine::Get(), TEXT("DasherHitchMs="), ThresholdMs);
+
+#if UE_TRACE_ENABLED
+    // Without a trace connection, enabled channels only write to the tail
+    TArray<FString> Channels;
+    TraceChannels.ParseIntoArray(Channels, TEXT(","));
+    for (const FString& Channel : Channels)
+    {
+        if (!UE::Trace::ToggleChannel(*Channel.TrimStartAndEnd(), true))
+        {
+            UE_LOG(LogDasher, Warning, TEXT("Hitch detector couldn't enable trace channel %s"), *Channel);
+        }
+    }
+#else
+    UE_LOG(LogDasher, Warning, TEXT("Hitch detector can't trace in this build, hitches will only be reported"));
+#endif
+
+    LastTickTime = FPlatformTime::Seconds();
+    ArmTime = LastTickTime + WarmUpSeconds;
+    UE_LOG(LogDasher, Log, TEXT("Hitch detector watching for frames over %.1f ms"), ThresholdMs);
+}
+
+void UDasherHitchDetectorSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    if (!bEnabled)
+    {
+        return;
+    }
+
+    // Measured in real time without the time slept to hold the tick rate, like the perf gate
+    const double Now = FPlatformTime::Seconds();
+    const float FrameMs = static_cast<float>(FMath::Max(Now - LastTickTime - FApp::GetIdleTime(), 0.0) * 1000.0);
+    LastTickTime = Now;
+
+    if (FrameMs <= ThresholdMs || Now < ArmTime)
+    {
+        return;
+    }
+
+    UE_LOG(LogDasher, Warning, TEXT("Hitch: frame %llu took %.1f ms"), GFrameCounter, FrameMs);
+    if (NumDumps < MaxDumps && Now - LastDumpTime >= MinSecondsBetweenDumps)
+    {
+        DumpHitch(FrameMs);
+    }
+
+    // Writing the snapshot hitches too, the next frame is measured from here
+    LastTickTime = FPlatformTime::Seconds();
+}
+
+TStatId UDasherHitchDetectorSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UDasherHitchDetectorSubsystem, STATGROUP_Tickables);
+}
+
+bool UDasherHitchDetectorSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UDasherHitchDetectorSubsystem::DumpHitch(float FrameMs)
+{
+    LastDumpTime = FPlatformTime::Seconds();
+    ++NumDumps;
+
+    const FString BaseFilename = FPaths::ProfilingDir() / TEXT("Hitches") / FString::Printf(TEXT("Hitch_%s_%llu"), *FDateTime::Now().ToString(), GFrameCounter);
+    FDasherHitchReport Report = MakeReport(FrameMs);
+
+#if UE_TRACE_ENABLED
+    const FString TraceFile = BaseFilename + TEXT(".utrace");
+    if (FTraceAuxiliary::WriteSnapshot(*TraceFile))
+    {
+        Report.TraceFile = FPaths::GetCleanFilename(TraceFile);
+    }
+    else
+    {
+        UE_LOG(LogDasher, Warning, TEXT("Hitch detector couldn't write the trace snapshot %s"), *TraceFile);
+    }
+#endif
+
+    FString Json;
+    FJsonObjectConverter::UStructToJsonObjectString(Report, Json);
+
+    const FString ReportFile = BaseFilename + TEXT(".json");
+    const bool bSaved = FFileHelper::SaveStringToFile(Json, *ReportFile);
+    UE_LOG(LogDasher, Warning, TEXT("Hitch detector %s %s: %d characters, %d live and %d pooled projectiles, %d batched, %d pickups, %d actors"),
+        bSaved ? TEXT("wrote") : TEXT("couldn't write"), *ReportFile, Report.NumCharacters, Report.NumLiveProjectiles, Report.NumPooledProjectiles,
+        Report.NumBatchedProjectiles, Report.NumPickups, Report.NumActors);
+    return bSaved;
+}
+
+FDasherHitchReport UDasherHitchDetectorSubsystem::MakeReport(float FrameMs) const
+{
+    UWorld* World = GetWorld();
+
+    FDasherHitchReport Report;
+    Report.FrameMs = FrameMs;
+    Report.ThresholdMs = ThresholdMs;
+    Report.Frame = static_cast<int64>(GFrameCounter);
+    Report.WorldSeconds = World->GetTimeSeconds();
+    Report.Map = World->GetMapName();
+    Report.NumActors = World->GetActorCount();
+
+    // Only walked on a hitch, nothing is counted while the server runs well
+    for (TActorIterator<ADasherCharacter> It(World); It; ++It)
+    {
+        ++Report.NumCharacters;
+    }
+
+    if (const UDasherProjectilePoolSubsystem* ProjectilePool = World->GetSubsystem<UDasherProjectilePoolSubsystem>())
+    {
+        ProjectilePool->GetProjectileCounts(Report.NumPooledProjectiles, Report.NumLiveProjectiles);
+    }
+    if (const UDasherProjectileManagerSubsystem* ProjectileManager = World->GetSubsystem<UDasherProjectileManagerSubsystem>())
+    {
+        Report.NumBatchedProjectiles = ProjectileManager->GetNumProjectiles();
+    }
+    if (const UDasherPickupSubsystem* PickupSubsystem = World->GetSubsystem<UDasherPickupSubsystem>())
+    {
+        Report.NumPickups = PickupSubsystem->GetNumPickups();
+    }
+
+    if (const UNetDriver* NetDriver = World->GetNetDriver())
+    {
+        Report.NumConnections = NetDriver->ClientConnections.Num();
+        Report.InKBPerSecond = NetDriver->InBytesPerSecond / 1024.f;
+        Report.OutKBPerSecond = NetDriver->OutBytesPerSecond / 1024.f;
+    }
+
+    return Report;
+}
@@ -0,0 +1,133 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DasherHitchDetectorSubsystem.generated.h"
+
+/** What the world looked like on a hitching frame, written next to its trace snapshot */
+USTRUCT()
+struct FDasherHitchReport
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    float FrameMs = 0.f;
+
+    UPROPERTY()
+    float ThresholdMs = 0.f;
+
+    UPROPERTY()
+    int64 Frame = 0;
+
+    UPROPERTY()
+    float WorldSeconds = 0.f;
+
+    UPROPERTY()
+    FString Map;
+
+    UPROPERTY()
+    int32 NumActors = 0;
+
+    UPROPERTY()
+    int32 NumCharacters = 0;
+
+    /** Projectile actors flying */
+    UPROPERTY()
+    int32 NumLiveProjectiles = 0;
+
+    /** Projectile actors waiting in the pool */
+    UPROPERTY()
+    int32 NumPooledProjectiles = 0;
+
+    /** Projectiles simulated by the projectile manager, without actors */
+    UPROPERTY()
+    int32 NumBatchedProjectiles = 0;
+
+    UPROPERTY()
+    int32 NumPickups = 0;
+
+    UPROPERTY()
+    int32 NumConnections = 0;
+
+    UPROPERTY()
+    float InKBPerSecond = 0.f;
+
+    UPROPERTY()
+    float OutKBPerSecond = 0.f;
+
+    /** Trace snapshot of the seconds before the hitch, empty if the build can't trace */
+    UPROPERTY()
+    FString TraceFile;
+};
+
+/**
+ * Catches server hitches as they happen, instead of from player reports.
+ * Turns on the trace channels below without connecting a trace, so the events only go to the trace tail, an in-memory
+ * ring of the last few seconds whose size is set with -tracetailmb=. When a frame's work time goes over ThresholdMs,
+ * the tail is written to a .utrace snapshot in Saved/Profiling/Hitches, with a .json report of the live actor counts.
+ * Steady state it costs one timer read per frame, plus whatever the enabled channels cost to emit into memory, which
+ * for the CPU scopes of a busy server is not nothing. Off unless the process runs with -DasherHitchDetector.
+ * dasher.Hitch.Dump writes a snapshot now.
+ */
+UCLASS(config=Game)
+class DASHER_API UDasherHitchDetectorSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Writes the trace tail and a report of the world, returns whether the report was written */
+    bool DumpHitch(float FrameMs);
+
+    bool IsEnabled() const { return bEnabled; }
+
+    // UWorldSubsystem interface
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    // End of UWorldSubsystem interface
+
+    // UTickableWorldSubsystem interface
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    // End of UTickableWorldSubsystem interface
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    /** Frame work time over which a frame is a hitch, -DasherHitchMs= overrides it */
+    UPROPERTY(Config)
+    float ThresholdMs = 50.f;
+
+    /** Trace channels kept in the tail, comma separated. Stats and Net say more but cost a lot more to emit */
+    UPROPERTY(Config)
+    FString TraceChannels = TEXT("Cpu,Frame,Bookmark,Dasher");
+
+    /** Seconds after the world begins play before hitches count, loading the map hitches by design */
+    UPROPERTY(Config)
+    float WarmUpSeconds = 10.f;
+
+    /** Least seconds between two dumps, a struggling server hitches in bursts */
+    UPROPERTY(Config)
+    float MinSecondsBetweenDumps = 30.f;
+
+    /** Most dumps per process, so a server that keeps hitching doesn't fill the disk */
+    UPROPERTY(Config)
+    int32 MaxDumps = 20;
+
+private:
+
+    FDasherHitchReport MakeReport(float FrameMs) const;
+
+    double LastTickTime = 0.0;
+
+    /** Time hitches start counting from */
+    double ArmTime = 0.0;
+
+    double LastDumpTime = -DBL_MAX;
+
+    int32 NumDumps = 0;
+
+    bool bEnabled = false;
+};
@@ -0,0 +1,274 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherInputReplaySubsystem.h"
+
+#include "Dasher.h"
+#include "Characters/DasherCharacter.h"
+
+#include "AIController.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+
+static FAutoConsoleCommandWithWorldAndArgs InputReplayStartCommand(
+    TEXT("dasher.InputReplay.Start"),
+    TEXT("Replays an input recording, or the merged recordings of a directory, on the server with characters of its own. Usage: dasher.InputReplay.Start <File|Directory>"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+    {
+        UDasherInputReplaySubsystem* InputReplay = World != nullptr ? World->GetSubsystem<UDasherInputReplaySubsystem>() : nullptr;
+        if (InputReplay != nullptr && Args.Num() > 0)
+        {
+            InputReplay->StartReplay(Args[0]);
+        }
+    }));
+
+static FAutoConsoleCommandWithWorld InputReplayStopCommand(
+    TEXT("dasher.InputReplay.Stop"),
+    TEXT("Stops the input replay and removes its characters."),
+    FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+    {
+        if (UDasherInputReplaySubsystem* InputReplay = World != nullptr ? World->GetSubsystem<UDasherInputReplaySubsystem>() : nullptr)
+        {
+            InputReplay->StopReplay();
+        }
+    }));
+
+void UDasherInputReplaySubsystem::Deinitialize()
+{
+    // The world is going away with the characters, only the time step is ours to restore
+    if (bReplaying && bFixedTimeStep)
+    {
+        FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+        FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+    }
+    bReplaying = false;
+
+    Super::Deinitialize();
+}
+
+void UDasherInputReplaySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    FString Filename;
+    if (InWorld.GetNetMode() == NM_Client || !FParse::Value(FCommandLine::Get(), TEXT("DasherInputReplay="), Filename))
+    {
+        return;
+    }
+
+    bExitWhenDone = !GIsEditor;
+    if (!StartReplay(Filename) && bExitWhenDone)
+    {
+        FPlatformMisc::RequestExitWithStatus(false, 1);
+    }
+}
+
+bool UDasherInputReplaySubsystem::StartReplay(const FString& Filename)
+{
+    if (bReplaying)
+    {
+        UE_LOG(LogDasher, Warning, TEXT("Input replay is already running"));
+        return false;
+    }
+
+    if (GetWorld()->GetAuthGameMode() == nullptr)
+    {
+        UE_LOG(LogDasher, Warning, TEXT("Input replay needs a game mode, it can only run on the server"));
+        return false;
+    }
+
+    if (!LoadRecording(Filename) || Recording.Frames.Num() == 0)
+    {
+        return false;
+    }
+
+    const FString WorldMap = UWorld::RemovePIEPrefix(GetWorld()->GetMapName());
+    if (!Recording.Map.IsEmpty() && Recording.Map != WorldMap)
+    {
+        UE_LOG(LogDasher, Warning, TEXT("Input replay of %s recorded on %s runs on %s, the players may not end up where they were"), *Filename, *Recording.Map, *WorldMap);
+    }
+
+    Controllers.Reset();
+    Controllers.SetNum(Recording.Players.Num());
+    FrameIndex = 0;
+    StartTime = FPlatformTime::Seconds();
+    bReplaying = true;
+
+    // Anything rolling FMath::Rand during the replay rolls the same numbers every run
+    FMath::RandInit(0);
+    FMath::SRandInit(0);
+
+    // Outside the editor, frames take the recorded delta time and don't wait for real time to catch up
+    bFixedTimeStep = !GIsEditor;
+    if (bFixedTimeStep)
+    {
+        bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+        PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+        FApp::SetUseFixedTimeStep(true);
+        FApp::SetFixedDeltaTime(Recording.Frames[0].DeltaSeconds);
+    }
+
+    UE_LOG(LogDasher, Log, TEXT("Input replay started: %d players over %d frames from %s, recorded %s"), Recording.Players.Num(), Recording.Frames.Num(),
+        *Filename, *FDateTime(Recording.StartUtcTicks).ToString());
+    return true;
+}
+
+bool UDasherInputReplaySubsystem::LoadRecording(const FString& Filename)
+{
+    if (!IFileManager::Get().DirectoryExists(*Filename))
+    {
+        return Recording.Load(Filename);
+    }
+
+    TArray<FString> Files;
+    IFileManager::Get().FindFiles(Files, *(Filename / TEXT("*.dinp")), true, false);
+    Files.Sort();
+
+    TArray<FDasherInputRecording> Recordings;
+    Recordings.Reserve(Files.Num());
+    for (const FString& File : Files)
+    {
+        FDasherInputRecording& Loaded = Recordings.AddDefaulted_GetRef();
+        if (!Loaded.Load(Filename / File))
+        {
+            Recordings.Pop();
+        }
+    }
+    if (Recordings.Num() == 0)
+    {
+        UE_LOG(LogDasher, Error, TEXT("No input recording in %s could be loaded"), *Filename);
+        return false;
+    }
+
+    Recording.Merge(Recordings, MergedFrameSeconds);
+    UE_LOG(LogDasher, Log, TEXT("Merged %d input recordings from %s"), Recordings.Num(), *Filename);
+    return true;
+}
+
+void UDasherInputReplaySubsystem::StopReplay()
+{
+    if (!bReplaying)
+    {
+        return;
+    }
+    bReplaying = false;
+
+    for (int32 Player = 0; Player < Controllers.Num(); ++Player)
+    {
+        RemovePlayer(Player);
+    }
+    Controllers.Reset();
+
+    if (bFixedTimeStep)
+    {
+        FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+        FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+    }
+
+    UE_LOG(LogDasher, Log, TEXT("Input replay played %d of %d frames in %.1f seconds"), FrameIndex, Recording.Frames.Num(), FPlatformTime::Seconds() - StartTime);
+
+    if (bExitWhenDone)
+    {
+        FPlatformMisc::RequestExit(false);
+    }
+}
+
+void UDasherInputReplaySubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    if (!bReplaying)
+    {
+        return;
+    }
+
+    const FDasherRecordedFrame& Frame = Recording.Frames[FrameIndex];
+    for (int32 EventIndex = Frame.FirstEvent; EventIndex < Frame.FirstEvent + Frame.NumEvents; ++EventIndex)
+    {
+        const FDasherRecordedEvent& Event = Recording.Events[EventIndex];
+        switch (Event.Type)
+        {
+        case FDasherRecordedEvent::EType::AddPlayer:
+            AddPlayer(Event.Player);
+            break;
+        case FDasherRecordedEvent::EType::RemovePlayer:
+            RemovePlayer(Event.Player);
+            break;
+        case FDasherRecordedEvent::EType::Input:
+        {
+            AAIController* Controller = Controllers[Event.Player].Get();
+            if (ADasherCharacter* Character = Controller != nullptr ? Cast<ADasherCharacter>(Controller->GetPawn()) : nullptr)
+            {
+                Character->ReplayInput(Event.Input, Event.Value);
+            }
+            break;
+        }
+        }
+    }
+
+    if (++FrameIndex >= Recording.Frames.Num())
+    {
+        StopReplay();
+    }
+    else if (bFixedTimeStep)
+    {
+        FApp::SetFixedDeltaTime(Recording.Frames[FrameIndex].DeltaSeconds);
+    }
+}
+
+TStatId UDasherInputReplaySubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UDasherInputReplaySubsystem, STATGROUP_Tickables);
+}
+
+bool UDasherInputReplaySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDasherInputReplaySubsystem::AddPlayer(int32 Player)
+{
+    UWorld* World = GetWorld();
+
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+    SpawnParams.ObjectFlags |= RF_Transient;
+    AAIController* Controller = World->SpawnActor<AAIController>(SpawnParams);
+    if (Controller == nullptr)
+    {
+        return;
+    }
+
+    // The control rotation is turned by the character's Look handler, like for bots
+    Controller->bSetControlRotationFromPawnOrientation = false;
+
+    const FTransform& Transform = Recording.Players[Player].Transform;
+    World->GetAuthGameMode()->RestartPlayerAtTransform(Controller, Transform);
+    Controller->SetControlRotation(Transform.Rotator());
+    Controllers[Player] = Controller;
+}
+
+void UDasherInputReplaySubsystem::RemovePlayer(int32 Player)
+{
+    AAIController* Controller = Controllers[Player].Get();
+    Controllers[Player].Reset();
+    if (Controller == nullptr)
+    {
+        return;
+    }
+
+    if (APawn* Pawn = Controller->GetPawn())
+    {
+        // The weapon is attached to the character
+        TArray<AActor*> AttachedActors;
+        Pawn->GetAttachedActors(AttachedActors);
+        for (AActor* AttachedActor : AttachedActors)
+        {
+            AttachedActor->Destroy();
+        }
+        Pawn->Destroy();
+    }
+    Controller->Destroy();
+}
@@ -0,0 +1,88 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Core/DasherInputRecording.h"
+#include "DasherInputReplaySubsystem.generated.h"
+
+class AAIController;
+
+/**
+ * Replays an input recording on the server, to reproduce the load of a session without its players.
+ * Clients only record their own players, so given a directory the replay merges every recording in it, lined up by when
+ * each started and played in frames of MergedFrameSeconds.
+ * Every recorded player gets a character where theirs came into play, possessed by an AI controller and played
+ * through the same input handlers, frame by frame. Each frame runs with the delta time it was recorded with, on a
+ * fixed time step outside the editor, so the replay runs as fast as the server can and makes the same moves every time:
+ *   UnrealEditor-Cmd Dasher.uproject FirstPersonMap -server -nullrhi -DasherGrantWeapons -DasherInputReplay=Inputs.dinp
+ * Add -DasherGrantWeapons if the recorded session had it, the replayed characters are then armed the same way.
+ * The process exits when the recording ends, unless running in the editor. In a running game use dasher.InputReplay.Start and Stop.
+ */
+UCLASS()
+class DASHER_API UDasherInputReplaySubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Frame time of a replay merged from several recordings, the server's tick rate */
+    static constexpr float MergedFrameSeconds = 1.f / 30.f;
+
+    /**
+     * Loads the recording, or merges every recording in a directory, and starts replaying it.
+     * Returns false if nothing can be loaded or the world isn't a server
+     */
+    bool StartReplay(const FString& Filename);
+
+    /** Removes the replayed characters */
+    void StopReplay();
+
+    bool IsReplaying() const { return bReplaying; }
+
+    // USubsystem interface
+    virtual void Deinitialize() override;
+    // End of USubsystem interface
+
+    // UWorldSubsystem interface
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    // End of UWorldSubsystem interface
+
+    // UTickableWorldSubsystem interface
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    // End of UTickableWorldSubsystem interface
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+    /** Loads the file, or merges the recordings in the directory, into Recording */
+    bool LoadRecording(const FString& Filename);
+
+    void AddPlayer(int32 Player);
+    void RemovePlayer(int32 Player);
+
+    FDasherInputRecording Recording;
+
+    /** Controller of each recorded player, null before it comes into play and after it leaves */
+    TArray<TWeakObjectPtr<AAIController>> Controllers;
+
+    /** Next recorded frame to play */
+    int32 FrameIndex = 0;
+
+    double StartTime = 0.0;
+
+    /** Time step settings before the replay took them over */
+    double PreviousFixedDeltaTime = 0.0;
+    bool bPreviousUseFixedTimeStep = false;
+
+    bool bFixedTimeStep = false;
+    bool bReplaying = false;
+
+    /** Set when started from the command line, the process exits when the replay is over */
+    bool bExitWhenDone = false;
+};
@@ -0,0 +1,209 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherLagCompensationSubsystem.h"
+
+#include "Dasher.h"
+#include "Characters/DasherCharacter.h"
+
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Lag Compensation Record"), STAT_DasherLagCompensationRecord, STATGROUP_Dasher);
+DECLARE_CYCLE_STAT(TEXT("Lag Compensation Rewind"), STAT_DasherLagCompensationRewind, STATGROUP_Dasher);
+DECLARE_MEMORY_STAT(TEXT("Lag Compensation History"), STAT_DasherLagCompensationMemory, STATGROUP_Dasher);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Lag Compensation Bytes Per Character"), STAT_DasherLagCompensationBytesPerCharacter, STATGROUP_Dasher);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Lag Compensated Characters"), STAT_DasherLagCompensatedCharacters, STATGROUP_Dasher);
+
+void UDasherLagCompensationSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    HistoryLength = FMath::Max(HistoryLength, 2);
+    MaxCharacters = FMath::Max(MaxCharacters, 1);
+
+    // Everything is allocated up front, recording never allocates
+    SlotCharacters.SetNum(MaxCharacters);
+    Samples.SetNum(HistoryLength * MaxCharacters);
+    FrameTimes.SetNumZeroed(HistoryLength);
+
+    SET_MEMORY_STAT(STAT_DasherLagCompensationMemory, SlotCharacters.GetAllocatedSize() + Samples.GetAllocatedSize() + FrameTimes.GetAllocatedSize());
+    SET_DWORD_STAT(STAT_DasherLagCompensationBytesPerCharacter, HistoryLength * sizeof(FDasherHitboxSample));
+}
+
+void UDasherLagCompensationSubsystem::RegisterCharacter(ADasherCharacter* Character)
+{
+    if (SlotCharacters.Contains(Character))
+    {
+        return;
+    }
+
+    const int32 Slot = SlotCharacters.IndexOfByPredicate([](const TWeakObjectPtr<ADasherCharacter>& SlotCharacter) { return !SlotCharacter.IsValid(); });
+    if (Slot == INDEX_NONE)
+    {
+        UE_LOG(LogDasher, Warning, TEXT("Lag compensation is full (%d characters), %s won't be rewound"), MaxCharacters, *GetNameSafe(Character));
+        return;
+    }
+
+    // Whatever the previous owner left in the slot must not be rewound onto the new one
+    for (int32 Frame = 0; Frame < HistoryLength; ++Frame)
+    {
+        Samples[Frame * MaxCharacters + Slot] = FDasherHitboxSample();
+    }
+    SlotCharacters[Slot] = Character;
+}
+
+void UDasherLagCompensationSubsystem::UnregisterCharacter(ADasherCharacter* Character)
+{
+    const int32 Slot = SlotCharacters.IndexOfByKey(Character);
+    if (Slot != INDEX_NONE)
+    {
+        SlotCharacters[Slot] = nullptr;
+    }
+}
+
+void UDasherLagCompensationSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    // Only the server validates hits
+    if (GetWorld()->GetNetMode() != NM_Client)
+    {
+        RecordFrame();
+    }
+}
+
+TStatId UDasherLagCompensationSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UDasherLagCompensationSubsystem, STATGROUP_Tickables);
+}
+
+bool UDasherLagCompensationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDasherLagCompensationSubsystem::RecordFrame()
+{
+    SCOPE_CYCLE_COUNTER(STAT_DasherLagCompensationRecord);
+
+    const int32 Frame = NextFrame;
+    FrameTimes[Frame] = GetWorld()->GetTimeSeconds();
+
+    int32 NumCharacters = 0;
+    FDasherHitboxSample* FrameSamples = &Samples[Frame * MaxCharacters];
+    for (int32 Slot = 0; Slot < MaxCharacters; ++Slot)
+    {
+        const ADasherCharacter* Character = SlotCharacters[Slot].Get();
+        const UCapsuleComponent* Capsule = Character != nullptr ? Character->GetCapsuleComponent() : nullptr;
+        if (Capsule == nullptr)
+        {
+            FrameSamples[Slot] = FDasherHitboxSample();
+            continue;
+        }
+
+        FDasherHitboxSample& Sample = FrameSamples[Slot];
+        Sample.Location = FVector3f(Capsule->GetComponentLocation());
+        Sample.Radius = Capsule->GetScaledCapsuleRadius();
+        Sample.HalfHeight = Capsule->GetScaledCapsuleHalfHeight();
+        ++NumCharacters;
+    }
+
+    NextFrame = (NextFrame + 1) % HistoryLength;
+    NumFrames = FMath::Min(NumFrames + 1, HistoryLength);
+
+    SET_DWORD_STAT(STAT_DasherLagCompensatedCharacters, NumCharacters);
+}
+
+FDasherHitboxSample UDasherLagCompensationSubsystem::SampleAt(int32 Slot, int32 OlderFrame, int32 NewerFrame, float Alpha) const
+{
+    const FDasherHitboxSample& Older = GetSample(OlderFrame, Slot);
+    const FDasherHitboxSample& Newer = GetSample(NewerFrame, Slot);
+    if (!Older.IsValid())
+    {
+        return Newer;
+    }
+    if (!Newer.IsValid())
+    {
+        return Older;
+    }
+
+    FDasherHitboxSample Result;
+    Result.Location = FMath::Lerp(Older.Location, Newer.Location, Alpha);
+    Result.Radius = FMath::Lerp(Older.Radius, Newer.Radius, Alpha);
+    Result.HalfHeight = FMath::Lerp(Older.HalfHeight, Newer.HalfHeight, Alpha);
+    return Result;
+}
+
+bool UDasherLagCompensationSubsystem::RewindLineTrace(double Timestamp, const FVector& Start, const FVector& End, const ADasherCharacter* IgnoreCharacter, FDasherRewindHit& OutHit) const
+{
+    SCOPE_CYCLE_COUNTER(STAT_DasherLagCompensationRewind);
+
+    if (NumFrames == 0)
+    {
+        return false;
+    }
+
+    // Frames from oldest to newest are at Oldest, Oldest + 1, ... in the ring
+    const int32 Oldest = (NextFrame - NumFrames + HistoryLength) % HistoryLength;
+    const int32 Newest = (NextFrame - 1 + HistoryLength) % HistoryLength;
+    const double Time = FMath::Clamp(Timestamp, FMath::Max(FrameTimes[Oldest], FrameTimes[Newest] - MaxRewindTime), FrameTimes[Newest]);
+
+    // Binary search for the last frame recorded at or before the rewind time
+    int32 Low = 0;
+    int32 High = NumFrames - 1;
+    while (Low < High)
+    {
+        const int32 Mid = (Low + High + 1) / 2;
+        if (FrameTimes[(Oldest + Mid) % HistoryLength] <= Time)
+        {
+            Low = Mid;
+        }
+        else
+        {
+            High = Mid - 1;
+        }
+    }
+    const int32 OlderFrame = (Oldest + Low) % HistoryLength;
+    const int32 NewerFrame = (Oldest + FMath::Min(Low + 1, NumFrames - 1)) % HistoryLength;
+    const double FrameSpan = FrameTimes[NewerFrame] - FrameTimes[OlderFrame];
+    const float Alpha = FrameSpan > 0.0 ? float((Time - FrameTimes[OlderFrame]) / FrameSpan) : 0.f;
+
+    bool bHit = false;
+    OutHit.Distance = TNumericLimits<float>::Max();
+    for (int32 Slot = 0; Slot < MaxCharacters; ++Slot)
+    {
+        ADasherCharacter* Character = SlotCharacters[Slot].Get();
+        if (Character == nullptr || Character == IgnoreCharacter)
+        {
+            continue;
+        }
+
+        const FDasherHitboxSample Sample = SampleAt(Slot, OlderFrame, NewerFrame, Alpha);
+        if (!Sample.IsValid())
+        {
+            continue;
+        }
+
+        // A capsule is every point within Radius of its axis segment
+        const FVector Center(Sample.Location);
+        const FVector AxisOffset(0.f, 0.f, FMath::Max(Sample.HalfHeight - Sample.Radius, 0.f));
+        FVector PointOnTrace;
+        FVector PointOnAxis;
+        FMath::SegmentDistToSegmentSafe(Start, End, Center - AxisOffset, Center + AxisOffset, PointOnTrace, PointOnAxis);
+        if (FVector::DistSquared(PointOnTrace, PointOnAxis) > FMath::Square(Sample.Radius))
+        {
+            continue;
+        }
+
+        const float Distance = FVector::Dist(Start, PointOnTrace);
+        if (Distance < OutHit.Distance)
+        {
+            OutHit.Character = Character;
+            OutHit.Location = PointOnTrace;
+            OutHit.Distance = Distance;
+            bHit = true;
+        }
+    }
+
+    return bHit;
+}
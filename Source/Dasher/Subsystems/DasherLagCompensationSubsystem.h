@@ -0,0 +1,101 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DasherLagCompensationSubsystem.generated.h"
+
+class ADasherCharacter;
+
+/** Capsule of one character in one recorded frame. Characters stay upright, so no rotation is kept */
+struct FDasherHitboxSample
+{
+    FVector3f Location = FVector3f::ZeroVector;
+    float Radius = 0.f;
+    float HalfHeight = 0.f;
+
+    bool IsValid() const { return Radius > 0.f; }
+};
+
+/** Result of a trace against rewound hitboxes */
+struct FDasherRewindHit
+{
+    ADasherCharacter* Character = nullptr;
+    FVector Location = FVector::ZeroVector;
+    float Distance = 0.f;
+};
+
+/**
+ * Records every character's capsule each server frame into a fixed-size ring buffer,
+ * so hits can be validated against where the firing client saw its targets.
+ * Samples are stored frame by frame, one slot per registered character.
+ */
+UCLASS(config=Game)
+class DASHER_API UDasherLagCompensationSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Starts recording the character's hitbox */
+    void RegisterCharacter(ADasherCharacter* Character);
+
+    /** Stops recording the character's hitbox */
+    void UnregisterCharacter(ADasherCharacter* Character);
+
+    /**
+     * Traces a segment against the character hitboxes as they were at the given server time, clamped to the recorded history.
+     * Returns the closest hit, ignoring IgnoreCharacter.
+     */
+    bool RewindLineTrace(double Timestamp, const FVector& Start, const FVector& End, const ADasherCharacter* IgnoreCharacter, FDasherRewindHit& OutHit) const;
+
+    // USubsystem interface
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    // End of USubsystem interface
+
+    // UTickableWorldSubsystem interface
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    // End of UTickableWorldSubsystem interface
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    /** Number of server frames kept per character */
+    UPROPERTY(Config)
+    int32 HistoryLength = 64;
+
+    /** Most characters recorded at once */
+    UPROPERTY(Config)
+    int32 MaxCharacters = 128;
+
+    /** Furthest back in time a hit can be validated */
+    UPROPERTY(Config)
+    float MaxRewindTime = 0.4f;
+
+private:
+
+    void RecordFrame();
+
+    /** Returns the hitbox of a slot at the given time, interpolated between the recorded frames around it */
+    FDasherHitboxSample SampleAt(int32 Slot, int32 OlderFrame, int32 NewerFrame, float Alpha) const;
+
+    const FDasherHitboxSample& GetSample(int32 Frame, int32 Slot) const { return Samples[Frame * MaxCharacters + Slot]; }
+
+    /** Characters owning each slot */
+    TArray<TWeakObjectPtr<ADasherCharacter>> SlotCharacters;
+
+    /** Hitboxes, HistoryLength frames of MaxCharacters slots each */
+    TArray<FDasherHitboxSample> Samples;
+
+    /** Server time of each recorded frame */
+    TArray<double> FrameTimes;
+
+    /** Frame the next recording goes into */
+    int32 NextFrame = 0;
+
+    /** Frames recorded so far, up to HistoryLength */
+    int32 NumFrames = 0;
+};
@@ -0,0 +1,328 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherLoadTestSubsystem.h"
+
+#include "Dasher.h"
+#include "Characters/DasherCharacter.h"
+#include "Components/TP_PickUpComponent.h"
+#include "Core/DasherBotController.h"
+
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "TimerManager.h"
+
+static FAutoConsoleCommandWithWorldAndArgs LoadTestStartCommand(
+    TEXT("dasher.LoadTest.Start"),
+    TEXT("Spawns bots on the server and records frame time, bandwidth and spawns to a CSV. Usage: dasher.LoadTest.Start [Bots=16] [Seconds=0, until stopped] [RandomWalk|Waypoints]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+    {
+        UDasherLoadTestSubsystem* LoadTest = World != nullptr ? World->GetSubsystem<UDasherLoadTestSubsystem>() : nullptr;
+        if (LoadTest == nullptr || World->GetNetMode() == NM_Client)
+        {
+            return;
+        }
+
+        const int32 NumBots = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 16;
+        const float Seconds = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 0.f;
+        LoadTest->StartLoadTest(NumBots, Seconds, FString(), Args.Num() > 2 ? Args[2] : FString());
+    }));
+
+static FAutoConsoleCommandWithWorld LoadTestStopCommand(
+    TEXT("dasher.LoadTest.Stop"),
+    TEXT("Stops the running load test, writes its CSV and removes the bots."),
+    FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+    {
+        if (UDasherLoadTestSubsystem* LoadTest = World != nullptr ? World->GetSubsystem<UDasherLoadTestSubsystem>() : nullptr)
+        {
+            LoadTest->StopLoadTest();
+        }
+    }));
+
+void UDasherLoadTestSubsystem::Deinitialize()
+{
+    // The world is going away, keep what was recorded but leave its actors alone
+    if (bRunning)
+    {
+        bRunning = false;
+        SaveCsv();
+    }
+
+    Super::Deinitialize();
+}
+
+void UDasherLoadTestSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    if (InWorld.GetNetMode() == NM_Client)
+    {
+        return;
+    }
+
+    // Swarm clients and other test players get a weapon as soon as they spawn, so they can fire without finding one
+    if (FParse::Param(FCommandLine::Get(), TEXT("DasherGrantWeapons")))
+    {
+        InWorld.AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UDasherLoadTestSubsystem::OnCharacterSpawned));
+    }
+
+    int32 NumBots = 0;
+    if (!FParse::Value(FCommandLine::Get(), TEXT("DasherBots="), NumBots))
+    {
+        return;
+    }
+
+    float Seconds = 0.f;
+    FString Csv;
+    FString PatternName;
+    FParse::Value(FCommandLine::Get(), TEXT("DasherLoadTestDuration="), Seconds);
+    FParse::Value(FCommandLine::Get(), TEXT("DasherLoadTestCsv="), Csv);
+    FParse::Value(FCommandLine::Get(), TEXT("DasherBotPattern="), PatternName);
+
+    bExitWhenDone = !GIsEditor && Seconds > 0.f;
+    StartLoadTest(NumBots, Seconds, Csv, PatternName);
+}
+
+void UDasherLoadTestSubsystem::StartLoadTest(int32 NumBots, float InDuration, const FString& CsvPath, const FString& PatternName)
+{
+    if (bRunning)
+    {
+        UE_LOG(LogDasher, Warning, TEXT("Load test is already running"));
+        return;
+    }
+
+    UWorld* World = GetWorld();
+    if (World->GetAuthGameMode() == nullptr)
+    {
+        UE_LOG(LogDasher, Warning, TEXT("Load test needs a game mode, it can only run on the server"));
+        return;
+    }
+
+    bRunning = true;
+    Duration = InDuration;
+    CsvFilename = !CsvPath.IsEmpty() ? CsvPath : FPaths::ProfilingDir() / TEXT("LoadTest") / FString::Printf(TEXT("LoadTest-%s.csv"), *FDateTime::Now().ToString());
+
+    CsvLines.Reset();
+    CsvLines.Add(TEXT("Seconds,FrameMs,MaxFrameMs,InBytesPerSecond,OutBytesPerSecond,Connections,Bots,Spawned,TotalSpawned"));
+
+    StartTime = World->GetRealTimeSeconds();
+    SampleStartTime = StartTime;
+    FrameTimeSum = 0.0;
+    FrameTimeMax = 0.0;
+    NumFrames = 0;
+    NumSpawned = 0;
+    TotalSpawned = 0;
+
+    // Counted after the bots are in, so only what they cause shows up
+    for (int32 Index = 0; Index < NumBots; ++Index)
+    {
+        SpawnBot(Index, PatternName);
+    }
+    ActorSpawnedHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UDasherLoadTestSubsystem::OnActorSpawned));
+
+    UE_LOG(LogDasher, Log, TEXT("Load test started: %d bots, %s, recording to %s"), Bots.Num(),
+        Duration > 0.f ? *FString::Printf(TEXT("%.0f seconds"), Duration) : TEXT("until stopped"), *CsvFilename);
+}
+
+void UDasherLoadTestSubsystem::StopLoadTest()
+{
+    if (!bRunning)
+    {
+        return;
+    }
+    bRunning = false;
+
+    GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+    SaveCsv();
+
+    for (const TWeakObjectPtr<ADasherBotController>& Bot : Bots)
+    {
+        if (!Bot.IsValid())
+        {
+            continue;
+        }
+        if (APawn* Pawn = Bot->GetPawn())
+        {
+            // The weapon is attached to the character
+            TArray<AActor*> AttachedActors;
+            Pawn->GetAttachedActors(AttachedActors);
+            for (AActor* AttachedActor : AttachedActors)
+            {
+                AttachedActor->Destroy();
+            }
+            Pawn->Destroy();
+        }
+        Bot->Destroy();
+    }
+    Bots.Reset();
+
+    if (bExitWhenDone)
+    {
+        FPlatformMisc::RequestExit(false);
+    }
+}
+
+void UDasherLoadTestSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    if (!bRunning)
+    {
+        return;
+    }
+
+    // Time the frame spent working, not waiting for the server tick rate
+    const double FrameTime = FMath::Max(FApp::GetDeltaTime() - FApp::GetIdleTime(), 0.0) * 1000.0;
+    FrameTimeSum += FrameTime;
+    FrameTimeMax = FMath::Max(FrameTimeMax, FrameTime);
+    ++NumFrames;
+
+    const double Now = GetWorld()->GetRealTimeSeconds();
+    if (Now - SampleStartTime >= SampleInterval)
+    {
+        WriteSample(Now);
+    }
+
+    if (Duration > 0.f && Now - StartTime >= Duration)
+    {
+        StopLoadTest();
+    }
+}
+
+TStatId UDasherLoadTestSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UDasherLoadTestSubsystem, STATGROUP_Tickables);
+}
+
+bool UDasherLoadTestSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDasherLoadTestSubsystem::SpawnBot(int32 Index, const FString& PatternName)
+{
+    UWorld* World = GetWorld();
+
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+    SpawnParams.ObjectFlags |= RF_Transient;
+    ADasherBotController* Bot = World->SpawnActor<ADasherBotController>(SpawnParams);
+    if (Bot == nullptr)
+    {
+        return;
+    }
+
+    EDasherBotPattern Pattern = Index % 2 == 0 ? EDasherBotPattern::RandomWalk : EDasherBotPattern::Waypoints;
+    if (PatternName == TEXT("RandomWalk"))
+    {
+        Pattern = EDasherBotPattern::RandomWalk;
+    }
+    else if (PatternName == TEXT("Waypoints"))
+    {
+        Pattern = EDasherBotPattern::Waypoints;
+    }
+    Bot->InitializeBot(BotSeed + Index, Pattern);
+
+    // Spawned at a player start like any joining player
+    World->GetAuthGameMode()->RestartPlayer(Bot);
+    if (ADasherCharacter* Character = Cast<ADasherCharacter>(Bot->GetPawn()))
+    {
+        GrantWeapon(Character);
+    }
+
+    Bots.Add(Bot);
+}
+
+void UDasherLoadTestSubsystem::GrantWeapon(ADasherCharacter* Character)
+{
+    UClass* WeaponClass = BotWeaponClass.LoadSynchronous();
+    if (WeaponClass == nullptr)
+    {
+        return;
+    }
+
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+    AActor* Weapon = GetWorld()->SpawnActor<AActor>(WeaponClass, Character->GetActorTransform(), SpawnParams);
+    if (Weapon == nullptr)
+    {
+        return;
+    }
+
+    // Go through the pickup so the weapon's own pick up logic runs, then make sure the character holds it
+    if (UTP_PickUpComponent* PickUp = Weapon->FindComponentByClass<UTP_PickUpComponent>())
+    {
+        PickUp->PickUp(Character);
+    }
+    if (Character->GetActiveWeaponComponent() == nullptr)
+    {
+        Character->PickUp(Weapon);
+    }
+}
+
+void UDasherLoadTestSubsystem::OnCharacterSpawned(AActor* Actor)
+{
+    // The character isn't possessed yet, its weapon follows on the next tick
+    if (ADasherCharacter* Character = Cast<ADasherCharacter>(Actor))
+    {
+        GetWorld()->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateWeakLambda(Character, [this, Character]()
+        {
+            if (Character->GetActiveWeaponComponent() == nullptr)
+            {
+                GrantWeapon(Character);
+            }
+        }));
+    }
+}
+
+void UDasherLoadTestSubsystem::OnActorSpawned(AActor* Actor)
+{
+    ++NumSpawned;
+    ++TotalSpawned;
+}
+
+void UDasherLoadTestSubsystem::WriteSample(double Now)
+{
+    const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+
+    int32 NumBots = 0;
+    for (const TWeakObjectPtr<ADasherBotController>& Bot : Bots)
+    {
+        NumBots += Bot.IsValid() && Bot->GetPawn() != nullptr ? 1 : 0;
+    }
+
+    CsvLines.Add(FString::Printf(TEXT("%.2f,%.3f,%.3f,%u,%u,%d,%d,%d,%d"),
+        Now - StartTime,
+        NumFrames > 0 ? FrameTimeSum / NumFrames : 0.0,
+        FrameTimeMax,
+        NetDriver != nullptr ? NetDriver->InBytesPerSecond : 0u,
+        NetDriver != nullptr ? NetDriver->OutBytesPerSecond : 0u,
+        NetDriver != nullptr ? NetDriver->ClientConnections.Num() : 0,
+        NumBots,
+        NumSpawned,
+        TotalSpawned));
+
+    SampleStartTime = Now;
+    FrameTimeSum = 0.0;
+    FrameTimeMax = 0.0;
+    NumFrames = 0;
+    NumSpawned = 0;
+}
+
+void UDasherLoadTestSubsystem::SaveCsv()
+{
+    IFileManager::Get().MakeDirectory(*FPaths::GetPath(CsvFilename), true);
+    if (FFileHelper::SaveStringToFile(FString::Join(CsvLines, LINE_TERMINATOR) + LINE_TERMINATOR, *CsvFilename))
+    {
+        UE_LOG(LogDasher, Log, TEXT("Load test wrote %d samples to %s"), CsvLines.Num() - 1, *CsvFilename);
+    }
+    else
+    {
+        UE_LOG(LogDasher, Error, TEXT("Load test couldn't write %s"), *CsvFilename);
+    }
+}
@@ -0,0 +1,108 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DasherLoadTestSubsystem.generated.h"
+
+class ADasherBotController;
+class ADasherCharacter;
+
+/**
+ * Fills the server with bots and records how it copes to a CSV file, one row per sample interval.
+ * Starts on its own when the server is launched with -DasherBots=<Count>, for example on a headless Linux box:
+ *   UnrealEditor-Cmd Dasher.uproject FirstPersonMap -server -nullrhi -log -DasherBots=64 -DasherLoadTestDuration=300 -DasherLoadTestCsv=LoadTest.csv
+ * -DasherBotPattern=RandomWalk|Waypoints picks the bot pattern, bots alternate between both by default.
+ * The process exits once the duration is over, unless running in the editor. In a running game use dasher.LoadTest.Start and Stop.
+ * -DasherGrantWeapons gives every character that spawns on the server a weapon, e.g. for swarm clients.
+ */
+UCLASS(config=Game)
+class DASHER_API UDasherLoadTestSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Spawns the bots and starts recording. Records until stopped if Duration is zero, CsvPath defaults to the profiling directory */
+    void StartLoadTest(int32 NumBots, float Duration, const FString& CsvPath, const FString& PatternName = FString());
+
+    /** Writes the CSV and removes the bots */
+    void StopLoadTest();
+
+    bool IsRunning() const { return bRunning; }
+
+    const TArray<TWeakObjectPtr<ADasherBotController>>& GetBots() const { return Bots; }
+
+    // USubsystem interface
+    virtual void Deinitialize() override;
+    // End of USubsystem interface
+
+    // UWorldSubsystem interface
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    // End of UWorldSubsystem interface
+
+    // UTickableWorldSubsystem interface
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    // End of UTickableWorldSubsystem interface
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    /** Weapon every bot is given, so it has something to fire */
+    UPROPERTY(Config)
+    TSoftClassPtr<AActor> BotWeaponClass;
+
+    /** Seed of the first bot, each next bot adds one */
+    UPROPERTY(Config)
+    int32 BotSeed = 1337;
+
+    /** Seconds covered by each CSV row */
+    UPROPERTY(Config)
+    float SampleInterval = 1.f;
+
+private:
+
+    void SpawnBot(int32 Index, const FString& PatternName);
+
+    /** Hands the configured weapon to the bot's character the way a pickup would */
+    void GrantWeapon(ADasherCharacter* Character);
+
+    void OnActorSpawned(AActor* Actor);
+
+    /** Gives characters spawned by the game a weapon when running with -DasherGrantWeapons */
+    void OnCharacterSpawned(AActor* Actor);
+
+    /** Adds a CSV row for the current sample and starts the next one */
+    void WriteSample(double Now);
+
+    void SaveCsv();
+
+    TArray<TWeakObjectPtr<ADasherBotController>> Bots;
+
+    /** Header and rows recorded so far */
+    TArray<FString> CsvLines;
+
+    FString CsvFilename;
+
+    FDelegateHandle ActorSpawnedHandle;
+
+    double StartTime = 0.0;
+    double SampleStartTime = 0.0;
+    float Duration = 0.f;
+
+    /** Current sample */
+    double FrameTimeSum = 0.0;
+    double FrameTimeMax = 0.0;
+    int32 NumFrames = 0;
+    int32 NumSpawned = 0;
+
+    int32 TotalSpawned = 0;
+
+    bool bRunning = false;
+
+    /** Set when started from the command line, the process exits when the test is over */
+    bool bExitWhenDone = false;
+};
@@ -0,0 +1,369 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherPerfGateSubsystem.h"
+
+#include "Dasher.h"
+#include "Core/DasherBotController.h"
+#include "Subsystems/DasherLoadTestSubsystem.h"
+
+#include "CoreGlobals.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "HAL/PlatformMemory.h"
+#include "JsonObjectConverter.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+static FAutoConsoleCommandWithWorldAndArgs PerfGateRunCommand(
+    TEXT("dasher.PerfGate.Run"),
+    TEXT("Runs a benchmark scenario on the server and compares it against its baseline. Usage: dasher.PerfGate.Run <Scenario> [UpdateBaseline]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+    {
+        UDasherPerfGateSubsystem* PerfGate = World != nullptr ? World->GetSubsystem<UDasherPerfGateSubsystem>() : nullptr;
+        if (PerfGate != nullptr && Args.Num() > 0)
+        {
+            PerfGate->RunScenario(Args[0], Args.Num() > 1 && Args[1] == TEXT("UpdateBaseline"));
+        }
+    }));
+
+void UDasherPerfGateSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // Nothing has played yet, this is what starting up and loading the map cost
+    StartupSeconds = static_cast<float>(FPlatformTime::Seconds() - GStartTime);
+    StartupMemoryMB = FPlatformMemory::GetStats().UsedPhysical / (1024.f * 1024.f);
+
+    FString ScenarioName;
+    if (InWorld.GetNetMode() == NM_Client || !FParse::Value(FCommandLine::Get(), TEXT("DasherPerfGate="), ScenarioName))
+    {
+        return;
+    }
+
+    bExitWhenDone = !GIsEditor;
+    if (!RunScenario(ScenarioName, FParse::Param(FCommandLine::Get(), TEXT("DasherPerfGateUpdateBaseline"))) && bExitWhenDone)
+    {
+        FPlatformMisc::RequestExitWithStatus(false, 1);
+    }
+}
+
+bool UDasherPerfGateSubsystem::RunScenario(const FString& ScenarioName, bool bInUpdateBaseline)
+{
+    if (IsRunning())
+    {
+        UE_LOG(LogDasher, Warning, TEXT("Perf gate is already running %s"), *Scenario.Name);
+        return false;
+    }
+
+    const FDasherPerfScenario* Found = Scenarios.FindByPredicate([&ScenarioName](const FDasherPerfScenario& Candidate) { return Candidate.Name == ScenarioName; });
+    if (Found == nullptr)
+    {
+        UE_LOG(LogDasher, Error, TEXT("Perf gate has no scenario named %s"), *ScenarioName);
+        return false;
+    }
+
+    UDasherLoadTestSubsystem* LoadTest = GetLoadTest();
+    if (LoadTest == nullptr || LoadTest->IsRunning())
+    {
+        UE_LOG(LogDasher, Error, TEXT("Perf gate needs an idle load test to play %s"), *ScenarioName);
+        return false;
+    }
+
+    Scenario = *Found;
+    bUpdateBaseline = bInUpdateBaseline;
+
+    // Anything rolling FMath::Rand during the scenario rolls the same numbers every run
+    FMath::RandInit(0);
+    FMath::SRandInit(0);
+
+    IdleFrameMsP50 = 0.f;
+    IdleMemoryUsedMB = 0.f;
+    if (Scenario.IdleSeconds > 0.f)
+    {
+        Phase = EPhase::MeasuringIdle;
+        PhaseEndTime = GetWorld()->GetTimeSeconds() + Scenario.IdleSeconds;
+        FrameTimes.Reset();
+        FrameTimes.Reserve(FMath::CeilToInt(Scenario.IdleSeconds * 120.f));
+        UE_LOG(LogDasher, Log, TEXT("Perf gate started %s: measuring %.0f seconds without bots"), *Scenario.Name, Scenario.IdleSeconds);
+        return true;
+    }
+
+    return StartBots();
+}
+
+bool UDasherPerfGateSubsystem::StartBots()
+{
+    UDasherLoadTestSubsystem* LoadTest = GetLoadTest();
+    if (LoadTest == nullptr || LoadTest->IsRunning())
+    {
+        UE_LOG(LogDasher, Error, TEXT("Perf gate needs an idle load test to play %s"), *Scenario.Name);
+        Phase = EPhase::Idle;
+        return false;
+    }
+
+    LoadTest->StartLoadTest(Scenario.NumBots, 0.f, FPaths::ProfilingDir() / TEXT("PerfGate") / Scenario.Name + TEXT(".csv"), Scenario.BotPattern);
+    if (!LoadTest->IsRunning())
+    {
+        Phase = EPhase::Idle;
+        return false;
+    }
+    SpawnPickups(Scenario.NumPickups);
+    for (const TWeakObjectPtr<ADasherBotController>& Bot : LoadTest->GetBots())
+    {
+        if (Bot.IsValid())
+        {
+            Bot->SetChances(Scenario.SprintChance, Scenario.CrouchChance, Scenario.FireChance);
+        }
+    }
+
+    Phase = EPhase::WarmingUp;
+    PhaseEndTime = GetWorld()->GetTimeSeconds() + Scenario.WarmUpSeconds;
+
+    UE_LOG(LogDasher, Log, TEXT("Perf gate started %s: %d bots, %d pickups, %.0f seconds after %.0f seconds of warm up"),
+        *Scenario.Name, Scenario.NumBots, Scenario.NumPickups, Scenario.Seconds, Scenario.WarmUpSeconds);
+    return true;
+}
+
+void UDasherPerfGateSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    // Measured in real time, the world's delta time is fixed when running deterministic
+    const double Now = FPlatformTime::Seconds();
+    const double FrameTime = FMath::Max(Now - LastTickTime - FApp::GetIdleTime(), 0.0) * 1000.0;
+    LastTickTime = Now;
+
+    if (Phase == EPhase::Idle)
+    {
+        return;
+    }
+
+    UWorld* World = GetWorld();
+    const double WorldTime = World->GetTimeSeconds();
+
+    if (Phase == EPhase::MeasuringIdle)
+    {
+        FrameTimes.Add(static_cast<float>(FrameTime));
+        if (WorldTime >= PhaseEndTime)
+        {
+            if (FrameTimes.Num() > 0)
+            {
+                FrameTimes.Sort();
+                IdleFrameMsP50 = FrameTimes[FrameTimes.Num() / 2];
+            }
+            IdleMemoryUsedMB = FPlatformMemory::GetStats().UsedPhysical / (1024.f * 1024.f);
+
+            if (!StartBots() && bExitWhenDone)
+            {
+                FPlatformMisc::RequestExitWithStatus(false, 1);
+            }
+        }
+        return;
+    }
+
+    if (Phase == EPhase::WarmingUp)
+    {
+        if (WorldTime >= PhaseEndTime)
+        {
+            Phase = EPhase::Measuring;
+            PhaseEndTime = WorldTime + Scenario.Seconds;
+            NextBandwidthSampleTime = WorldTime + 1.0;
+
+            FrameTimes.Reset();
+            FrameTimes.Reserve(FMath::CeilToInt(Scenario.Seconds * 120.f));
+            InBytesSum = 0.0;
+            OutBytesSum = 0.0;
+            NumBandwidthSamples = 0;
+            MaxActors = 0;
+        }
+        return;
+    }
+
+    FrameTimes.Add(static_cast<float>(FrameTime));
+    MaxActors = FMath::Max(MaxActors, World->GetActorCount());
+
+    if (WorldTime >= NextBandwidthSampleTime)
+    {
+        NextBandwidthSampleTime += 1.0;
+        if (const UNetDriver* NetDriver = World->GetNetDriver())
+        {
+            InBytesSum += NetDriver->InBytesPerSecond;
+            OutBytesSum += NetDriver->OutBytesPerSecond;
+        }
+        ++NumBandwidthSamples;
+    }
+
+    if (WorldTime >= PhaseEndTime)
+    {
+        FinishScenario();
+    }
+}
+
+TStatId UDasherPerfGateSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UDasherPerfGateSubsystem, STATGROUP_Tickables);
+}
+
+bool UDasherPerfGateSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDasherPerfGateSubsystem::SpawnPickups(int32 NumPickups)
+{
+    UClass* Class = NumPickups > 0 ? PickupClass.LoadSynchronous() : nullptr;
+    if (Class == nullptr)
+    {
+        return;
+    }
+
+    // Square grid centered on the origin, filled row by row
+    const int32 Columns = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumPickups)));
+    const FVector Corner = PickupOrigin - FVector(Columns - 1, Columns - 1, 0.f) * (PickupSpacing * 0.5f);
+
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+    SpawnParams.ObjectFlags |= RF_Transient;
+    for (int32 Index = 0; Index < NumPickups; ++Index)
+    {
+        const FVector Location = Corner + FVector(Index % Columns, Index / Columns, 0.f) * PickupSpacing;
+        if (AActor* Pickup = GetWorld()->SpawnActor<AActor>(Class, Location, FRotator::ZeroRotator, SpawnParams))
+        {
+            Pickups.Add(Pickup);
+        }
+    }
+}
+
+void UDasherPerfGateSubsystem::FinishScenario()
+{
+    Phase = EPhase::Idle;
+
+    // Before the bots go away
+    const float MemoryUsedMB = FPlatformMemory::GetStats().UsedPhysical / (1024.f * 1024.f);
+
+    if (UDasherLoadTestSubsystem* LoadTest = GetLoadTest())
+    {
+        LoadTest->StopLoadTest();
+    }
+    for (const TWeakObjectPtr<AActor>& Pickup : Pickups)
+    {
+        if (Pickup.IsValid())
+        {
+            Pickup->Destroy();
+        }
+    }
+    Pickups.Reset();
+
+    FDasherPerfMetrics Metrics;
+    Metrics.NumFrames = FrameTimes.Num();
+    if (FrameTimes.Num() > 0)
+    {
+        FrameTimes.Sort();
+        const auto Percentile = [this](float Fraction) { return FrameTimes[FMath::Min(FMath::FloorToInt(FrameTimes.Num() * Fraction), FrameTimes.Num() - 1)]; };
+        Metrics.FrameMsP50 = Percentile(0.5f);
+        Metrics.FrameMsP90 = Percentile(0.9f);
+        Metrics.FrameMsP99 = Percentile(0.99f);
+        Metrics.FrameMsMax = FrameTimes.Last();
+    }
+    Metrics.MemoryPeakMB = FPlatformMemory::GetStats().PeakUsedPhysical / (1024.f * 1024.f);
+    Metrics.InKBPerSecond = NumBandwidthSamples > 0 ? static_cast<float>(InBytesSum / NumBandwidthSamples / 1024.0) : 0.f;
+    Metrics.OutKBPerSecond = NumBandwidthSamples > 0 ? static_cast<float>(OutBytesSum / NumBandwidthSamples / 1024.0) : 0.f;
+    Metrics.MaxActors = MaxActors;
+    Metrics.MemoryUsedMB = MemoryUsedMB;
+    // A scenario started from the console runs long after startup, its world may not be the one measured
+    if (bExitWhenDone)
+    {
+        Metrics.StartupSeconds = StartupSeconds;
+        Metrics.StartupMemoryMB = StartupMemoryMB;
+    }
+    if (Scenario.IdleSeconds > 0.f && Scenario.NumBots > 0)
+    {
+        Metrics.IdleFrameMsP50 = IdleFrameMsP50;
+        Metrics.IdleMemoryUsedMB = IdleMemoryUsedMB;
+        Metrics.FrameMsPerCharacter = (Metrics.FrameMsP50 - IdleFrameMsP50) / Scenario.NumBots;
+        Metrics.MemoryKBPerCharacter = (MemoryUsedMB - IdleMemoryUsedMB) * 1024.f / Scenario.NumBots;
+    }
+
+    FString Json;
+    FJsonObjectConverter::UStructToJsonObjectString(Metrics, Json);
+
+    // Kept next to the load test CSV, so a failed run can be looked at or promoted to the baseline by hand
+    FFileHelper::SaveStringToFile(Json, *(FPaths::ProfilingDir() / TEXT("PerfGate") / Scenario.Name + TEXT(".json")));
+
+    bool bPassed = true;
+    if (bUpdateBaseline)
+    {
+        bPassed = FFileHelper::SaveStringToFile(Json, *GetBaselineFilename());
+        UE_LOG(LogDasher, Log, TEXT("Perf gate %s the baseline of %s to %s"), bPassed ? TEXT("wrote") : TEXT("couldn't write"), *Scenario.Name, *GetBaselineFilename());
+    }
+    else
+    {
+        FString BaselineJson;
+        FDasherPerfMetrics Baseline;
+        if (FFileHelper::LoadFileToString(BaselineJson, *GetBaselineFilename()) && FJsonObjectConverter::JsonObjectStringToUStruct(BaselineJson, &Baseline))
+        {
+            bPassed = CompareToBaseline(Metrics, Baseline);
+        }
+        else
+        {
+            bPassed = false;
+            UE_LOG(LogDasher, Error, TEXT("Perf gate has no baseline for %s at %s, record one with -DasherPerfGateUpdateBaseline"), *Scenario.Name, *GetBaselineFilename());
+        }
+        UE_LOG(LogDasher, Display, TEXT("Perf gate %s %s"), *Scenario.Name, bPassed ? TEXT("passed") : TEXT("FAILED"));
+    }
+
+    if (bExitWhenDone)
+    {
+        FPlatformMisc::RequestExitWithStatus(false, bPassed ? 0 : 1);
+    }
+}
+
+bool UDasherPerfGateSubsystem::CompareToBaseline(const FDasherPerfMetrics& Metrics, const FDasherPerfMetrics& Baseline) const
+{
+    bool bPassed = true;
+    const auto Check = [&bPassed](const TCHAR* Name, float Value, float BaselineValue, float Tolerance, float Slack)
+    {
+        const float Limit = BaselineValue * (1.f + Tolerance) + Slack;
+        const bool bRegressed = Value > Limit;
+        UE_LOG(LogDasher, Display, TEXT("  %-16s %10.3f  baseline %10.3f  limit %10.3f%s"), Name, Value, BaselineValue, Limit, bRegressed ? TEXT("  REGRESSED") : TEXT(""));
+        bPassed &= !bRegressed;
+    };
+
+    Check(TEXT("FrameMsP50"), Metrics.FrameMsP50, Baseline.FrameMsP50, FrameTimeTolerance, FrameTimeSlackMs);
+    Check(TEXT("FrameMsP90"), Metrics.FrameMsP90, Baseline.FrameMsP90, FrameTimeTolerance, FrameTimeSlackMs);
+    Check(TEXT("FrameMsP99"), Metrics.FrameMsP99, Baseline.FrameMsP99, FrameTimeTolerance, FrameTimeSlackMs);
+    Check(TEXT("MemoryPeakMB"), Metrics.MemoryPeakMB, Baseline.MemoryPeakMB, MemoryTolerance, 0.f);
+    Check(TEXT("InKBPerSecond"), Metrics.InKBPerSecond, Baseline.InKBPerSecond, BandwidthTolerance, 0.f);
+    Check(TEXT("OutKBPerSecond"), Metrics.OutKBPerSecond, Baseline.OutKBPerSecond, BandwidthTolerance, 0.f);
+    Check(TEXT("MaxActors"), Metrics.MaxActors, Baseline.MaxActors, ActorCountTolerance, 0.f);
+    // Baselines recorded before startup was measured don't have it
+    if (Baseline.StartupMemoryMB > 0.f)
+    {
+        Check(TEXT("StartupMemoryMB"), Metrics.StartupMemoryMB, Baseline.StartupMemoryMB, MemoryTolerance, 0.f);
+    }
+
+    // A single spike is too noisy to gate on, it is logged for reference only, and so is startup time, which mostly
+    // depends on how warm the disk cache is
+    UE_LOG(LogDasher, Display, TEXT("  %-16s %10.3f  baseline %10.3f"), TEXT("FrameMsMax"), Metrics.FrameMsMax, Baseline.FrameMsMax);
+    UE_LOG(LogDasher, Display, TEXT("  %-16s %10.3f  baseline %10.3f"), TEXT("StartupSeconds"), Metrics.StartupSeconds, Baseline.StartupSeconds);
+
+    // Differences of two noisy measurements, so they get the slack of both spread over the characters
+    if (Scenario.IdleSeconds > 0.f && Scenario.NumBots > 0)
+    {
+        Check(TEXT("FrameMs/Char"), Metrics.FrameMsPerCharacter, Baseline.FrameMsPerCharacter, PerCharacterTolerance, 2.f * FrameTimeSlackMs / Scenario.NumBots);
+        Check(TEXT("MemoryKB/Char"), Metrics.MemoryKBPerCharacter, Baseline.MemoryKBPerCharacter, PerCharacterTolerance, PerCharacterMemorySlackKB);
+    }
+    return bPassed;
+}
+
+FString UDasherPerfGateSubsystem::GetBaselineFilename() const
+{
+    return FPaths::ProjectDir() / BaselineDirectory / Scenario.Name + TEXT(".json");
+}
+
+UDasherLoadTestSubsystem* UDasherPerfGateSubsystem::GetLoadTest() const
+{
+    return GetWorld()->GetSubsystem<UDasherLoadTestSubsystem>();
+}
@@ -0,0 +1,256 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DasherPerfGateSubsystem.generated.h"
+
+class UDasherLoadTestSubsystem;
+
+/** One deterministic benchmark, played by load test bots */
+USTRUCT()
+struct FDasherPerfScenario
+{
+    GENERATED_BODY()
+
+    /** Name passed to -DasherPerfGate, also names the baseline file */
+    UPROPERTY()
+    FString Name;
+
+    UPROPERTY()
+    int32 NumBots = 0;
+
+    /** RandomWalk or Waypoints, bots alternate between both if empty */
+    UPROPERTY()
+    FString BotPattern;
+
+    UPROPERTY()
+    float SprintChance = 0.3f;
+
+    UPROPERTY()
+    float CrouchChance = 0.1f;
+
+    UPROPERTY()
+    float FireChance = 0.5f;
+
+    /** Weapon pickups laid out in a grid before the bots start */
+    UPROPERTY()
+    int32 NumPickups = 0;
+
+    /** Seconds measured before the bots spawn, to work out what each character costs. Zero skips it */
+    UPROPERTY()
+    float IdleSeconds = 0.f;
+
+    /** Seconds played before measuring, so spawning and pool prewarming stay out of the numbers */
+    UPROPERTY()
+    float WarmUpSeconds = 5.f;
+
+    /** Seconds measured */
+    UPROPERTY()
+    float Seconds = 30.f;
+};
+
+/** What a scenario is measured and gated on, higher is worse for all of them */
+USTRUCT()
+struct FDasherPerfMetrics
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    float FrameMsP50 = 0.f;
+
+    UPROPERTY()
+    float FrameMsP90 = 0.f;
+
+    UPROPERTY()
+    float FrameMsP99 = 0.f;
+
+    UPROPERTY()
+    float FrameMsMax = 0.f;
+
+    /** Peak physical memory used by the process */
+    UPROPERTY()
+    float MemoryPeakMB = 0.f;
+
+    UPROPERTY()
+    float InKBPerSecond = 0.f;
+
+    UPROPERTY()
+    float OutKBPerSecond = 0.f;
+
+    /** Most actors alive in the world on any measured frame */
+    UPROPERTY()
+    int32 MaxActors = 0;
+
+    UPROPERTY()
+    int32 NumFrames = 0;
+
+    /** Memory used by the process at the end of the scenario, with the bots still in */
+    UPROPERTY()
+    float MemoryUsedMB = 0.f;
+
+    /** What each bot and its character add over the idle server, for scenarios with IdleSeconds */
+    UPROPERTY()
+    float IdleFrameMsP50 = 0.f;
+
+    UPROPERTY()
+    float IdleMemoryUsedMB = 0.f;
+
+    UPROPERTY()
+    float FrameMsPerCharacter = 0.f;
+
+    UPROPERTY()
+    float MemoryKBPerCharacter = 0.f;
+
+    /** Seconds from the process starting to the map beginning play, only measured when started from the command line */
+    UPROPERTY()
+    float StartupSeconds = 0.f;
+
+    /** Memory used by the process when the map began play, what loading the map and its assets took */
+    UPROPERTY()
+    float StartupMemoryMB = 0.f;
+};
+
+/**
+ * Runs a benchmark scenario, measures it and fails when it regressed against the checked-in baseline.
+ * Meant for CI, one scenario per process so the memory high-water mark belongs to that scenario:
+ *   UnrealEditor-Cmd Dasher.uproject FirstPersonMap -server -nullrhi -deterministic -DasherPerfGate=ContinuousFire
+ * The process exits with 0 when every metric is within tolerance of the baseline and 1 otherwise, or when there is no baseline.
+ * -DasherPerfGateUpdateBaseline writes the measured metrics as the new baseline instead, check it in after a deliberate change.
+ * -deterministic fixes the seed and time step, so every run makes the same decisions over the same frames.
+ * Bandwidth only counts once clients are connected, e.g. a swarm started next to the gate.
+ * Scenarios with IdleSeconds first measure the server without bots, and gate the frame time and memory each character
+ * adds as well. Run them on the DasherServer target to gate what servers pay:
+ *   DasherServer FirstPersonMap -nullrhi -deterministic -DasherPerfGate=ServerCharacters
+ */
+UCLASS(config=Game)
+class DASHER_API UDasherPerfGateSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Starts the named scenario, returns false if it isn't configured or the world can't run it */
+    bool RunScenario(const FString& ScenarioName, bool bInUpdateBaseline);
+
+    bool IsRunning() const { return Phase != EPhase::Idle; }
+
+    // UWorldSubsystem interface
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    // End of UWorldSubsystem interface
+
+    // UTickableWorldSubsystem interface
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    // End of UTickableWorldSubsystem interface
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    UPROPERTY(Config)
+    TArray<FDasherPerfScenario> Scenarios;
+
+    /** Where baselines are read from and written to, relative to the project directory */
+    UPROPERTY(Config)
+    FString BaselineDirectory = TEXT("Build/PerfBaselines");
+
+    /** Weapon laid out by scenarios with pickups */
+    UPROPERTY(Config)
+    TSoftClassPtr<AActor> PickupClass;
+
+    /** Center of the pickup grid, in world space */
+    UPROPERTY(Config)
+    FVector PickupOrigin = FVector(0.f, 0.f, 100.f);
+
+    /** Distance between neighbouring pickups */
+    UPROPERTY(Config)
+    float PickupSpacing = 150.f;
+
+    /** Allowed growth of frame times over the baseline, as a fraction */
+    UPROPERTY(Config)
+    float FrameTimeTolerance = 0.1f;
+
+    /** Allowed growth of frame times in milliseconds on top of the fraction, so tiny frames don't fail on noise */
+    UPROPERTY(Config)
+    float FrameTimeSlackMs = 0.5f;
+
+    /** Allowed growth of the memory high-water mark, as a fraction */
+    UPROPERTY(Config)
+    float MemoryTolerance = 0.05f;
+
+    /** Allowed growth of bandwidth, as a fraction */
+    UPROPERTY(Config)
+    float BandwidthTolerance = 0.1f;
+
+    /** Allowed growth of the actor count, as a fraction */
+    UPROPERTY(Config)
+    float ActorCountTolerance = 0.05f;
+
+    /** Allowed growth of what each character costs, as a fraction, for scenarios with IdleSeconds */
+    UPROPERTY(Config)
+    float PerCharacterTolerance = 0.2f;
+
+    /** Allowed growth of the memory each character costs in KB on top of the fraction, allocator noise shows up in it */
+    UPROPERTY(Config)
+    float PerCharacterMemorySlackKB = 16.f;
+
+private:
+
+    enum class EPhase : uint8
+    {
+        Idle,
+        MeasuringIdle,
+        WarmingUp,
+        Measuring
+    };
+
+    /** Spawns the bots and pickups and starts warming up, returns false if the load test couldn't start */
+    bool StartBots();
+
+    void SpawnPickups(int32 NumPickups);
+
+    /** Stops the bots, computes the metrics and gates or saves them */
+    void FinishScenario();
+
+    /** Compares against the baseline and logs every metric, returns whether all of them are within tolerance */
+    bool CompareToBaseline(const FDasherPerfMetrics& Metrics, const FDasherPerfMetrics& Baseline) const;
+
+    FString GetBaselineFilename() const;
+
+    UDasherLoadTestSubsystem* GetLoadTest() const;
+
+    FDasherPerfScenario Scenario;
+
+    EPhase Phase = EPhase::Idle;
+
+    TArray<TWeakObjectPtr<AActor>> Pickups;
+
+    /** Work time of every measured frame, in milliseconds */
+    TArray<float> FrameTimes;
+
+    double PhaseEndTime = 0.0;
+    double LastTickTime = 0.0;
+
+    /** Net driver bandwidth, sampled once a second while measuring */
+    double NextBandwidthSampleTime = 0.0;
+    double InBytesSum = 0.0;
+    double OutBytesSum = 0.0;
+    int32 NumBandwidthSamples = 0;
+
+    int32 MaxActors = 0;
+
+    /** Measured when the map began play */
+    float StartupSeconds = 0.f;
+    float StartupMemoryMB = 0.f;
+
+    /** Measured before the bots spawned */
+    float IdleFrameMsP50 = 0.f;
+    float IdleMemoryUsedMB = 0.f;
+
+    bool bUpdateBaseline = false;
+
+    /** Set when started from the command line, the process exits with the result */
+    bool bExitWhenDone = false;
+};
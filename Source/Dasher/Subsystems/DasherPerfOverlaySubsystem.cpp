@@ -0,0 +1,196 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherPerfOverlaySubsystem.h"
+
+#include "Dasher.h"
+#include "Subsystems/DasherProjectileManagerSubsystem.h"
+#include "Subsystems/DasherProjectilePoolSubsystem.h"
+
+#include "Debug/DebugDrawService.h"
+#include "Engine/Canvas.h"
+#include "Engine/Engine.h"
+#include "Engine/Font.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+
+static FAutoConsoleCommandWithWorld OverlayToggleCommand(
+    TEXT("dasher.Overlay"),
+    TEXT("Toggles the Dasher performance overlay, printed to the log where nothing is drawn."),
+    FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+    {
+        if (UDasherPerfOverlaySubsystem* Overlay = World != nullptr ? World->GetSubsystem<UDasherPerfOverlaySubsystem>() : nullptr)
+        {
+            Overlay->SetEnabled(!Overlay->IsEnabled());
+        }
+    }));
+
+void UDasherPerfOverlaySubsystem::SetEnabled(bool bInEnabled)
+{
+    if (bEnabled == bInEnabled)
+    {
+        return;
+    }
+    bEnabled = bInEnabled;
+
+    if (bEnabled)
+    {
+        FDasherPerfCounters::AddSentBytesReader();
+        LastCounters = FDasherPerfCounters::Get();
+        SampleStartTime = FPlatformTime::Seconds();
+        LastLogTime = SampleStartTime;
+        NumFrames = 0;
+        Lines.Reset();
+        Lines.Add(TEXT("Dasher: gathering..."));
+
+        if (FApp::CanEverRender())
+        {
+            DrawHandle = UDebugDrawService::Register(TEXT("Game"), FDebugDrawDelegate::CreateUObject(this, &UDasherPerfOverlaySubsystem::Draw));
+        }
+    }
+    else
+    {
+        FDasherPerfCounters::RemoveSentBytesReader();
+        if (DrawHandle.IsValid())
+        {
+            UDebugDrawService::Unregister(DrawHandle);
+            DrawHandle.Reset();
+        }
+    }
+}
+
+void UDasherPerfOverlaySubsystem::Deinitialize()
+{
+    SetEnabled(false);
+
+    Super::Deinitialize();
+}
+
+void UDasherPerfOverlaySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    if (FParse::Param(FCommandLine::Get(), TEXT("DasherOverlay")))
+    {
+        SetEnabled(true);
+    }
+}
+
+void UDasherPerfOverlaySubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    if (!bEnabled)
+    {
+        return;
+    }
+
+    ++NumFrames;
+
+    const double Now = FPlatformTime::Seconds();
+    if (Now - SampleStartTime < SampleInterval)
+    {
+        return;
+    }
+    UpdateLines(Now);
+
+    // Nothing is drawn on dedicated servers and with -nullrhi, ops read the log instead
+    if (!FApp::CanEverRender() && Now - LastLogTime >= LogInterval)
+    {
+        LastLogTime = Now;
+        for (const FString& Line : Lines)
+        {
+            UE_LOG(LogDasher, Display, TEXT("%s"), *Line);
+        }
+    }
+}
+
+TStatId UDasherPerfOverlaySubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UDasherPerfOverlaySubsystem, STATGROUP_Tickables);
+}
+
+bool UDasherPerfOverlaySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDasherPerfOverlaySubsystem::UpdateLines(double Now)
+{
+    const FDasherPerfCounters& Counters = FDasherPerfCounters::Get();
+    const double Seconds = Now - SampleStartTime;
+    const double MsPerCycle = FPlatformTime::GetSecondsPerCycle64() * 1000.0;
+    const int32 Frames = FMath::Max(NumFrames, 1);
+
+    Lines.Reset();
+    Lines.Add(FString::Printf(TEXT("Dasher %s, %.1f ms per frame"), GetWorld()->GetNetMode() == NM_Client ? TEXT("client") : TEXT("server"), Seconds * 1000.0 / Frames));
+    Lines.Add(FString::Printf(TEXT("  Projectile simulation  %.3f ms/frame"), (Counters.ProjectileSimulationCycles - LastCounters.ProjectileSimulationCycles) * MsPerCycle / Frames));
+    Lines.Add(FString::Printf(TEXT("  Pickup checks          %.3f ms/frame"), (Counters.PickupCheckCycles - LastCounters.PickupCheckCycles) * MsPerCycle / Frames));
+    Lines.Add(FString::Printf(TEXT("  Look RPCs              %.0f sent /s, %.0f received /s"), (Counters.LookRPCsSent - LastCounters.LookRPCsSent) / Seconds,
+        (Counters.LookRPCsReceived - LastCounters.LookRPCsReceived) / Seconds));
+    Lines.Add(FString::Printf(TEXT("  Move RPCs              %.0f sent /s, %.0f received /s"), (Counters.MoveRPCsSent - LastCounters.MoveRPCsSent) / Seconds,
+        (Counters.MoveRPCsReceived - LastCounters.MoveRPCsReceived) / Seconds));
+    Lines.Add(FString::Printf(TEXT("  Fire RPCs              %.0f sent /s, %.0f received /s, %.0f shots /s"), (Counters.FireRPCsSent - LastCounters.FireRPCsSent) / Seconds,
+        (Counters.FireRPCsReceived - LastCounters.FireRPCsReceived) / Seconds, (Counters.ServerShots - LastCounters.ServerShots) / Seconds));
+
+    // Shares of the predictions made over the sample, whatever is left flew on unmatched
+    const uint64 PredictedShots = Counters.PredictedShots - LastCounters.PredictedShots;
+    const double PredictedPercent = PredictedShots > 0 ? 100.0 / PredictedShots : 0.0;
+    Lines.Add(FString::Printf(TEXT("  Predicted shots        %.0f /s, %.0f%% matched, %.0f%% rejected"), PredictedShots / Seconds,
+        (Counters.PredictedShotsMatched - LastCounters.PredictedShotsMatched) * PredictedPercent,
+        (Counters.PredictedShotsRejected - LastCounters.PredictedShotsRejected) * PredictedPercent));
+
+    int32 NumPooled = 0;
+    int32 NumLive = 0;
+    if (const UDasherProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UDasherProjectilePoolSubsystem>())
+    {
+        ProjectilePool->GetProjectileCounts(NumPooled, NumLive);
+    }
+    const UDasherProjectileManagerSubsystem* ProjectileManager = GetWorld()->GetSubsystem<UDasherProjectileManagerSubsystem>();
+    Lines.Add(FString::Printf(TEXT("  Projectiles            %d pooled, %d live, %d batched"), NumPooled, NumLive, ProjectileManager != nullptr ? ProjectileManager->GetNumProjectiles() : 0));
+
+    // Busiest classes over the sample
+    TArray<TPair<const UClass*, uint64>> SentBytes;
+    for (const TPair<TObjectKey<UClass>, uint64>& Pair : Counters.SentBytesByClass)
+    {
+        const uint64* LastBytes = LastCounters.SentBytesByClass.Find(Pair.Key);
+        const uint64 Bytes = Pair.Value - (LastBytes != nullptr ? *LastBytes : 0);
+        const UClass* Class = Pair.Key.ResolveObjectPtr();
+        if (Bytes > 0 && Class != nullptr)
+        {
+            SentBytes.Emplace(Class, Bytes);
+        }
+    }
+    SentBytes.Sort([](const TPair<const UClass*, uint64>& A, const TPair<const UClass*, uint64>& B) { return A.Value > B.Value; });
+
+    Lines.Add(TEXT("  Sent by actor class"));
+    for (int32 Index = 0; Index < FMath::Min(SentBytes.Num(), MaxClasses); ++Index)
+    {
+        Lines.Add(FString::Printf(TEXT("    %-28s %.1f KB/s"), *SentBytes[Index].Key->GetName(), SentBytes[Index].Value / 1024.0 / Seconds));
+    }
+
+    LastCounters = Counters;
+    SampleStartTime = Now;
+    NumFrames = 0;
+}
+
+void UDasherPerfOverlaySubsystem::Draw(UCanvas* Canvas, APlayerController* PlayerController)
+{
+    // Every world's overlay is registered with the same service, each draws for its own players
+    if (PlayerController == nullptr || PlayerController->GetWorld() != GetWorld())
+    {
+        return;
+    }
+
+    UFont* Font = GEngine->GetSmallFont();
+    const float LineHeight = Font->GetMaxCharHeight() + 2.f;
+    float Y = Canvas->ClipY * 0.2f;
+
+    Canvas->SetDrawColor(FColor::Yellow);
+    for (const FString& Line : Lines)
+    {
+        Canvas->DrawText(Font, Line, 20.f, Y);
+        Y += LineHeight;
+    }
+}
@@ -0,0 +1,81 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Core/DasherPerfCounters.h"
+#include "DasherPerfOverlaySubsystem.generated.h"
+
+class APlayerController;
+class UCanvas;
+
+/**
+ * Live overlay of what the Dasher systems cost, for triaging a bad server without a profiler.
+ * Shows projectile simulation and pickup check time, look, move and fire RPCs sent and received, sent bytes per actor class and pooled
+ * versus live projectiles, averaged over the last sample interval.
+ * Toggle with dasher.Overlay. Drawn over the player's view where there is one, including listen servers,
+ * printed to the log every LogInterval on dedicated servers and with -nullrhi. -DasherOverlay turns it on at start.
+ */
+UCLASS(config=Game)
+class DASHER_API UDasherPerfOverlaySubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    void SetEnabled(bool bInEnabled);
+
+    bool IsEnabled() const { return bEnabled; }
+
+    // USubsystem interface
+    virtual void Deinitialize() override;
+    // End of USubsystem interface
+
+    // UWorldSubsystem interface
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    // End of UWorldSubsystem interface
+
+    // UTickableWorldSubsystem interface
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    // End of UTickableWorldSubsystem interface
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    /** Seconds averaged over for each update of the overlay */
+    UPROPERTY(Config)
+    float SampleInterval = 1.f;
+
+    /** Seconds between prints to the log where nothing is drawn */
+    UPROPERTY(Config)
+    float LogInterval = 5.f;
+
+    /** Actor classes listed by sent bytes, the busiest first */
+    UPROPERTY(Config)
+    int32 MaxClasses = 8;
+
+private:
+
+    /** Turns the counters gathered since the last sample into the overlay lines */
+    void UpdateLines(double Now);
+
+    void Draw(UCanvas* Canvas, APlayerController* PlayerController);
+
+    /** Counters when the current sample started */
+    FDasherPerfCounters LastCounters;
+
+    /** Lines shown by the overlay */
+    TArray<FString> Lines;
+
+    FDelegateHandle DrawHandle;
+
+    double SampleStartTime = 0.0;
+    int32 NumFrames = 0;
+
+    double LastLogTime = 0.0;
+
+    bool bEnabled = false;
+};
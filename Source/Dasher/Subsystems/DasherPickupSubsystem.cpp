@@ -0,0 +1,171 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherPickupSubsystem.h"
+
+#include "Dasher.h"
+#include "Characters/DasherCharacter.h"
+#include "Components/TP_PickUpComponent.h"
+#include "Core/DasherPerfCounters.h"
+
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pickup Check"), STAT_DasherPickupCheck, STATGROUP_Dasher);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Registered Pickups"), STAT_DasherRegisteredPickups, STATGROUP_Dasher);
+
+void UDasherPickupSubsystem::RegisterPickup(UTP_PickUpComponent* Pickup)
+{
+    if (Pickup == nullptr || PickupCells.Contains(Pickup))
+    {
+        return;
+    }
+
+    const FIntRect PickupRect = GetCells(Pickup->GetComponentLocation(), Pickup->GetScaledSphereRadius());
+    for (int32 Y = PickupRect.Min.Y; Y <= PickupRect.Max.Y; ++Y)
+    {
+        for (int32 X = PickupRect.Min.X; X <= PickupRect.Max.X; ++X)
+        {
+            Cells.FindOrAdd(FIntPoint(X, Y)).Add(Pickup);
+        }
+    }
+    PickupCells.Add(Pickup, PickupRect);
+
+    SET_DWORD_STAT(STAT_DasherRegisteredPickups, PickupCells.Num());
+}
+
+void UDasherPickupSubsystem::UnregisterPickup(UTP_PickUpComponent* Pickup)
+{
+    FIntRect PickupRect;
+    if (!PickupCells.RemoveAndCopyValue(Pickup, PickupRect))
+    {
+        return;
+    }
+
+    for (int32 Y = PickupRect.Min.Y; Y <= PickupRect.Max.Y; ++Y)
+    {
+        for (int32 X = PickupRect.Min.X; X <= PickupRect.Max.X; ++X)
+        {
+            const FIntPoint Cell(X, Y);
+            if (TArray<TWeakObjectPtr<UTP_PickUpComponent>>* CellPickups = Cells.Find(Cell))
+            {
+                CellPickups->RemoveSingleSwap(Pickup);
+                if (CellPickups->IsEmpty())
+                {
+                    Cells.Remove(Cell);
+                }
+            }
+        }
+    }
+
+    SET_DWORD_STAT(STAT_DasherRegisteredPickups, PickupCells.Num());
+}
+
+void UDasherPickupSubsystem::RegisterCharacter(ADasherCharacter* Character)
+{
+    Characters.AddUnique(Character);
+}
+
+void UDasherPickupSubsystem::UnregisterCharacter(ADasherCharacter* Character)
+{
+    Characters.RemoveSingleSwap(Character);
+}
+
+void UDasherPickupSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    TimeUntilCheck -= DeltaTime;
+    if (TimeUntilCheck > 0.f)
+    {
+        return;
+    }
+    // Don't build up a backlog of checks after a hitch
+    TimeUntilCheck = CheckRate > 0.f ? FMath::Max(TimeUntilCheck + 1.f / CheckRate, 0.f) : 0.f;
+
+    if (!PickupCells.IsEmpty())
+    {
+        CheckPickups();
+    }
+}
+
+TStatId UDasherPickupSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UDasherPickupSubsystem, STATGROUP_Tickables);
+}
+
+bool UDasherPickupSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDasherPickupSubsystem::CheckPickups()
+{
+    SCOPE_CYCLE_COUNTER(STAT_DasherPickupCheck);
+    FDasherScopedCycleCounter CheckCycles(FDasherPerfCounters::Get().PickupCheckCycles);
+
+    PendingPickUps.Reset();
+
+    for (int32 Index = Characters.Num() - 1; Index >= 0; --Index)
+    {
+        ADasherCharacter* Character = Characters[Index].Get();
+        if (Character == nullptr)
+        {
+            Characters.RemoveAtSwap(Index);
+            continue;
+        }
+
+        // Test the pickup spheres against the capsule's segment, the same shapes the overlap used to
+        const UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+        const FVector Location = Capsule->GetComponentLocation();
+        const float Radius = Capsule->GetScaledCapsuleRadius();
+        const FVector Axis(0.f, 0.f, Capsule->GetScaledCapsuleHalfHeight_WithoutHemisphere());
+
+        const FIntRect CharacterRect = GetCells(Location, Radius);
+        for (int32 Y = CharacterRect.Min.Y; Y <= CharacterRect.Max.Y; ++Y)
+        {
+            for (int32 X = CharacterRect.Min.X; X <= CharacterRect.Max.X; ++X)
+            {
+                const TArray<TWeakObjectPtr<UTP_PickUpComponent>>* CellPickups = Cells.Find(FIntPoint(X, Y));
+                if (CellPickups == nullptr)
+                {
+                    continue;
+                }
+
+                for (const TWeakObjectPtr<UTP_PickUpComponent>& Pickup : *CellPickups)
+                {
+                    if (!Pickup.IsValid())
+                    {
+                        continue;
+                    }
+
+                    const float Reach = Pickup->GetScaledSphereRadius() + Radius;
+                    if (FMath::PointDistToSegmentSquared(Pickup->GetComponentLocation(), Location - Axis, Location + Axis) <= FMath::Square(Reach))
+                    {
+                        PendingPickUps.AddUnique({ Pickup, Character });
+                    }
+                }
+            }
+        }
+    }
+
+    // First character to reach a pickup gets it
+    for (const TPair<TWeakObjectPtr<UTP_PickUpComponent>, TWeakObjectPtr<ADasherCharacter>>& PickUp : PendingPickUps)
+    {
+        UTP_PickUpComponent* Pickup = PickUp.Key.Get();
+        ADasherCharacter* Character = PickUp.Value.Get();
+        if (Pickup != nullptr && Character != nullptr && PickupCells.Contains(Pickup))
+        {
+            UnregisterPickup(Pickup);
+            Pickup->PickUp(Character);
+        }
+    }
+    PendingPickUps.Reset();
+}
+
+FIntRect UDasherPickupSubsystem::GetCells(const FVector& Location, float Radius) const
+{
+    const double InvCellSize = 1.0 / FMath::Max(CellSize, 1.f);
+    return FIntRect(
+        FMath::FloorToInt32((Location.X - Radius) * InvCellSize), FMath::FloorToInt32((Location.Y - Radius) * InvCellSize),
+        FMath::FloorToInt32((Location.X + Radius) * InvCellSize), FMath::FloorToInt32((Location.Y + Radius) * InvCellSize));
+}
@@ -0,0 +1,75 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DasherPickupSubsystem.generated.h"
+
+class ADasherCharacter;
+class UTP_PickUpComponent;
+
+/**
+ * Finds characters touching pickups without overlap events.
+ * Pickups are hashed into a 2D grid when they begin play, and registered characters are tested
+ * against the cells around them a few times per second. Pickups are expected to stay put until picked up.
+ */
+UCLASS(config=Game)
+class DASHER_API UDasherPickupSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Adds the pickup to the grid, it can be picked up until unregistered */
+    void RegisterPickup(UTP_PickUpComponent* Pickup);
+
+    /** Removes the pickup from the grid */
+    void UnregisterPickup(UTP_PickUpComponent* Pickup);
+
+    /** Starts testing the character against pickups */
+    void RegisterCharacter(ADasherCharacter* Character);
+
+    /** Stops testing the character against pickups */
+    void UnregisterCharacter(ADasherCharacter* Character);
+
+    int32 GetNumPickups() const { return PickupCells.Num(); }
+
+    // UTickableWorldSubsystem interface
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    // End of UTickableWorldSubsystem interface
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    /** How many times per second characters are tested against pickups, every frame if zero */
+    UPROPERTY(Config)
+    float CheckRate = 15.f;
+
+    /** Size of a grid cell, pickups and characters are looked up in every cell their bounds touch */
+    UPROPERTY(Config)
+    float CellSize = 500.f;
+
+private:
+
+    void CheckPickups();
+
+    /** Returns the cells touched by a circle on the XY plane */
+    FIntRect GetCells(const FVector& Location, float Radius) const;
+
+    /** Pickups touching each cell */
+    TMap<FIntPoint, TArray<TWeakObjectPtr<UTP_PickUpComponent>>> Cells;
+
+    /** Cells each registered pickup was added to */
+    TMap<TWeakObjectPtr<UTP_PickUpComponent>, FIntRect> PickupCells;
+
+    TArray<TWeakObjectPtr<ADasherCharacter>> Characters;
+
+    /** Pickups touched during a check, handed out once the grid is no longer being iterated */
+    TArray<TPair<TWeakObjectPtr<UTP_PickUpComponent>, TWeakObjectPtr<ADasherCharacter>>> PendingPickUps;
+
+    /** Seconds until the next check */
+    float TimeUntilCheck = 0.f;
+};
@@ -0,0 +1,462 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherProjectileManagerSubsystem.h"
+
+#include "Dasher.h"
+#include "Actors/DasherProjectile.h"
+#include "Core/DasherAllocationTracker.h"
+#include "Core/DasherPerfCounters.h"
+
+#include "Async/ParallelFor.h"
+#include "Components/SphereComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+DECLARE_CYCLE_STAT(TEXT("Batched Projectiles Integrate"), STAT_DasherBatchedProjectilesIntegrate, STATGROUP_Dasher);
+DECLARE_CYCLE_STAT(TEXT("Batched Projectiles Sweep"), STAT_DasherBatchedProjectilesSweep, STATGROUP_Dasher);
+DECLARE_CYCLE_STAT(TEXT("Batched Projectiles Resolve"), STAT_DasherBatchedProjectilesResolve, STATGROUP_Dasher);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Batched Projectiles"), STAT_DasherBatchedProjectiles, STATGROUP_Dasher);
+
+static TAutoConsoleVariable<bool> CVarBatchedProjectiles(
+    TEXT("dasher.Projectiles.Batched"),
+    false,
+    TEXT("When true, weapons fire actor-less projectiles simulated by the projectile manager instead of projectile actors."));
+
+static FAutoConsoleCommandWithWorldAndArgs ProjectileBenchmarkCommand(
+    TEXT("dasher.Projectiles.Benchmark"),
+    TEXT("Compares frame time of projectile actors against batched projectiles. Usage: dasher.Projectiles.Benchmark [Count=2000] [SecondsPerPhase=5] [ProjectileClassPath]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+    {
+        UDasherProjectileManagerSubsystem* ProjectileManager = World != nullptr ? World->GetSubsystem<UDasherProjectileManagerSubsystem>() : nullptr;
+        if (ProjectileManager == nullptr)
+        {
+            return;
+        }
+
+        const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 2000;
+        const float PhaseSeconds = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 5.f;
+        UClass* ProjectileClass = Args.Num() > 2 ? LoadClass<ADasherProjectile>(nullptr, *Args[2]) : nullptr;
+        ProjectileManager->StartBenchmark(ProjectileClass != nullptr ? ProjectileClass : ADasherProjectile::StaticClass(), Count, PhaseSeconds);
+    }));
+
+//////////////////////////////////////////////////////////////////////////
+// FDasherProjectileBuffers
+
+void FDasherProjectileBuffers::Add(const FVector& Location, const FVector& Velocity, const FDasherProjectileArchetype& InArchetype, uint16 ArchetypeIndex, float LifeSpan)
+{
+    PosX.Add(Location.X);
+    PosY.Add(Location.Y);
+    PosZ.Add(Location.Z);
+    VelX.Add(Velocity.X);
+    VelY.Add(Velocity.Y);
+    VelZ.Add(Velocity.Z);
+    EndX.Add(Location.X);
+    EndY.Add(Location.Y);
+    EndZ.Add(Location.Z);
+    GravityZ.Add(InArchetype.GravityZ);
+    MaxSpeed.Add(InArchetype.MaxSpeed > 0.f ? InArchetype.MaxSpeed : BIG_NUMBER);
+    LifeRemaining.Add(LifeSpan);
+    Archetype.Add(ArchetypeIndex);
+}
+
+void FDasherProjectileBuffers::RemoveAtSwap(int32 Index)
+{
+    PosX.RemoveAtSwap(Index, 1, false);
+    PosY.RemoveAtSwap(Index, 1, false);
+    PosZ.RemoveAtSwap(Index, 1, false);
+    VelX.RemoveAtSwap(Index, 1, false);
+    VelY.RemoveAtSwap(Index, 1, false);
+    VelZ.RemoveAtSwap(Index, 1, false);
+    EndX.RemoveAtSwap(Index, 1, false);
+    EndY.RemoveAtSwap(Index, 1, false);
+    EndZ.RemoveAtSwap(Index, 1, false);
+    GravityZ.RemoveAtSwap(Index, 1, false);
+    MaxSpeed.RemoveAtSwap(Index, 1, false);
+    LifeRemaining.RemoveAtSwap(Index, 1, false);
+    Archetype.RemoveAtSwap(Index, 1, false);
+}
+
+void FDasherProjectileBuffers::Reset()
+{
+    PosX.Reset();
+    PosY.Reset();
+    PosZ.Reset();
+    VelX.Reset();
+    VelY.Reset();
+    VelZ.Reset();
+    EndX.Reset();
+    EndY.Reset();
+    EndZ.Reset();
+    GravityZ.Reset();
+    MaxSpeed.Reset();
+    LifeRemaining.Reset();
+    Archetype.Reset();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// UDasherProjectileManagerSubsystem
+
+bool UDasherProjectileManagerSubsystem::IsBatchedSimulationEnabled()
+{
+    return CVarBatchedProjectiles.GetValueOnGameThread();
+}
+
+bool UDasherProjectileManagerSubsystem::Launch(TSubclassOf<ADasherProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation, float LifeSpanOverride)
+{
+    const int32 ArchetypeIndex = FindOrAddArchetype(ProjectileClass);
+    if (ArchetypeIndex == INDEX_NONE)
+    {
+        return false;
+    }
+    const FDasherProjectileArchetype& Archetype = Archetypes[ArchetypeIndex];
+
+    // Same rule as spawning with AdjustIfPossibleButDontSpawnIfColliding, minus the adjusting
+    if (GetWorld()->OverlapBlockingTestByChannel(Location, FQuat::Identity, Archetype.CollisionChannel, FCollisionShape::MakeSphere(Archetype.Radius), FCollisionQueryParams::DefaultQueryParam, Archetype.ResponseParams))
+    {
+        return false;
+    }
+
+    const float LifeSpan = LifeSpanOverride > 0.f ? LifeSpanOverride : Archetype.LifeSpan;
+    Projectiles.Add(Location, Rotation.Vector() * Archetype.InitialSpeed, Archetype, ArchetypeIndex, LifeSpan > 0.f ? LifeSpan : BIG_NUMBER);
+    SET_DWORD_STAT(STAT_DasherBatchedProjectiles, Projectiles.Num());
+    INC_DWORD_STAT(STAT_DasherProjectilesSpawned);
+    return true;
+}
+
+void UDasherProjectileManagerSubsystem::ClearProjectiles()
+{
+    Projectiles.Reset();
+    SET_DWORD_STAT(STAT_DasherBatchedProjectiles, 0);
+}
+
+void UDasherProjectileManagerSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    if (Projectiles.Num() > 0)
+    {
+        FDasherScopedCycleCounter SimulationCycles(FDasherPerfCounters::Get().ProjectileSimulationCycles);
+        Integrate(DeltaTime);
+        Sweep();
+        Resolve();
+        SET_DWORD_STAT(STAT_DasherBatchedProjectiles, Projectiles.Num());
+    }
+
+    if (Benchmark.Phase != EDasherProjectileBenchmarkPhase::None)
+    {
+        TickBenchmark(DeltaTime);
+    }
+}
+
+TStatId UDasherProjectileManagerSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UDasherProjectileManagerSubsystem, STATGROUP_Tickables);
+}
+
+bool UDasherProjectileManagerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+int32 UDasherProjectileManagerSubsystem::FindOrAddArchetype(UClass* ProjectileClass)
+{
+    if (ProjectileClass == nullptr)
+    {
+        return INDEX_NONE;
+    }
+
+    const int32 ExistingIndex = Archetypes.IndexOfByPredicate([ProjectileClass](const FDasherProjectileArchetype& Archetype) { return Archetype.ProjectileClass == ProjectileClass; });
+    if (ExistingIndex != INDEX_NONE)
+    {
+        return ExistingIndex;
+    }
+
+    const ADasherProjectile* Defaults = ProjectileClass->GetDefaultObject<ADasherProjectile>();
+    if (Defaults == nullptr || Defaults->GetCollisionComp() == nullptr || Defaults->GetProjectileMovement() == nullptr || Archetypes.Num() > MAX_uint16)
+    {
+        return INDEX_NONE;
+    }
+
+    const USphereComponent* CollisionComp = Defaults->GetCollisionComp();
+    const UProjectileMovementComponent* ProjectileMovement = Defaults->GetProjectileMovement();
+
+    FDasherProjectileArchetype& Archetype = Archetypes.AddDefaulted_GetRef();
+    Archetype.ProjectileClass = ProjectileClass;
+    Archetype.CollisionChannel = CollisionComp->GetCollisionObjectType();
+    Archetype.ResponseParams.CollisionResponse = CollisionComp->GetCollisionResponseToChannels();
+    Archetype.Radius = CollisionComp->GetScaledSphereRadius();
+    Archetype.InitialSpeed = ProjectileMovement->InitialSpeed;
+    Archetype.MaxSpeed = ProjectileMovement->MaxSpeed;
+    Archetype.GravityZ = GetWorld()->GetGravityZ() * ProjectileMovement->ProjectileGravityScale;
+    Archetype.Bounciness = ProjectileMovement->Bounciness;
+    Archetype.Friction = ProjectileMovement->Friction;
+    Archetype.BounceStopSpeed = ProjectileMovement->BounceVelocityStopSimulatingThreshold;
+    Archetype.LifeSpan = Defaults->InitialLifeSpan;
+    Archetype.bShouldBounce = ProjectileMovement->bShouldBounce;
+    return Archetypes.Num() - 1;
+}
+
+void UDasherProjectileManagerSubsystem::Integrate(float DeltaTime)
+{
+    SCOPE_CYCLE_COUNTER(STAT_DasherBatchedProjectilesIntegrate);
+
+    const int32 Num = Projectiles.Num();
+    float* RESTRICT PosX = Projectiles.PosX.GetData();
+    float* RESTRICT PosY = Projectiles.PosY.GetData();
+    float* RESTRICT PosZ = Projectiles.PosZ.GetData();
+    float* RESTRICT VelX = Projectiles.VelX.GetData();
+    float* RESTRICT VelY = Projectiles.VelY.GetData();
+    float* RESTRICT VelZ = Projectiles.VelZ.GetData();
+    float* RESTRICT EndX = Projectiles.EndX.GetData();
+    float* RESTRICT EndY = Projectiles.EndY.GetData();
+    float* RESTRICT EndZ = Projectiles.EndZ.GetData();
+    const float* RESTRICT GravityZ = Projectiles.GravityZ.GetData();
+    const float* RESTRICT MaxSpeed = Projectiles.MaxSpeed.GetData();
+    float* RESTRICT LifeRemaining = Projectiles.LifeRemaining.GetData();
+
+    // Four projectiles at a time: apply gravity, clamp to max speed like UProjectileMovementComponent::LimitVelocity, then find the sweep end
+    const VectorRegister4Float Dt = VectorSetFloat1(DeltaTime);
+    const VectorRegister4Float MinSpeedSquared = VectorSetFloat1(SMALL_NUMBER);
+    int32 Index = 0;
+    for (; Index + 4 <= Num; Index += 4)
+    {
+        VectorRegister4Float VX = VectorLoad(VelX + Index);
+        VectorRegister4Float VY = VectorLoad(VelY + Index);
+        VectorRegister4Float VZ = VectorMultiplyAdd(VectorLoad(GravityZ + Index), Dt, VectorLoad(VelZ + Index));
+
+        const VectorRegister4Float SpeedSquared = VectorMultiplyAdd(VX, VX, VectorMultiplyAdd(VY, VY, VectorMultiply(VZ, VZ)));
+        const VectorRegister4Float SpeedScale = VectorMin(GlobalVectorConstants::FloatOne, VectorMultiply(VectorLoad(MaxSpeed + Index), VectorReciprocalSqrt(VectorMax(SpeedSquared, MinSpeedSquared))));
+        VX = VectorMultiply(VX, SpeedScale);
+        VY = VectorMultiply(VY, SpeedScale);
+        VZ = VectorMultiply(VZ, SpeedScale);
+
+        VectorStore(VX, VelX + Index);
+        VectorStore(VY, VelY + Index);
+        VectorStore(VZ, VelZ + Index);
+        VectorStore(VectorMultiplyAdd(VX, Dt, VectorLoad(PosX + Index)), EndX + Index);
+        VectorStore(VectorMultiplyAdd(VY, Dt, VectorLoad(PosY + Index)), EndY + Index);
+        VectorStore(VectorMultiplyAdd(VZ, Dt, VectorLoad(PosZ + Index)), EndZ + Index);
+        VectorStore(VectorSubtract(VectorLoad(LifeRemaining + Index), Dt), LifeRemaining + Index);
+    }
+
+    for (; Index < Num; ++Index)
+    {
+        VelZ[Index] += GravityZ[Index] * DeltaTime;
+
+        const float SpeedSquared = FMath::Max(VelX[Index] * VelX[Index] + VelY[Index] * VelY[Index] + VelZ[Index] * VelZ[Index], SMALL_NUMBER);
+        const float SpeedScale = FMath::Min(1.f, MaxSpeed[Index] * FMath::InvSqrt(SpeedSquared));
+        VelX[Index] *= SpeedScale;
+        VelY[Index] *= SpeedScale;
+        VelZ[Index] *= SpeedScale;
+
+        EndX[Index] = PosX[Index] + VelX[Index] * DeltaTime;
+        EndY[Index] = PosY[Index] + VelY[Index] * DeltaTime;
+        EndZ[Index] = PosZ[Index] + VelZ[Index] * DeltaTime;
+        LifeRemaining[Index] -= DeltaTime;
+    }
+}
+
+void UDasherProjectileManagerSubsystem::Sweep()
+{
+    SCOPE_CYCLE_COUNTER(STAT_DasherBatchedProjectilesSweep);
+
+    const int32 Num = Projectiles.Num();
+    SweepHits.SetNum(Num, false);
+    SweepBlocked.SetNum(Num, false);
+
+    const UWorld* World = GetWorld();
+    const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(DasherBatchedProjectileSweep), false);
+
+    // Scene queries only read the physics scene, so the whole batch is swept in parallel
+    ParallelFor(Num, [this, World, &QueryParams](int32 Index)
+    {
+        const FDasherProjectileArchetype& Archetype = Archetypes[Projectiles.Archetype[Index]];
+        const FVector Start(Projectiles.PosX[Index], Projectiles.PosY[Index], Projectiles.PosZ[Index]);
+        const FVector End(Projectiles.EndX[Index], Projectiles.EndY[Index], Projectiles.EndZ[Index]);
+
+        SweepBlocked[Index] = World->SweepSingleByChannel(SweepHits[Index], Start, End, FQuat::Identity, Archetype.CollisionChannel, FCollisionShape::MakeSphere(Archetype.Radius), QueryParams, Archetype.ResponseParams);
+    });
+}
+
+void UDasherProjectileManagerSubsystem::Resolve()
+{
+    SCOPE_CYCLE_COUNTER(STAT_DasherBatchedProjectilesResolve);
+    DASHER_ALLOCATION_SCOPE();
+
+    // Walk backwards so removed projectiles are swapped with ones that are already resolved
+    for (int32 Index = Projectiles.Num() - 1; Index >= 0; --Index)
+    {
+        if (Projectiles.LifeRemaining[Index] <= 0.f)
+        {
+            Projectiles.RemoveAtSwap(Index);
+            INC_DWORD_STAT(STAT_DasherProjectilesDestroyed);
+            continue;
+        }
+
+        if (!SweepBlocked[Index])
+        {
+            Projectiles.PosX[Index] = Projectiles.EndX[Index];
+            Projectiles.PosY[Index] = Projectiles.EndY[Index];
+            Projectiles.PosZ[Index] = Projectiles.EndZ[Index];
+            continue;
+        }
+
+        const FDasherProjectileArchetype& Archetype = Archetypes[Projectiles.Archetype[Index]];
+        const FHitResult& Hit = SweepHits[Index];
+        FVector Velocity(Projectiles.VelX[Index], Projectiles.VelY[Index], Projectiles.VelZ[Index]);
+
+        // Only add impulse and destroy projectile if we hit a physics, same as ADasherProjectile::OnHit
+        UPrimitiveComponent* OtherComp = Hit.GetComponent();
+        if (OtherComp != nullptr && OtherComp->IsSimulatingPhysics())
+        {
+            OtherComp->AddImpulseAtLocation(Velocity * 100.0f, Hit.Location);
+            Projectiles.RemoveAtSwap(Index);
+            INC_DWORD_STAT(STAT_DasherProjectilesDestroyed);
+            continue;
+        }
+
+        FVector Location = Hit.Location;
+        if (Hit.bStartPenetrating)
+        {
+            Location = Hit.TraceStart + Hit.Normal * (Hit.PenetrationDepth + KINDA_SMALL_NUMBER);
+        }
+
+        if (Archetype.bShouldBounce)
+        {
+            // Same response as UProjectileMovementComponent::ComputeBounceDelta
+            const float VelocityDotNormal = Velocity | Hit.Normal;
+            if (VelocityDotNormal < 0.f)
+            {
+                const FVector ProjectedNormal = Hit.Normal * -VelocityDotNormal;
+                Velocity += ProjectedNormal;
+                Velocity *= FMath::Clamp(1.f - Archetype.Friction, 0.f, 1.f);
+                Velocity += ProjectedNormal * FMath::Max(Archetype.Bounciness, 0.f);
+            }
+        }
+
+        // Projectiles that stop come to rest where they are until their lifespan runs out
+        if (!Archetype.bShouldBounce || Velocity.SizeSquared() < FMath::Square(Archetype.BounceStopSpeed))
+        {
+            Velocity = FVector::ZeroVector;
+            Projectiles.GravityZ[Index] = 0.f;
+        }
+
+        Projectiles.PosX[Index] = Location.X;
+        Projectiles.PosY[Index] = Location.Y;
+        Projectiles.PosZ[Index] = Location.Z;
+        Projectiles.VelX[Index] = Velocity.X;
+        Projectiles.VelY[Index] = Velocity.Y;
+        Projectiles.VelZ[Index] = Velocity.Z;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Benchmark
+
+void UDasherProjectileManagerSubsystem::StartBenchmark(TSubclassOf<ADasherProjectile> ProjectileClass, int32 Count, float PhaseSeconds)
+{
+    if (Benchmark.Phase != EDasherProjectileBenchmarkPhase::None)
+    {
+        UE_LOG(LogDasher, Warning, TEXT("Projectile benchmark is already running"));
+        return;
+    }
+
+    Benchmark = FDasherProjectileBenchmark();
+    Benchmark.ProjectileClass = ProjectileClass;
+    Benchmark.Count = FMath::Max(Count, 1);
+    Benchmark.PhaseSeconds = FMath::Max(PhaseSeconds, 1.f);
+
+    UE_LOG(LogDasher, Log, TEXT("Projectile benchmark: %d rounds of %s, %.1f seconds per phase"), Benchmark.Count, *GetNameSafe(ProjectileClass), Benchmark.PhaseSeconds);
+    BeginBenchmarkPhase(EDasherProjectileBenchmarkPhase::Idle);
+}
+
+void UDasherProjectileManagerSubsystem::TickBenchmark(float DeltaTime)
+{
+    const double Now = FPlatformTime::Seconds();
+    if (Benchmark.LastFrameTime > 0.0)
+    {
+        Benchmark.FrameTimeSum += Now - Benchmark.LastFrameTime;
+        ++Benchmark.FrameCount;
+    }
+    Benchmark.LastFrameTime = Now;
+
+    if (Now - Benchmark.PhaseStartTime >= Benchmark.PhaseSeconds)
+    {
+        EndBenchmarkPhase();
+    }
+}
+
+void UDasherProjectileManagerSubsystem::BeginBenchmarkPhase(EDasherProjectileBenchmarkPhase Phase)
+{
+    Benchmark.Phase = Phase;
+    Benchmark.PhaseStartTime = FPlatformTime::Seconds();
+    Benchmark.LastFrameTime = 0.0;
+    Benchmark.FrameTimeSum = 0.0;
+    Benchmark.FrameCount = 0;
+
+    // Both paths fire the same rounds from the same fixed seed
+    FRandomStream RandomStream(1337);
+    const float LifeSpan = Benchmark.PhaseSeconds + 1.f;
+    UWorld* World = GetWorld();
+    for (int32 RoundIndex = 0; Phase != EDasherProjectileBenchmarkPhase::Idle && RoundIndex < Benchmark.Count; ++RoundIndex)
+    {
+        const FVector Location(RandomStream.FRandRange(-2000.f, 2000.f), RandomStream.FRandRange(-2000.f, 2000.f), RandomStream.FRandRange(200.f, 600.f));
+        const FRotator Rotation(RandomStream.FRandRange(-30.f, 30.f), RandomStream.FRandRange(-180.f, 180.f), 0.f);
+
+        if (Phase == EDasherProjectileBenchmarkPhase::Actors)
+        {
+            FActorSpawnParameters ActorSpawnParams;
+            ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+            if (ADasherProjectile* Projectile = World->SpawnActor<ADasherProjectile>(Benchmark.ProjectileClass, Location, Rotation, ActorSpawnParams))
+            {
+                Projectile->SetLifeSpan(LifeSpan);
+                Benchmark.SpawnedActors.Add(Projectile);
+            }
+        }
+        else
+        {
+            Launch(Benchmark.ProjectileClass, Location, Rotation, LifeSpan);
+        }
+    }
+}
+
+void UDasherProjectileManagerSubsystem::EndBenchmarkPhase()
+{
+    const double FrameMs = Benchmark.FrameCount > 0 ? Benchmark.FrameTimeSum * 1000.0 / Benchmark.FrameCount : 0.0;
+
+    switch (Benchmark.Phase)
+    {
+    case EDasherProjectileBenchmarkPhase::Idle:
+        Benchmark.IdleFrameMs = FrameMs;
+        BeginBenchmarkPhase(EDasherProjectileBenchmarkPhase::Actors);
+        break;
+
+    case EDasherProjectileBenchmarkPhase::Actors:
+        Benchmark.ActorFrameMs = FrameMs;
+        for (const TWeakObjectPtr<AActor>& Actor : Benchmark.SpawnedActors)
+        {
+            if (Actor.IsValid())
+            {
+                Actor->Destroy();
+            }
+        }
+        Benchmark.SpawnedActors.Reset();
+        BeginBenchmarkPhase(EDasherProjectileBenchmarkPhase::Batched);
+        break;
+
+    case EDasherProjectileBenchmarkPhase::Batched:
+        ClearProjectiles();
+        UE_LOG(LogDasher, Log, TEXT("Projectile benchmark (%d rounds): idle %.3f ms/frame, actors %.3f ms/frame (+%.3f), batched %.3f ms/frame (+%.3f)"),
+            Benchmark.Count, Benchmark.IdleFrameMs,
+            Benchmark.ActorFrameMs, Benchmark.ActorFrameMs - Benchmark.IdleFrameMs,
+            FrameMs, FrameMs - Benchmark.IdleFrameMs);
+        Benchmark.Phase = EDasherProjectileBenchmarkPhase::None;
+        break;
+
+    default:
+        Benchmark.Phase = EDasherProjectileBenchmarkPhase::None;
+        break;
+    }
+}
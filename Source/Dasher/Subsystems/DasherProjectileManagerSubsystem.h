@@ -0,0 +1,132 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Engine/HitResult.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DasherProjectileManagerSubsystem.generated.h"
+
+class ADasherProjectile;
+
+/** Simulation settings shared by every batched projectile of a projectile class, read from its defaults */
+struct FDasherProjectileArchetype
+{
+    TWeakObjectPtr<UClass> ProjectileClass;
+    ECollisionChannel CollisionChannel = ECC_WorldDynamic;
+    FCollisionResponseParams ResponseParams;
+    float Radius = 5.f;
+    float InitialSpeed = 3000.f;
+    float MaxSpeed = 3000.f;
+    float GravityZ = 0.f;
+    float Bounciness = 0.6f;
+    float Friction = 0.2f;
+    float BounceStopSpeed = 5.f;
+    float LifeSpan = 3.f;
+    bool bShouldBounce = true;
+};
+
+/** In-flight batched projectiles, one array per field so the integration pass runs over contiguous floats */
+struct FDasherProjectileBuffers
+{
+    TArray<float> PosX, PosY, PosZ;
+    TArray<float> VelX, VelY, VelZ;
+    TArray<float> EndX, EndY, EndZ;
+    TArray<float> GravityZ;
+    TArray<float> MaxSpeed;
+    TArray<float> LifeRemaining;
+    TArray<uint16> Archetype;
+
+    int32 Num() const { return PosX.Num(); }
+
+    void Add(const FVector& Location, const FVector& Velocity, const FDasherProjectileArchetype& InArchetype, uint16 ArchetypeIndex, float LifeSpan);
+    void RemoveAtSwap(int32 Index);
+    void Reset();
+};
+
+/** Phases of the projectile benchmark, each measured for the same duration */
+enum class EDasherProjectileBenchmarkPhase : uint8
+{
+    None,
+    Idle,
+    Actors,
+    Batched
+};
+
+/** State of a running projectile benchmark */
+struct FDasherProjectileBenchmark
+{
+    EDasherProjectileBenchmarkPhase Phase = EDasherProjectileBenchmarkPhase::None;
+    TSubclassOf<ADasherProjectile> ProjectileClass;
+    int32 Count = 0;
+    float PhaseSeconds = 0.f;
+    double PhaseStartTime = 0.0;
+    double LastFrameTime = 0.0;
+    double FrameTimeSum = 0.0;
+    int32 FrameCount = 0;
+    double IdleFrameMs = 0.0;
+    double ActorFrameMs = 0.0;
+    TArray<TWeakObjectPtr<AActor>> SpawnedActors;
+};
+
+/**
+ * Optional actor-less projectile simulation, enabled with dasher.Projectiles.Batched.
+ * Integrates every in-flight projectile in one SIMD pass per frame and sweeps them as a parallel batch,
+ * with the same speed, bounce, collision radius and physics impulse as ADasherProjectile.
+ * Batched projectiles are simulated on the server only and have no visual representation.
+ */
+UCLASS()
+class DASHER_API UDasherProjectileManagerSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Returns true if weapons should fire batched projectiles instead of projectile actors */
+    static bool IsBatchedSimulationEnabled();
+
+    /** Launches a projectile using the movement and collision settings of the projectile class. Returns false if the location is blocked */
+    bool Launch(TSubclassOf<ADasherProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation, float LifeSpanOverride = -1.f);
+
+    /** Number of batched projectiles in flight */
+    int32 GetNumProjectiles() const { return Projectiles.Num(); }
+
+    /** Removes every batched projectile */
+    void ClearProjectiles();
+
+    /** Compares projectile actors against batched projectiles by frame time, logging the results */
+    void StartBenchmark(TSubclassOf<ADasherProjectile> ProjectileClass, int32 Count, float PhaseSeconds);
+
+    // UTickableWorldSubsystem interface
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    // End of UTickableWorldSubsystem interface
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+    int32 FindOrAddArchetype(UClass* ProjectileClass);
+
+    void Integrate(float DeltaTime);
+    void Sweep();
+    void Resolve();
+
+    void TickBenchmark(float DeltaTime);
+
+    TArray<FDasherProjectileArchetype> Archetypes;
+
+    FDasherProjectileBuffers Projectiles;
+
+    /** Sweep results for the current frame, kept around to avoid reallocating */
+    TArray<FHitResult> SweepHits;
+    TArray<uint8> SweepBlocked;
+
+    void BeginBenchmarkPhase(EDasherProjectileBenchmarkPhase Phase);
+    void EndBenchmarkPhase();
+
+    FDasherProjectileBenchmark Benchmark;
+};
@@ -0,0 +1,197 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherProjectilePoolSubsystem.h"
+
+#include "Dasher.h"
+#include "Actors/DasherProjectile.h"
+#include "Core/DasherAllocationTracker.h"
+
+#include "Engine/World.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Projectiles"), STAT_DasherPooledProjectiles, STATGROUP_Dasher);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Live Pooled Projectiles"), STAT_DasherLivePooledProjectiles, STATGROUP_Dasher);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectile Pool High Water"), STAT_DasherProjectilePoolHighWater, STATGROUP_Dasher);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectile Pool Misses"), STAT_DasherProjectilePoolMisses, STATGROUP_Dasher);
+
+void UDasherProjectilePoolSubsystem::Prewarm(TSubclassOf<ADasherProjectile> ProjectileClass, int32 Count)
+{
+    if (ProjectileClass == nullptr)
+    {
+        return;
+    }
+
+    FDasherProjectilePool& Pool = Pools.FindOrAdd(ProjectileClass);
+    const int32 TargetCount = FMath::Min(Count < 0 ? PrewarmCount : Count, MaxPoolSize);
+    while (Pool.Available.Num() < TargetCount)
+    {
+        ADasherProjectile* Projectile = SpawnPooledProjectile(ProjectileClass);
+        if (Projectile == nullptr)
+        {
+            break;
+        }
+        Pool.Available.Add(Projectile);
+    }
+
+    UpdateStats();
+}
+
+ADasherProjectile* UDasherProjectilePoolSubsystem::Acquire(TSubclassOf<ADasherProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation, AActor* Owner, APawn* Instigator)
+{
+    if (ProjectileClass == nullptr)
+    {
+        return nullptr;
+    }
+
+    FDasherProjectilePool& Pool = Pools.FindOrAdd(ProjectileClass);
+
+    ADasherProjectile* Projectile = nullptr;
+    while (Projectile == nullptr && Pool.Available.Num() > 0)
+    {
+        // Projectiles can be destroyed behind our back, e.g. by streaming out their level
+        Projectile = Pool.Available.Pop(false);
+        if (!IsValid(Projectile))
+        {
+            Projectile = nullptr;
+        }
+    }
+
+    if (Projectile == nullptr)
+    {
+        ++Pool.Misses;
+        Projectile = SpawnPooledProjectile(ProjectileClass);
+        if (Projectile == nullptr)
+        {
+            UpdateStats();
+            return nullptr;
+        }
+    }
+
+    Projectile->SetOwner(Owner);
+    Projectile->SetInstigator(Instigator);
+    if (!Projectile->ActivateFromPool(Location, Rotation))
+    {
+        Pool.Available.Add(Projectile);
+        UpdateStats();
+        return nullptr;
+    }
+
+    Pool.Live.Add(Projectile);
+    Pool.HighWaterMark = FMath::Max(Pool.HighWaterMark, Pool.Live.Num());
+    UpdateStats();
+
+    return Projectile;
+}
+
+void UDasherProjectilePoolSubsystem::Release(ADasherProjectile* Projectile)
+{
+    if (!IsValid(Projectile) || Projectile->IsInPool())
+    {
+        return;
+    }
+
+    FDasherProjectilePool& Pool = Pools.FindOrAdd(Projectile->GetClass());
+    Pool.Live.RemoveSingleSwap(Projectile, false);
+
+    if (Pool.Available.Num() >= MaxPoolSize)
+    {
+        Projectile->bPooledInstance = false;
+        Projectile->Destroy();
+    }
+    else
+    {
+        Projectile->DeactivateToPool();
+        Pool.Available.Add(Projectile);
+    }
+
+    UpdateStats();
+}
+
+void UDasherProjectilePoolSubsystem::GetProjectileCounts(int32& OutNumPooled, int32& OutNumLive) const
+{
+    OutNumPooled = 0;
+    OutNumLive = 0;
+    for (const TPair<TObjectPtr<UClass>, FDasherProjectilePool>& Pair : Pools)
+    {
+        OutNumPooled += Pair.Value.Available.Num();
+        OutNumLive += Pair.Value.Live.Num();
+    }
+}
+
+void UDasherProjectilePoolSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    DASHER_ALLOCATION_SCOPE();
+
+    const double Now = GetWorld()->GetTimeSeconds();
+    for (TPair<TObjectPtr<UClass>, FDasherProjectilePool>& Pair : Pools)
+    {
+        // Walk backwards, releasing swaps the last projectile into the released one's place
+        TArray<TObjectPtr<ADasherProjectile>>& Live = Pair.Value.Live;
+        for (int32 Index = Live.Num() - 1; Index >= 0; --Index)
+        {
+            ADasherProjectile* Projectile = Live[Index];
+            if (!IsValid(Projectile))
+            {
+                Live.RemoveAtSwap(Index, 1, false);
+            }
+            else if (Projectile->PoolExpireTime > 0.0 && Now >= Projectile->PoolExpireTime)
+            {
+                Projectile->Recycle();
+            }
+        }
+    }
+}
+
+TStatId UDasherProjectilePoolSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UDasherProjectilePoolSubsystem, STATGROUP_Tickables);
+}
+
+bool UDasherProjectilePoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+ADasherProjectile* UDasherProjectilePoolSubsystem::SpawnPooledProjectile(UClass* ProjectileClass)
+{
+    UWorld* const World = GetWorld();
+    if (World == nullptr)
+    {
+        return nullptr;
+    }
+
+    // Pooled projectiles wait out of play, collision is checked again when they are handed out
+    FActorSpawnParameters ActorSpawnParams;
+    ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+    ADasherProjectile* Projectile = World->SpawnActor<ADasherProjectile>(ProjectileClass, FVector::ZeroVector, FRotator::ZeroRotator, ActorSpawnParams);
+    if (Projectile != nullptr)
+    {
+        Projectile->bPooledInstance = true;
+        Projectile->DeactivateToPool();
+    }
+    return Projectile;
+}
+
+void UDasherProjectilePoolSubsystem::UpdateStats() const
+{
+#if STATS
+    int32 NumAvailable = 0;
+    int32 NumLive = 0;
+    int32 HighWaterMark = 0;
+    int32 Misses = 0;
+    for (const TPair<TObjectPtr<UClass>, FDasherProjectilePool>& Pair : Pools)
+    {
+        NumAvailable += Pair.Value.Available.Num();
+        NumLive += Pair.Value.Live.Num();
+        HighWaterMark += Pair.Value.HighWaterMark;
+        Misses += Pair.Value.Misses;
+    }
+
+    SET_DWORD_STAT(STAT_DasherPooledProjectiles, NumAvailable);
+    SET_DWORD_STAT(STAT_DasherLivePooledProjectiles, NumLive);
+    SET_DWORD_STAT(STAT_DasherProjectilePoolHighWater, HighWaterMark);
+    SET_DWORD_STAT(STAT_DasherProjectilePoolMisses, Misses);
+#endif
+}
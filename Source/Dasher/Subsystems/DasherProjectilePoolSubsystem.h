@@ -0,0 +1,82 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DasherProjectilePoolSubsystem.generated.h"
+
+class ADasherProjectile;
+
+/** Projectiles of a single class kept around for reuse */
+USTRUCT()
+struct FDasherProjectilePool
+{
+    GENERATED_BODY()
+
+    /** Projectiles waiting to be handed out */
+    UPROPERTY()
+    TArray<TObjectPtr<ADasherProjectile>> Available;
+
+    /** Projectiles currently in play, in no particular order */
+    UPROPERTY()
+    TArray<TObjectPtr<ADasherProjectile>> Live;
+
+    /** Most projectiles that were in play at the same time */
+    int32 HighWaterMark = 0;
+
+    /** Requests that found the pool empty and had to spawn a new projectile */
+    int32 Misses = 0;
+};
+
+/**
+ * Keeps spawned projectiles alive between shots, so firing doesn't pay for actor spawning,
+ * replication channel setup and garbage collection every time.
+ * The pool also expires the projectiles it hands out, instead of an actor lifespan timer per shot, whose
+ * delegate would be allocated on every activation. Once warmed up, firing and recycling don't allocate.
+ */
+UCLASS(config=Game)
+class DASHER_API UDasherProjectilePoolSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Makes sure there are at least Count projectiles of the class waiting in the pool, PrewarmCount if negative */
+    void Prewarm(TSubclassOf<ADasherProjectile> ProjectileClass, int32 Count = -1);
+
+    /** Hands out a projectile at the given location, or returns null if the location is blocked */
+    ADasherProjectile* Acquire(TSubclassOf<ADasherProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation, AActor* Owner, APawn* Instigator);
+
+    /** Takes a projectile back into the pool */
+    void Release(ADasherProjectile* Projectile);
+
+    /** Counts the projectiles waiting in the pool and those handed out, over all classes */
+    void GetProjectileCounts(int32& OutNumPooled, int32& OutNumLive) const;
+
+    // UTickableWorldSubsystem interface
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    // End of UTickableWorldSubsystem interface
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    /** Number of projectiles created per class when a weapon using it is equipped */
+    UPROPERTY(Config)
+    int32 PrewarmCount = 32;
+
+    /** Most projectiles kept waiting per class, the rest are destroyed when released */
+    UPROPERTY(Config)
+    int32 MaxPoolSize = 256;
+
+private:
+
+    ADasherProjectile* SpawnPooledProjectile(UClass* ProjectileClass);
+
+    void UpdateStats() const;
+
+    UPROPERTY()
+    TMap<TObjectPtr<UClass>, FDasherProjectilePool> Pools;
+};
@@ -0,0 +1,189 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherProjectilePredictionSubsystem.h"
+
+#include "Dasher.h"
+#include "Actors/DasherProjectile.h"
+#include "Core/DasherPerfCounters.h"
+
+#include "Components/SphereComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+
+bool UDasherProjectilePredictionSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    // Servers fire the real projectiles
+    return Super::ShouldCreateSubsystem(Outer) && !IsRunningDedicatedServer();
+}
+
+void UDasherProjectilePredictionSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    MaxPredictedShots = FMath::Max(MaxPredictedShots, 1);
+    Shots.Reserve(MaxPredictedShots);
+}
+
+void UDasherProjectilePredictionSubsystem::AddPredictedShot(const APawn* Shooter, uint8 ShotId, ADasherProjectile* Projectile)
+{
+    // The oldest prediction goes early, the new one is more likely to be looked at. A matched one hands over to the
+    // server's projectile, an unmatched one gives up waiting, like when it times out
+    if (Shots.Num() >= MaxPredictedShots)
+    {
+        if (Shots[0].BlendStartTime != 0.0 || bServerFiresProjectiles)
+        {
+            EndShot(Shots[0], true);
+        }
+        if (Shots[0].BlendStartTime == 0.0)
+        {
+            INC_DWORD_STAT(STAT_DasherPredictedShotsUnmatched);
+        }
+        Shots.RemoveAt(0, 1, false);
+    }
+
+    FDasherPredictedShot& Shot = Shots.AddDefaulted_GetRef();
+    Shot.Shooter = Shooter;
+    Shot.Predicted = Projectile;
+    Shot.FireTime = GetWorld()->GetTimeSeconds();
+    Shot.ShotId = ShotId;
+
+    INC_DWORD_STAT(STAT_DasherPredictedShots);
+    ++FDasherPerfCounters::Get().PredictedShots;
+}
+
+void UDasherProjectilePredictionSubsystem::MatchProjectile(ADasherProjectile* Authoritative)
+{
+    const APawn* Shooter = Authoritative->GetInstigator();
+    for (FDasherPredictedShot& Shot : Shots)
+    {
+        if (Shot.BlendStartTime != 0.0 || Shot.ShotId != Authoritative->GetShotId() || Shot.Shooter.Get() != Shooter)
+        {
+            continue;
+        }
+
+        INC_DWORD_STAT(STAT_DasherPredictedShotsMatched);
+        ++FDasherPerfCounters::Get().PredictedShotsMatched;
+        bServerFiresProjectiles = true;
+
+        Shot.Authoritative = Authoritative;
+        Shot.BlendStartTime = GetWorld()->GetTimeSeconds();
+
+        // The prediction already hit something, the server's shows for the little of its flight that is left
+        ADasherProjectile* Predicted = Shot.Predicted.Get();
+        if (Predicted == nullptr || Predicted->IsInPool())
+        {
+            EndShot(Shot, true);
+            Shots.RemoveAt(&Shot - Shots.GetData(), 1, false);
+            return;
+        }
+
+        // Only the predicted projectile shows from now on, flying the way the server's does. It stays ahead of the
+        // server's, which left the muzzle a round trip later
+        Authoritative->SetActorHiddenInGame(true);
+        Predicted->GetProjectileMovement()->Velocity = Authoritative->GetVelocity();
+        Predicted->GetCollisionComp()->IgnoreActorWhenMoving(Authoritative, true);
+        return;
+    }
+}
+
+void UDasherProjectilePredictionSubsystem::RejectShots(const APawn* Shooter, uint8 FirstShotId, uint16 RejectedMask)
+{
+    for (int32 Index = Shots.Num() - 1; Index >= 0; --Index)
+    {
+        FDasherPredictedShot& Shot = Shots[Index];
+        const uint8 Bit = static_cast<uint8>(Shot.ShotId - FirstShotId);
+        if (Shot.BlendStartTime != 0.0 || Shot.Shooter.Get() != Shooter || Bit >= 16 || (RejectedMask & (1 << Bit)) == 0)
+        {
+            continue;
+        }
+
+        INC_DWORD_STAT(STAT_DasherPredictedShotsRejected);
+        ++FDasherPerfCounters::Get().PredictedShotsRejected;
+
+        if (ADasherProjectile* Predicted = Shot.Predicted.Get())
+        {
+            Predicted->Recycle();
+        }
+        Shots.RemoveAt(Index, 1, false);
+    }
+}
+
+void UDasherProjectilePredictionSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    const double Now = GetWorld()->GetTimeSeconds();
+    for (int32 Index = Shots.Num() - 1; Index >= 0; --Index)
+    {
+        FDasherPredictedShot& Shot = Shots[Index];
+        ADasherProjectile* Predicted = Shot.Predicted.Get();
+
+        if (Shot.BlendStartTime == 0.0)
+        {
+            // Waiting for the server, the prediction has no reason to stay once it has hit something
+            if (Predicted == nullptr || Predicted->IsInPool() || Now - Shot.FireTime >= MatchTimeout)
+            {
+                // A server that fires projectile actors would have sent one by now, the shot was refused and the
+                // unreliable reject lost. Servers simulating actor-less projectiles send none, their shots fly on
+                if (Predicted != nullptr && !Predicted->IsInPool() && bServerFiresProjectiles)
+                {
+                    Predicted->Recycle();
+                }
+                INC_DWORD_STAT(STAT_DasherPredictedShotsUnmatched);
+                Shots.RemoveAt(Index, 1, false);
+            }
+            continue;
+        }
+
+        // The flight is over once the server's projectile hits and goes back to its pool. If the prediction hit
+        // something first, the server's will shortly too, it stays hidden until the pool hands it out again
+        ADasherProjectile* Authoritative = Shot.Authoritative.Get();
+        if (Predicted == nullptr || Predicted->IsInPool() || Authoritative == nullptr || Authoritative->IsInPool())
+        {
+            EndShot(Shot, false);
+            Shots.RemoveAt(Index, 1, false);
+            continue;
+        }
+
+        // Only the sideways error is closed, a bigger part of it every frame until the blend is over and all of it after,
+        // pulling the prediction back to the server's projectile would show the shot jumping backwards
+        const float Alpha = BlendTime > 0.f ? FMath::Clamp(static_cast<float>((Now - Shot.BlendStartTime) / BlendTime), 0.f, 1.f) : 1.f;
+        const FVector PredictedLocation = Predicted->GetActorLocation();
+        const FVector Error = Authoritative->GetActorLocation() - PredictedLocation;
+        const FVector FlightDirection = Authoritative->GetVelocity().GetSafeNormal();
+        Predicted->SetActorLocation(PredictedLocation + (Error - FlightDirection * (Error | FlightDirection)) * Alpha);
+    }
+}
+
+TStatId UDasherProjectilePredictionSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UDasherProjectilePredictionSubsystem, STATGROUP_Tickables);
+}
+
+bool UDasherProjectilePredictionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDasherProjectilePredictionSubsystem::EndShot(FDasherPredictedShot& Shot, bool bShowAuthoritative)
+{
+    ADasherProjectile* Authoritative = Shot.Authoritative.Get();
+    if (Authoritative != nullptr && !Authoritative->IsInPool() && bShowAuthoritative)
+    {
+        Authoritative->SetActorHiddenInGame(false);
+    }
+
+    ADasherProjectile* Predicted = Shot.Predicted.Get();
+    if (Predicted == nullptr)
+    {
+        return;
+    }
+
+    // The pool hands the projectile out again for another shot
+    Predicted->GetCollisionComp()->IgnoreActorWhenMoving(Authoritative, false);
+    if (!Predicted->IsInPool())
+    {
+        Predicted->Recycle();
+    }
+}
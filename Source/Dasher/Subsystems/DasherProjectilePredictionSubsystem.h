@@ -0,0 +1,94 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DasherProjectilePredictionSubsystem.generated.h"
+
+class ADasherProjectile;
+class APawn;
+
+/** A projectile the shooter's client fired ahead of the server, until it is rejected, given up on, or its flight ends */
+struct FDasherPredictedShot
+{
+    TWeakObjectPtr<const APawn> Shooter;
+    TWeakObjectPtr<ADasherProjectile> Predicted;
+
+    /** The server's projectile for the shot, set once matched */
+    TWeakObjectPtr<ADasherProjectile> Authoritative;
+
+    double FireTime = 0.0;
+
+    /** Time the predicted projectile started blending into the server's, zero until matched */
+    double BlendStartTime = 0.0;
+
+    uint8 ShotId = 0;
+};
+
+/**
+ * Reconciles the projectiles a client predicts for its own shots with the server's.
+ * The weapon fires a local projectile the moment the shooter fires, so the shot shows up with no latency. When the
+ * server's projectile for the same shot ID replicates, it stays hidden for the rest of its flight and the predicted one
+ * follows it instead, blending onto its flight path over BlendTime and held there after. Only the sideways error is
+ * closed, the prediction keeps its lead along the path, which the server's, fired a round trip later, would take back.
+ * The server's projectile is never moved on the client, its replicated movement would snap it back. The prediction goes
+ * when the server's projectile hits and returns to its pool. Shots the server refuses kill their predicted projectile
+ * right away.
+ * A prediction not matched within MatchTimeout is recycled once the server is known to fire projectile actors, its shot
+ * was refused and the reject got lost. Until a prediction has been matched, e.g. because the server simulates its
+ * projectiles without actors, it flies on by itself. Counts go to 'stat Dasher' and the perf overlay. Clients only.
+ */
+UCLASS(config=Game)
+class DASHER_API UDasherProjectilePredictionSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Starts tracking a projectile predicted for a shot of a locally controlled shooter */
+    void AddPredictedShot(const APawn* Shooter, uint8 ShotId, ADasherProjectile* Projectile);
+
+    /** Matches a server projectile fired by a locally controlled shooter with its prediction */
+    void MatchProjectile(ADasherProjectile* Authoritative);
+
+    /** Kills the predictions of the shots the server refused, bit N of RejectedMask is shot FirstShotId + N */
+    void RejectShots(const APawn* Shooter, uint8 FirstShotId, uint16 RejectedMask);
+
+    // USubsystem interface
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    // End of USubsystem interface
+
+    // UTickableWorldSubsystem interface
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    // End of UTickableWorldSubsystem interface
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    /** Seconds a predicted projectile takes to blend onto the server's flight path, it follows it from then on */
+    UPROPERTY(Config)
+    float BlendTime = 0.1f;
+
+    /** Seconds a prediction waits for the server's projectile before flying on by itself */
+    UPROPERTY(Config)
+    float MatchTimeout = 1.f;
+
+    /** Most predictions tracked at once, matched ones for their whole flight, room for them is made up front */
+    UPROPERTY(Config)
+    int32 MaxPredictedShots = 128;
+
+private:
+
+    /** Stops tracking a shot, recycling its predicted projectile if it still flies. The server's shows again if asked */
+    void EndShot(FDasherPredictedShot& Shot, bool bShowAuthoritative);
+
+    /** Predictions in the order they were fired */
+    TArray<FDasherPredictedShot> Shots;
+
+    /** Set once a server projectile matched a prediction, the server fires projectile actors rather than batched ones */
+    bool bServerFiresProjectiles = false;
+};
@@ -0,0 +1,206 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherSignificanceSubsystem.h"
+
+#include "Dasher.h"
+#include "Characters/DasherCharacter.h"
+#include "Components/DasherCharacterMovementComponent.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_CYCLE_STAT(TEXT("Significance Update"), STAT_DasherSignificanceUpdate, STATGROUP_Dasher);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance Full Detail Characters"), STAT_DasherSignificanceFullDetail, STATGROUP_Dasher);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance Reduced Characters"), STAT_DasherSignificanceReduced, STATGROUP_Dasher);
+
+static TAutoConsoleVariable<bool> CVarSignificanceEnabled(
+    TEXT("dasher.Significance.Enabled"),
+    true,
+    TEXT("When false, every character is ticked, animated and heard at full detail."));
+
+bool UDasherSignificanceSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    // Nobody is watching on a dedicated server
+    return Super::ShouldCreateSubsystem(Outer) && !IsRunningDedicatedServer();
+}
+
+void UDasherSignificanceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    if (Tiers.IsEmpty())
+    {
+        Tiers.AddDefaulted();
+    }
+    Tiers.Sort([](const FDasherSignificanceTier& A, const FDasherSignificanceTier& B) { return A.MinSignificance > B.MinSignificance; });
+}
+
+void UDasherSignificanceSubsystem::RegisterCharacter(ADasherCharacter* Character)
+{
+    Characters.FindOrAdd(Character);
+}
+
+void UDasherSignificanceSubsystem::UnregisterCharacter(ADasherCharacter* Character)
+{
+    FDasherSignificanceState State;
+    if (Characters.RemoveAndCopyValue(Character, State) && State.Tier > 0)
+    {
+        ApplyTier(Character, 0);
+    }
+}
+
+void UDasherSignificanceSubsystem::ReportActivity(const ADasherCharacter* Character)
+{
+    if (FDasherSignificanceState* State = Characters.Find(Character))
+    {
+        State->LastActivityTime = GetWorld()->GetTimeSeconds();
+    }
+}
+
+const FDasherSignificanceTier& UDasherSignificanceSubsystem::GetTier(const ADasherCharacter* Character) const
+{
+    const FDasherSignificanceState* State = Characters.Find(Character);
+    return Tiers[State != nullptr && State->Tier != INDEX_NONE ? State->Tier : 0];
+}
+
+void UDasherSignificanceSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    TimeUntilUpdate -= DeltaTime;
+    if (TimeUntilUpdate > 0.f)
+    {
+        return;
+    }
+    TimeUntilUpdate = UpdateRate > 0.f ? FMath::Max(TimeUntilUpdate + 1.f / UpdateRate, 0.f) : 0.f;
+
+    UpdateSignificance();
+}
+
+TStatId UDasherSignificanceSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UDasherSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+bool UDasherSignificanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDasherSignificanceSubsystem::UpdateSignificance()
+{
+    SCOPE_CYCLE_COUNTER(STAT_DasherSignificanceUpdate);
+
+    UWorld* World = GetWorld();
+    const bool bEnabled = CVarSignificanceEnabled.GetValueOnGameThread();
+
+    // Every local player is a viewer, split screen keeps detail for whoever is closest
+    TArray<FVector, TInlineAllocator<4>> ViewLocations;
+    for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+    {
+        const APlayerController* PlayerController = It->Get();
+        if (PlayerController != nullptr && PlayerController->IsLocalController())
+        {
+            FVector ViewLocation;
+            FRotator ViewRotation;
+            PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+            ViewLocations.Add(ViewLocation);
+        }
+    }
+
+    int32 NumFullDetail = 0;
+    int32 NumReduced = 0;
+    for (auto It = Characters.CreateIterator(); It; ++It)
+    {
+        ADasherCharacter* Character = It.Key().ResolveObjectPtr();
+        if (Character == nullptr)
+        {
+            It.RemoveCurrent();
+            continue;
+        }
+
+        FDasherSignificanceState& State = It.Value();
+
+        // Only cosmetic copies of remote characters can be budgeted, anything simulated here must stay exact
+        const bool bBudgeted = bEnabled && !ViewLocations.IsEmpty() && Character->GetLocalRole() == ROLE_SimulatedProxy;
+        State.Significance = bBudgeted ? ScoreCharacter(Character, State, ViewLocations) : 1.f;
+
+        const int32 TierIndex = bBudgeted ? GetTierIndex(State.Significance) : 0;
+        if (TierIndex != State.Tier)
+        {
+            // Characters start at full detail, nothing to restore the first time they are scored at it
+            if (State.Tier != INDEX_NONE || TierIndex != 0)
+            {
+                ApplyTier(Character, TierIndex);
+            }
+            State.Tier = TierIndex;
+        }
+
+        if (TierIndex == 0)
+        {
+            ++NumFullDetail;
+        }
+        else
+        {
+            ++NumReduced;
+        }
+    }
+
+    SET_DWORD_STAT(STAT_DasherSignificanceFullDetail, NumFullDetail);
+    SET_DWORD_STAT(STAT_DasherSignificanceReduced, NumReduced);
+}
+
+float UDasherSignificanceSubsystem::ScoreCharacter(const ADasherCharacter* Character, const FDasherSignificanceState& State, TConstArrayView<FVector> ViewLocations) const
+{
+    const FVector Location = Character->GetActorLocation();
+    double ClosestDistSquared = UE_BIG_NUMBER;
+    for (const FVector& ViewLocation : ViewLocations)
+    {
+        ClosestDistSquared = FMath::Min(ClosestDistSquared, FVector::DistSquared(ViewLocation, Location));
+    }
+
+    float Significance = 1.f - FMath::Clamp(FMath::GetRangePct(FullDetailDistance, MinDetailDistance, float(FMath::Sqrt(ClosestDistSquared))), 0.f, 1.f);
+
+    // Includes shadows, a character only seen by its shadow still needs to animate
+    if (!Character->WasRecentlyRendered(0.25f))
+    {
+        Significance *= NotRenderedScale;
+    }
+
+    const bool bRecentlyActive = GetWorld()->GetTimeSeconds() - State.LastActivityTime < ActivityDuration || Character->GetDasherMovement()->IsDashing();
+    if (bRecentlyActive)
+    {
+        Significance += ActivityBonus;
+    }
+
+    return FMath::Clamp(Significance, 0.f, 1.f);
+}
+
+int32 UDasherSignificanceSubsystem::GetTierIndex(float Significance) const
+{
+    for (int32 Index = 0; Index < Tiers.Num(); ++Index)
+    {
+        if (Significance >= Tiers[Index].MinSignificance)
+        {
+            return Index;
+        }
+    }
+    return Tiers.Num() - 1;
+}
+
+void UDasherSignificanceSubsystem::ApplyTier(ADasherCharacter* Character, int32 TierIndex) const
+{
+    const FDasherSignificanceTier& Tier = Tiers[TierIndex];
+
+    Character->SetActorTickInterval(Tier.ActorTickInterval);
+
+    for (USkeletalMeshComponent* Mesh : { Character->GetMesh(), Character->GetMesh1P() })
+    {
+        if (Mesh != nullptr)
+        {
+            Mesh->SetComponentTickInterval(Tier.AnimTickInterval);
+            Mesh->VisibilityBasedAnimTickOption = Tier.AnimTickOption;
+        }
+    }
+}
@@ -0,0 +1,140 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "DasherSignificanceSubsystem.generated.h"
+
+class ADasherCharacter;
+
+/** How much of a character is updated and played while its significance is at least MinSignificance */
+USTRUCT()
+struct FDasherSignificanceTier
+{
+    GENERATED_BODY()
+
+    /** Lowest significance, from 0 to 1, a character needs to be in this tier */
+    UPROPERTY()
+    float MinSignificance = 0.f;
+
+    /** Actor tick interval, every frame if zero */
+    UPROPERTY()
+    float ActorTickInterval = 0.f;
+
+    /** Tick interval of the character's skeletal meshes, every frame if zero */
+    UPROPERTY()
+    float AnimTickInterval = 0.f;
+
+    /** What the skeletal meshes update while they aren't rendered */
+    UPROPERTY()
+    EVisibilityBasedAnimTickOption AnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPose;
+
+    /** Whether the weapon plays its fire sound */
+    UPROPERTY()
+    bool bPlayFireSound = true;
+
+    /** Whether the weapon plays its fire montage */
+    UPROPERTY()
+    bool bPlayFireMontage = true;
+};
+
+/** Significance of one registered character */
+struct FDasherSignificanceState
+{
+    /** From 0 to 1, higher is more significant */
+    float Significance = 1.f;
+
+    /** Index into the tiers, INDEX_NONE until first scored */
+    int32 Tier = INDEX_NONE;
+
+    /** World time the character last did something worth watching, like firing */
+    double LastActivityTime = -UE_BIG_NUMBER;
+};
+
+/**
+ * Scores remote characters by distance to the local viewers, whether they were rendered recently and
+ * whether they did something lately, then budgets their tick, animation and fire cosmetics by tier.
+ * Only simulated proxies have their tick and animation reduced, characters the local world simulates stay at full rate.
+ * Disable with dasher.Significance.Enabled 0 to compare frame times.
+ */
+UCLASS(config=Game)
+class DASHER_API UDasherSignificanceSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Starts scoring the character */
+    void RegisterCharacter(ADasherCharacter* Character);
+
+    /** Stops scoring the character and restores its full detail */
+    void UnregisterCharacter(ADasherCharacter* Character);
+
+    /** Marks the character as active, raising its significance for a while */
+    void ReportActivity(const ADasherCharacter* Character);
+
+    /** Returns the tier the character is budgeted with, the most detailed one for local and unregistered characters */
+    const FDasherSignificanceTier& GetTier(const ADasherCharacter* Character) const;
+
+    // USubsystem interface
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    // End of USubsystem interface
+
+    // UTickableWorldSubsystem interface
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    // End of UTickableWorldSubsystem interface
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    /** How many times per second significance is updated */
+    UPROPERTY(Config)
+    float UpdateRate = 10.f;
+
+    /** Characters closer than this to a viewer are fully significant by distance */
+    UPROPERTY(Config)
+    float FullDetailDistance = 1500.f;
+
+    /** Characters further than this from every viewer are not significant by distance */
+    UPROPERTY(Config)
+    float MinDetailDistance = 8000.f;
+
+    /** Significance is scaled by this for characters that weren't rendered recently */
+    UPROPERTY(Config)
+    float NotRenderedScale = 0.25f;
+
+    /** Significance added for characters that were recently active */
+    UPROPERTY(Config)
+    float ActivityBonus = 0.3f;
+
+    /** How long a character counts as active after firing or while dashing */
+    UPROPERTY(Config)
+    float ActivityDuration = 2.f;
+
+    /** Budget tiers, most detailed first */
+    UPROPERTY(Config)
+    TArray<FDasherSignificanceTier> Tiers;
+
+private:
+
+    void UpdateSignificance();
+
+    /** Returns the significance of the character from the local viewers */
+    float ScoreCharacter(const ADasherCharacter* Character, const FDasherSignificanceState& State, TConstArrayView<FVector> ViewLocations) const;
+
+    /** Returns the first tier the significance qualifies for */
+    int32 GetTierIndex(float Significance) const;
+
+    /** Applies the tier's tick and animation budget to the character */
+    void ApplyTier(ADasherCharacter* Character, int32 TierIndex) const;
+
+    TMap<TObjectKey<ADasherCharacter>, FDasherSignificanceState> Characters;
+
+    /** Seconds until the next update */
+    float TimeUntilUpdate = 0.f;
+};
@@ -0,0 +1,370 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherSwarmSubsystem.h"
+
+#include "Dasher.h"
+#include "Characters/DasherCharacter.h"
+#include "Core/DasherSwarmPlayerController.h"
+
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "InputActionValue.h"
+#include "Misc/CommandLine.h"
+#include "Misc/NetworkVersion.h"
+#include "Misc/PackageName.h"
+#include "Net/DataChannel.h"
+#include "Net/OnlineEngineInterface.h"
+#include "PacketHandler.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Swarm Clients Joined"), STAT_DasherSwarmClientsJoined, STATGROUP_Dasher);
+
+static FAutoConsoleCommandWithWorld SwarmStopCommand(
+    TEXT("dasher.Swarm.Stop"),
+    TEXT("Disconnects every swarm client."),
+    FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+    {
+        if (UDasherSwarmSubsystem* Swarm = World != nullptr ? World->GetSubsystem<UDasherSwarmSubsystem>() : nullptr)
+        {
+            Swarm->StopSwarm();
+        }
+    }));
+
+void UDasherSwarmSubsystem::Deinitialize()
+{
+    StopSwarm();
+
+    Super::Deinitialize();
+}
+
+void UDasherSwarmSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // The swarm process plays the map on its own, its connections are all made here
+    FString Address;
+    if (InWorld.GetNetMode() != NM_Standalone || !FParse::Value(FCommandLine::Get(), TEXT("DasherSwarm="), Address))
+    {
+        return;
+    }
+
+    int32 NumClients = 16;
+    FParse::Value(FCommandLine::Get(), TEXT("DasherSwarmClients="), NumClients);
+    StartSwarm(Address, NumClients);
+}
+
+void UDasherSwarmSubsystem::StartSwarm(const FString& InServerAddress, int32 NumClients)
+{
+    StopSwarm();
+
+    ServerAddress = InServerAddress;
+    NumPendingClients = NumClients;
+    TimeUntilConnect = 0.f;
+    Clients.Reserve(NumClients);
+
+    UE_LOG(LogDasher, Log, TEXT("Swarm: connecting %d clients to %s"), NumClients, *ServerAddress);
+}
+
+void UDasherSwarmSubsystem::StopSwarm()
+{
+    NumPendingClients = 0;
+
+    UWorld* World = GetWorld();
+    for (const FDasherSwarmClient& Client : Clients)
+    {
+        GEngine->DestroyNamedNetDriver(World, Client.NetDriverName);
+    }
+    Clients.Reset();
+
+    SET_DWORD_STAT(STAT_DasherSwarmClientsJoined, 0);
+}
+
+void UDasherSwarmSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    // Connect a few clients at a time
+    if (NumPendingClients > 0)
+    {
+        TimeUntilConnect -= DeltaTime;
+        while (NumPendingClients > 0 && TimeUntilConnect <= 0.f)
+        {
+            ConnectClient(Clients.Num());
+            --NumPendingClients;
+            TimeUntilConnect += ConnectRate > 0.f ? 1.f / ConnectRate : 0.f;
+        }
+    }
+
+    int32 NumJoined = 0;
+    for (FDasherSwarmClient& Client : Clients)
+    {
+        if (!Client.bJoined || !Client.NetDriver.IsValid() || Client.NetDriver->ServerConnection == nullptr)
+        {
+            continue;
+        }
+
+        ProcessNewActors(Client);
+        DriveClient(Client, DeltaTime);
+        ++NumJoined;
+    }
+
+    SET_DWORD_STAT(STAT_DasherSwarmClientsJoined, NumJoined);
+}
+
+TStatId UDasherSwarmSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UDasherSwarmSubsystem, STATGROUP_Tickables);
+}
+
+bool UDasherSwarmSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDasherSwarmSubsystem::ConnectClient(int32 Index)
+{
+    UWorld* World = GetWorld();
+
+    FDasherSwarmClient& Client = Clients.AddDefaulted_GetRef();
+    Client.NetDriverName = *FString::Printf(TEXT("DasherSwarmNetDriver%d"), Index);
+    Client.Random.Initialize(SwarmSeed + Index);
+    Client.TargetYaw = Client.Random.FRandRange(-180.f, 180.f);
+
+    // Same driver as a regular client, under its own name so it lives next to the others
+    if (!GEngine->CreateNamedNetDriver(World, Client.NetDriverName, NAME_GameNetDriver))
+    {
+        UE_LOG(LogDasher, Warning, TEXT("Swarm: couldn't create net driver for client %d"), Index);
+        return;
+    }
+
+    UNetDriver* NetDriver = GEngine->FindNamedNetDriver(World, Client.NetDriverName);
+    NetDriver->SetWorld(World);
+    Client.NetDriver = NetDriver;
+
+    FURL URL(nullptr, *ServerAddress, TRAVEL_Absolute);
+    URL.AddOption(TEXT("DasherSwarm"));
+    URL.AddOption(*FString::Printf(TEXT("Name=Swarm%d"), Index));
+
+    FString Error;
+    if (!NetDriver->InitConnect(this, URL, Error))
+    {
+        UE_LOG(LogDasher, Warning, TEXT("Swarm: client %d couldn't connect to %s: %s"), Index, *ServerAddress, *Error);
+        GEngine->DestroyNamedNetDriver(World, Client.NetDriverName);
+        return;
+    }
+
+    // Same order as UPendingNetGame, packet handler handshake first, then the control channel
+    UNetConnection* Connection = NetDriver->ServerConnection;
+    if (Connection->Handler.IsValid())
+    {
+        Connection->Handler->BeginHandshaking(FPacketHandlerHandshakeComplete::CreateUObject(this, &UDasherSwarmSubsystem::SendHello, Index));
+    }
+    else
+    {
+        SendHello(Index);
+    }
+}
+
+void UDasherSwarmSubsystem::SendHello(int32 Index)
+{
+    UNetDriver* NetDriver = Clients.IsValidIndex(Index) ? Clients[Index].NetDriver.Get() : nullptr;
+    UNetConnection* Connection = NetDriver != nullptr ? NetDriver->ServerConnection : nullptr;
+    if (Connection == nullptr)
+    {
+        return;
+    }
+
+    uint8 IsLittleEndian = uint8(PLATFORM_LITTLE_ENDIAN);
+    uint32 LocalNetworkVersion = FNetworkVersion::GetLocalNetworkVersion();
+    FString EncryptionToken;
+    EEngineNetworkRuntimeFeatures LocalNetworkFeatures = NetDriver->GetNetworkRuntimeFeatures();
+    FNetControlMessage<NMT_Hello>::Send(Connection, IsLittleEndian, LocalNetworkVersion, EncryptionToken, LocalNetworkFeatures);
+    Connection->FlushNet();
+}
+
+EAcceptConnection::Type UDasherSwarmSubsystem::NotifyAcceptingConnection()
+{
+    // Swarm drivers only ever connect out
+    return EAcceptConnection::Reject;
+}
+
+void UDasherSwarmSubsystem::NotifyAcceptedConnection(UNetConnection* Connection)
+{
+}
+
+bool UDasherSwarmSubsystem::NotifyAcceptingChannel(UChannel* Channel)
+{
+    // Like any client, take the actor channels the server opens
+    return Channel->ChName == NAME_Actor;
+}
+
+void UDasherSwarmSubsystem::NotifyControlMessage(UNetConnection* Connection, uint8 MessageType, FInBunch& Bunch)
+{
+    FDasherSwarmClient* Client = FindClient(Connection);
+    if (Client == nullptr)
+    {
+        return;
+    }
+
+    switch (MessageType)
+    {
+        case NMT_Challenge:
+        {
+            // Log in with a name the server can tell apart and an option that gets us a swarm controller
+            if (FNetControlMessage<NMT_Challenge>::Receive(Bunch, Connection->Challenge))
+            {
+                FURL PartialURL(Connection->URL);
+                PartialURL.Host = TEXT("");
+                PartialURL.Port = PartialURL.UrlConfig.DefaultPort;
+                PartialURL.Map = TEXT("");
+                FString URLString = PartialURL.ToString();
+
+                Connection->ClientResponse = TEXT("0");
+                FUniqueNetIdRepl UniqueIdRepl(UOnlineEngineInterface::Get()->CreateUniquePlayerIdWrapper(Client->NetDriverName.ToString(), UOnlineEngineInterface::Get()->GetDefaultOnlineSubsystemName()));
+                FString OnlinePlatformName = UOnlineEngineInterface::Get()->GetDefaultOnlineSubsystemName().ToString();
+                FNetControlMessage<NMT_Login>::Send(Connection, Connection->ClientResponse, URLString, UniqueIdRepl, OnlinePlatformName);
+                Connection->FlushNet();
+            }
+            break;
+        }
+        case NMT_Welcome:
+        {
+            FString Map;
+            FString GameName;
+            FString RedirectURL;
+            if (FNetControlMessage<NMT_Welcome>::Receive(Bunch, Map, GameName, RedirectURL))
+            {
+                // The swarm already has the map loaded, level actors resolve against it
+                if (FPackageName::GetShortName(Map) != FPackageName::GetShortName(GetWorld()->GetOutermost()->GetName()))
+                {
+                    UE_LOG(LogDasher, Warning, TEXT("Swarm: server is on %s but the swarm is running %s"), *Map, *GetWorld()->GetMapName());
+                }
+
+                int32 NetSpeed = Connection->CurrentNetSpeed;
+                FNetControlMessage<NMT_Netspeed>::Send(Connection, NetSpeed);
+                FNetControlMessage<NMT_Join>::Send(Connection);
+                Connection->FlushNet(true);
+                Client->bJoined = true;
+            }
+            break;
+        }
+        case NMT_NetGUIDAssign:
+        {
+            FNetworkGUID NetGUID;
+            FString Path;
+            if (FNetControlMessage<NMT_NetGUIDAssign>::Receive(Bunch, NetGUID, Path))
+            {
+                Connection->PackageMap->ResolvePathAndAssignNetGUID(NetGUID, Path);
+            }
+            break;
+        }
+        case NMT_Failure:
+        {
+            FString Error;
+            FNetControlMessage<NMT_Failure>::Receive(Bunch, Error);
+            UE_LOG(LogDasher, Warning, TEXT("Swarm: %s was refused: %s"), *Client->NetDriverName.ToString(), *Error);
+            Connection->Close();
+            Client->bJoined = false;
+            break;
+        }
+        case NMT_Upgrade:
+        {
+            UE_LOG(LogDasher, Warning, TEXT("Swarm: the server runs a different build"));
+            Connection->Close();
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+FDasherSwarmClient* UDasherSwarmSubsystem::FindClient(const UNetConnection* Connection)
+{
+    const FName NetDriverName = Connection != nullptr && Connection->Driver != nullptr ? Connection->Driver->NetDriverName : NAME_None;
+    return Clients.FindByPredicate([NetDriverName](const FDasherSwarmClient& Client) { return Client.NetDriverName == NetDriverName; });
+}
+
+void UDasherSwarmSubsystem::ProcessNewActors(FDasherSwarmClient& Client)
+{
+    UNetConnection* Connection = Client.NetDriver->ServerConnection;
+    for (auto It = Connection->ActorChannelConstIterator(); It; ++It)
+    {
+        AActor* Actor = It.Key().Get();
+
+        // Level actors are shared by every client of the swarm, leave them to the world
+        if (Actor == nullptr || Actor->IsNetStartupActor() || Actor->GetNetDriverName() == Client.NetDriverName)
+        {
+            continue;
+        }
+
+        // Its RPCs and net mode now go through this client's driver
+        Actor->SetNetDriverName(Client.NetDriverName);
+        Actor->SetActorHiddenInGame(true);
+
+        Actor->ForEachComponent<USkeletalMeshComponent>(false, [](USkeletalMeshComponent* Mesh)
+        {
+            Mesh->SetComponentTickEnabled(false);
+            Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+        });
+
+        if (Actor->GetLocalRole() == ROLE_AutonomousProxy)
+        {
+            // Every client has its own copy of every character, they mustn't bump into each other's
+            if (ACharacter* Character = Cast<ACharacter>(Actor))
+            {
+                Character->GetCapsuleComponent()->SetCollisionResponseToChannel(ECC_Pawn, ECR_Ignore);
+            }
+        }
+        else
+        {
+            Actor->SetActorTickEnabled(false);
+            Actor->SetActorEnableCollision(false);
+        }
+    }
+}
+
+void UDasherSwarmSubsystem::DriveClient(FDasherSwarmClient& Client, float DeltaTime)
+{
+    APlayerController* PlayerController = Client.NetDriver->ServerConnection->PlayerController;
+    ADasherCharacter* Character = PlayerController != nullptr ? Cast<ADasherCharacter>(PlayerController->GetPawn()) : nullptr;
+    if (Character == nullptr || Character->GetLocalRole() != ROLE_AutonomousProxy)
+    {
+        return;
+    }
+
+    // The server doesn't take moves for a pawn the client hasn't acknowledged
+    if (PlayerController->AcknowledgedPawn != Character)
+    {
+        PlayerController->AcknowledgePossession(Character);
+    }
+
+    Client.TimeUntilDecision -= DeltaTime;
+    if (Client.TimeUntilDecision <= 0.f)
+    {
+        Client.TimeUntilDecision += DecisionInterval;
+        Client.TargetYaw = FRotator::NormalizeAxis(Client.TargetYaw + Client.Random.FRandRange(-90.f, 90.f));
+        Client.bFiring = Client.Random.FRand() < FireChance;
+    }
+
+    const float MaxTurn = TurnRate * DeltaTime;
+    const float YawDelta = FMath::Clamp(FMath::FindDeltaAngleDegrees(PlayerController->GetControlRotation().Yaw, Client.TargetYaw), -MaxTurn, MaxTurn);
+    if (!FMath::IsNearlyZero(YawDelta))
+    {
+        Character->Look(FInputActionValue(FVector2D(YawDelta, 0.f)));
+    }
+    Character->Move(FInputActionValue(FVector2D(0.f, 1.f)));
+
+    // The weapon the server gave us is held once the inventory replicates, until then firing does nothing
+    if (Client.bFiring)
+    {
+        Client.TimeUntilFire -= DeltaTime;
+        if (Client.TimeUntilFire <= 0.f)
+        {
+            Client.TimeUntilFire += FireInterval;
+            Character->Fire(FInputActionValue(true));
+        }
+    }
+}
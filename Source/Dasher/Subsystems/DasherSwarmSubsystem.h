@@ -0,0 +1,125 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/PendingNetGame.h"
+#include "DasherSwarmSubsystem.generated.h"
+
+class UNetDriver;
+
+/** One fake player of the swarm, with its own net driver and connection to the server */
+struct FDasherSwarmClient
+{
+    /** Name of the client's net driver, also given to every actor it receives */
+    FName NetDriverName;
+
+    TWeakObjectPtr<UNetDriver> NetDriver;
+
+    /** Seeded per client, so runs make the same choices */
+    FRandomStream Random;
+
+    float TargetYaw = 0.f;
+    float TimeUntilDecision = 0.f;
+    float TimeUntilFire = 0.f;
+    bool bFiring = false;
+
+    /** Whether the server welcomed the client and it asked to join */
+    bool bJoined = false;
+};
+
+/**
+ * Turns one headless client process into many real players, to stress the server's net driver, serialization and RPCs.
+ * Each swarm client opens its own named net driver to the server and does the same handshake a joining client does.
+ * The characters it receives are stripped of collision with other pawns, animation and tick, and its own character
+ * is played through the input handlers, so the server gets real ServerMove, ServerLook and ServerFireBatch traffic.
+ * Launch a standalone client on the server's map, next to a dedicated server started with -DasherGrantWeapons:
+ *   UnrealEditor-Cmd Dasher.uproject FirstPersonMap -game -nullrhi -nosound -DasherSwarm=127.0.0.1:7777 -DasherSwarmClients=100
+ */
+UCLASS(config=Game)
+class DASHER_API UDasherSwarmSubsystem : public UTickableWorldSubsystem, public FNetworkNotify
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Connects NumClients swarm clients to the server, ConnectRate of them per second */
+    void StartSwarm(const FString& InServerAddress, int32 NumClients);
+
+    /** Disconnects every swarm client */
+    void StopSwarm();
+
+    // USubsystem interface
+    virtual void Deinitialize() override;
+    // End of USubsystem interface
+
+    // UWorldSubsystem interface
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    // End of UWorldSubsystem interface
+
+    // UTickableWorldSubsystem interface
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    // End of UTickableWorldSubsystem interface
+
+    // FNetworkNotify interface
+    virtual EAcceptConnection::Type NotifyAcceptingConnection() override;
+    virtual void NotifyAcceptedConnection(UNetConnection* Connection) override;
+    virtual bool NotifyAcceptingChannel(UChannel* Channel) override;
+    virtual void NotifyControlMessage(UNetConnection* Connection, uint8 MessageType, FInBunch& Bunch) override;
+    // End of FNetworkNotify interface
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    /** How many clients connect per second, so the server isn't hit by every handshake at once */
+    UPROPERTY(Config)
+    float ConnectRate = 10.f;
+
+    /** Seed of the first client, each next client adds one */
+    UPROPERTY(Config)
+    int32 SwarmSeed = 1337;
+
+    /** How often a client rethinks its heading and whether it fires */
+    UPROPERTY(Config)
+    float DecisionInterval = 2.f;
+
+    /** Fastest a client turns, in degrees per second */
+    UPROPERTY(Config)
+    float TurnRate = 180.f;
+
+    /** Chance to hold the trigger for the next decision interval */
+    UPROPERTY(Config)
+    float FireChance = 0.5f;
+
+    /** Seconds between shots while the trigger is held */
+    UPROPERTY(Config)
+    float FireInterval = 0.25f;
+
+private:
+
+    void ConnectClient(int32 Index);
+
+    /** Starts the control channel handshake once the packet handlers are done with theirs */
+    void SendHello(int32 Index);
+
+    /** Binds and strips actors the client's connection received since the last tick */
+    void ProcessNewActors(FDasherSwarmClient& Client);
+
+    /** Plays the client's character through its input handlers */
+    void DriveClient(FDasherSwarmClient& Client, float DeltaTime);
+
+    FDasherSwarmClient* FindClient(const UNetConnection* Connection);
+
+    TArray<FDasherSwarmClient> Clients;
+
+    FString ServerAddress;
+
+    /** Clients still to connect */
+    int32 NumPendingClients = 0;
+
+    /** Seconds until the next client connects */
+    float TimeUntilConnect = 0.f;
+};
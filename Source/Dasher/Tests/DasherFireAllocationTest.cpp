@@ -0,0 +1,89 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Dasher.h"
+#include "Core/DasherAllocationTracker.h"
+#include "Subsystems/DasherFireAllocTestSubsystem.h"
+
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/AutomationCommon.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace DasherFireAllocationTest
+{
+    static const TCHAR* MapName = TEXT("/Game/Maps/FirstPersonMap");
+
+    // A few pool cycles are enough to catch a steady-state allocation, soak longer with -DasherFireAllocTest=10000
+    static constexpr int32 Shots = 200;
+
+    // The warm-up and measured shots at the default 10 shots a second and the drain, with room for a slow machine
+    static constexpr double TimeoutSeconds = 120.0;
+
+    static UDasherFireAllocTestSubsystem* GetSubsystem()
+    {
+        UWorld* World = AutomationCommon::GetAnyGameWorld();
+        return World != nullptr ? World->GetSubsystem<UDasherFireAllocTestSubsystem>() : nullptr;
+    }
+}
+
+DEFINE_LATENT_AUTOMATION_COMMAND_ONE_PARAMETER(FDasherStartFireAllocTest, FAutomationTestBase*, Test);
+
+bool FDasherStartFireAllocTest::Update()
+{
+    UDasherFireAllocTestSubsystem* FireAllocTest = DasherFireAllocationTest::GetSubsystem();
+    if (FireAllocTest == nullptr || !FireAllocTest->StartTest(DasherFireAllocationTest::Shots))
+    {
+        Test->AddError(TEXT("Fire allocation test didn't start, see the log"));
+    }
+    return true;
+}
+
+DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FDasherWaitForFireAllocTest, FAutomationTestBase*, Test, double, StartTime);
+
+bool FDasherWaitForFireAllocTest::Update()
+{
+    UDasherFireAllocTestSubsystem* FireAllocTest = DasherFireAllocationTest::GetSubsystem();
+    if (FireAllocTest == nullptr)
+    {
+        Test->AddError(TEXT("The map went away during the fire allocation test"));
+        return true;
+    }
+
+    if (FireAllocTest->IsRunning())
+    {
+        if (FPlatformTime::Seconds() - StartTime < DasherFireAllocationTest::TimeoutSeconds)
+        {
+            return false;
+        }
+        Test->AddError(FString::Printf(TEXT("Fire allocation test didn't finish in %.0f seconds"), DasherFireAllocationTest::TimeoutSeconds));
+        return true;
+    }
+
+    // The tracker keeps its counts once stopped, the report logged by the test says where the first allocation came from
+    Test->TestTrue(TEXT("All shots fired"), FireAllocTest->HasCompleted());
+    Test->TestTrue(TEXT("Measured shots"), FireAllocTest->GetNumShotsFired() >= DasherFireAllocationTest::Shots);
+    Test->TestEqual(TEXT("Heap allocations while firing"), FDasherAllocationTracker::GetNumAllocations(), static_cast<uint64>(0));
+    Test->TestEqual(TEXT("Objects created while firing"), FDasherAllocationTracker::GetNumObjects(), static_cast<uint64>(0));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDasherFireAllocationTest, "Dasher.Performance.FireAllocation",
+    EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+bool FDasherFireAllocationTest::RunTest(const FString& Parameters)
+{
+    // The allocator can only be wrapped at startup, runs without the switch skip the test
+    if (!FDasherAllocationTracker::CanTrack())
+    {
+        AddWarning(TEXT("Allocations aren't tracked, run with -DasherTrackAllocations in a non-shipping build"));
+        return true;
+    }
+
+    AutomationOpenMap(DasherFireAllocationTest::MapName);
+    ADD_LATENT_AUTOMATION_COMMAND(FDasherStartFireAllocTest(this));
+    ADD_LATENT_AUTOMATION_COMMAND(FDasherWaitForFireAllocTest(this, FPlatformTime::Seconds()));
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,199 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Dasher.h"
+#include "Core/DasherFireScheduler.h"
+
+#include "Misc/AutomationTest.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace DasherFireSchedulerTest
+{
+    static constexpr uint32 Flags = EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter;
+
+    // Shot times are stored as millisecond offsets
+    static constexpr double ShotTimeTolerance = 0.0005;
+
+    /** The scheduler tells held triggers from released ones by the frame counter, which tests move by hand */
+    struct FScopedFrameCounter
+    {
+        FScopedFrameCounter() : SavedFrameCounter(GFrameCounter) {}
+        ~FScopedFrameCounter() { GFrameCounter = SavedFrameCounter; }
+
+        void NextFrame() { ++GFrameCounter; }
+
+        uint64 SavedFrameCounter;
+    };
+
+    /** Takes every shot due by Now, returns how many there were and the time of the first */
+    static int32 TakeDueShots(FDasherFireScheduler& Scheduler, double Now, float FireInterval, double& OutFirstShotTime)
+    {
+        int32 NumShots = 0;
+        double ShotTime;
+        while (Scheduler.TakeDueShot(Now, FireInterval, ShotTime))
+        {
+            if (NumShots == 0)
+            {
+                OutFirstShotTime = ShotTime;
+            }
+            ++NumShots;
+        }
+        return NumShots;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDasherShotBatchOverflowTest, "Dasher.Fire.ShotBatch.Overflow", DasherFireSchedulerTest::Flags)
+
+bool FDasherShotBatchOverflowTest::RunTest(const FString& Parameters)
+{
+    FDasherShotBatch Batch;
+    for (int32 Index = 0; Index < FDasherShotBatch::MaxShots; ++Index)
+    {
+        TestTrue(FString::Printf(TEXT("Shot %d fits"), Index), Batch.Add(static_cast<uint8>(Index), 1.0 + Index * 0.1));
+    }
+    TestEqual(TEXT("Full batch"), Batch.Num(), FDasherShotBatch::MaxShots);
+    TestFalse(TEXT("Shot past MaxShots"), Batch.Add(FDasherShotBatch::MaxShots, 3.0));
+    TestEqual(TEXT("Batch left as it was"), Batch.Num(), FDasherShotBatch::MaxShots);
+
+    Batch.Reset();
+    TestTrue(TEXT("Shot after a reset"), Batch.Add(FDasherShotBatch::MaxShots, 3.0));
+    TestEqual(TEXT("First shot ID after a reset"), static_cast<int32>(Batch.GetShotId(0)), FDasherShotBatch::MaxShots);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDasherShotBatchOffsetOverflowTest, "Dasher.Fire.ShotBatch.OffsetOverflow", DasherFireSchedulerTest::Flags)
+
+bool FDasherShotBatchOffsetOverflowTest::RunTest(const FString& Parameters)
+{
+    FDasherShotBatch Batch;
+    Batch.Add(0, 10.0);
+    TestFalse(TEXT("Shot 65536 ms after the first"), Batch.Add(1, 10.0 + 65.536));
+    TestEqual(TEXT("Batch left as it was"), Batch.Num(), 1);
+    TestTrue(TEXT("Shot 65535 ms after the first"), Batch.Add(1, 10.0 + 65.535));
+    TestEqual(TEXT("Shot time at the largest offset"), Batch.GetShotTime(1), 10.0 + 65.535, DasherFireSchedulerTest::ShotTimeTolerance);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDasherShotBatchShotOrderTest, "Dasher.Fire.ShotBatch.ShotOrder", DasherFireSchedulerTest::Flags)
+
+bool FDasherShotBatchShotOrderTest::RunTest(const FString& Parameters)
+{
+    FDasherShotBatch Batch;
+    Batch.Add(7, 5.0);
+    Batch.Add(8, 5.02);
+    TestTrue(TEXT("Shot earlier than the previous one"), Batch.Add(9, 5.01));
+    TestEqual(TEXT("Earlier shot clamped to the previous one"), Batch.GetShotTime(2), 5.02, DasherFireSchedulerTest::ShotTimeTolerance);
+    TestTrue(TEXT("Shot earlier than the first one"), Batch.Add(10, 4.0));
+    TestEqual(TEXT("Shot before the batch clamped to the previous one"), Batch.GetShotTime(3), 5.02, DasherFireSchedulerTest::ShotTimeTolerance);
+
+    TestFalse(TEXT("Shot ID skipping one"), Batch.Add(12, 5.1));
+    TestFalse(TEXT("Shot ID going back"), Batch.Add(10, 5.1));
+    TestEqual(TEXT("Batch left as it was"), Batch.Num(), 4);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDasherShotBatchSerializeTest, "Dasher.Fire.ShotBatch.Serialize", DasherFireSchedulerTest::Flags)
+
+bool FDasherShotBatchSerializeTest::RunTest(const FString& Parameters)
+{
+    // Shot IDs wrap around within the batch
+    FDasherShotBatch Batch;
+    for (int32 Index = 0; Index < 5; ++Index)
+    {
+        Batch.Add(static_cast<uint8>(254 + Index), 1234.5678 + Index * 0.033);
+    }
+
+    bool bSaved = false;
+    FBitWriter Writer(0, true);
+    Batch.NetSerialize(Writer, nullptr, bSaved);
+    TestTrue(TEXT("Saved"), bSaved);
+    TestTrue(TEXT("Net size covers what was written"), Writer.GetNumBits() <= Batch.GetNetSize() * 8);
+
+    bool bLoaded = false;
+    FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+    FDasherShotBatch Loaded;
+    Loaded.NetSerialize(Reader, nullptr, bLoaded);
+    TestTrue(TEXT("Loaded"), bLoaded);
+    TestEqual(TEXT("Everything read"), Reader.GetPosBits(), Writer.GetNumBits());
+
+    TestEqual(TEXT("Shot count"), Loaded.Num(), Batch.Num());
+    for (int32 Index = 0; Index < FMath::Min(Loaded.Num(), Batch.Num()); ++Index)
+    {
+        TestEqual(FString::Printf(TEXT("Shot %d ID"), Index), static_cast<int32>(Loaded.GetShotId(Index)), static_cast<int32>(Batch.GetShotId(Index)));
+        TestEqual(FString::Printf(TEXT("Shot %d time"), Index), Loaded.GetShotTime(Index), Batch.GetShotTime(Index));
+    }
+
+    // An empty batch is just its count
+    FDasherShotBatch Empty;
+    FBitWriter EmptyWriter(0, true);
+    Empty.NetSerialize(EmptyWriter, nullptr, bSaved);
+    FBitReader EmptyReader(EmptyWriter.GetData(), EmptyWriter.GetNumBits());
+    Loaded.NetSerialize(EmptyReader, nullptr, bLoaded);
+    TestEqual(TEXT("Empty batch shot count"), Loaded.Num(), 0);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDasherFireSchedulerCatchUpTest, "Dasher.Fire.Scheduler.CatchUp", DasherFireSchedulerTest::Flags)
+
+bool FDasherFireSchedulerCatchUpTest::RunTest(const FString& Parameters)
+{
+    DasherFireSchedulerTest::FScopedFrameCounter FrameCounter;
+    // A power of two, so shot times add up exactly and the shot due now isn't a rounding error away
+    const float FireInterval = 0.125f;
+    double FirstShotTime = 0.0;
+
+    FDasherFireScheduler Scheduler;
+    Scheduler.PullTrigger(1.0, FireInterval);
+    TestEqual(TEXT("First pull fires right away"), DasherFireSchedulerTest::TakeDueShots(Scheduler, 1.0, FireInterval, FirstShotTime), 1);
+    TestEqual(TEXT("First shot time"), FirstShotTime, 1.0, UE_DOUBLE_KINDA_SMALL_NUMBER);
+
+    // A frame slower than the fire rate fires every shot due in it, at the time each was due
+    FrameCounter.NextFrame();
+    Scheduler.PullTrigger(1.3, FireInterval);
+    TestEqual(TEXT("Shots due in a slow frame"), DasherFireSchedulerTest::TakeDueShots(Scheduler, 1.3, FireInterval, FirstShotTime), 2);
+    TestEqual(TEXT("First shot of a slow frame"), FirstShotTime, 1.125, UE_DOUBLE_KINDA_SMALL_NUMBER);
+
+    // A hitch fires the shot due now and MaxShotsBehind before it, the older ones are dropped
+    FrameCounter.NextFrame();
+    Scheduler.PullTrigger(11.25, FireInterval);
+    TestEqual(TEXT("Shots due after a hitch"), DasherFireSchedulerTest::TakeDueShots(Scheduler, 11.25, FireInterval, FirstShotTime), 5);
+    TestEqual(TEXT("First shot after a hitch"), FirstShotTime, 11.25 - 4 * FireInterval, UE_DOUBLE_KINDA_SMALL_NUMBER);
+
+    // The interval is kept once the shots caught up
+    FrameCounter.NextFrame();
+    Scheduler.PullTrigger(11.3, FireInterval);
+    TestEqual(TEXT("Shots before the interval is over"), DasherFireSchedulerTest::TakeDueShots(Scheduler, 11.3, FireInterval, FirstShotTime), 0);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDasherFireSchedulerReleaseTest, "Dasher.Fire.Scheduler.Release", DasherFireSchedulerTest::Flags)
+
+bool FDasherFireSchedulerReleaseTest::RunTest(const FString& Parameters)
+{
+    DasherFireSchedulerTest::FScopedFrameCounter FrameCounter;
+    const float FireInterval = 0.125f;
+    double FirstShotTime = 0.0;
+
+    FDasherFireScheduler Scheduler;
+    Scheduler.PullTrigger(1.0, FireInterval);
+    DasherFireSchedulerTest::TakeDueShots(Scheduler, 1.0, FireInterval, FirstShotTime);
+
+    // Fire input stopped coming, the trigger is let go without a release
+    FrameCounter.NextFrame();
+    FrameCounter.NextFrame();
+    TestEqual(TEXT("Shots after a frame without fire input"), DasherFireSchedulerTest::TakeDueShots(Scheduler, 1.5, FireInterval, FirstShotTime), 0);
+    TestFalse(TEXT("Active after a frame without fire input"), Scheduler.IsActive());
+
+    // Tapping faster than the fire rate waits for the interval
+    Scheduler.PullTrigger(1.5, FireInterval);
+    TestEqual(TEXT("Shots of a new pull"), DasherFireSchedulerTest::TakeDueShots(Scheduler, 1.5, FireInterval, FirstShotTime), 1);
+    Scheduler.ReleaseTrigger();
+    FrameCounter.NextFrame();
+    Scheduler.PullTrigger(1.55, FireInterval);
+    TestEqual(TEXT("Shots of a tap within the interval"), DasherFireSchedulerTest::TakeDueShots(Scheduler, 1.55, FireInterval, FirstShotTime), 0);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,59 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Dasher.h"
+#include "Actors/DasherProjectile.h"
+#include "Components/DasherInventoryComponent.h"
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && DASHER_WITH_PUSH_MODEL_VALIDATION
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDasherPushModelClassesTest, "Dasher.Net.PushModelClasses",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FDasherPushModelClassesTest::RunTest(const FString& Parameters)
+{
+    // Projectiles move in and out of their pool, that takes a world
+    UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+    FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+    WorldContext.SetCurrentWorld(World);
+
+    ADasherProjectile* Projectile = World->SpawnActor<ADasherProjectile>();
+    if (TestNotNull(TEXT("Projectile spawned"), Projectile))
+    {
+        TestTrue(TEXT("Spawned projectile's bInPool passes"), Projectile->bInPoolShadow.Matches(Projectile->bInPool));
+
+        Projectile->DeactivateToPool();
+        TestTrue(TEXT("bInPool set by DeactivateToPool passes"), Projectile->bInPoolShadow.Matches(Projectile->bInPool));
+
+        Projectile->ActivateFromPool(FVector::ZeroVector, FRotator::ZeroRotator);
+        TestTrue(TEXT("bInPool set by ActivateFromPool passes"), Projectile->bInPoolShadow.Matches(Projectile->bInPool));
+
+        Projectile->bInPool = !Projectile->bInPool;
+        TestFalse(TEXT("bInPool written directly fails"), Projectile->bInPoolShadow.Matches(Projectile->bInPool));
+
+        Projectile->SetShotId(7);
+        TestTrue(TEXT("ShotId set by SetShotId passes"), Projectile->ShotIdShadow.Matches(Projectile->ShotId));
+
+        Projectile->ShotId = 8;
+        TestFalse(TEXT("ShotId written directly fails"), Projectile->ShotIdShadow.Matches(Projectile->ShotId));
+
+        // The inventory only needs an actor to belong to, whichever it is
+        UDasherInventoryComponent* Inventory = NewObject<UDasherInventoryComponent>(Projectile);
+        TestTrue(TEXT("New inventory's ActiveSlot passes"), Inventory->ActiveSlotShadow.Matches(Inventory->ActiveSlot));
+
+        Inventory->SetActiveSlot(1);
+        TestTrue(TEXT("ActiveSlot set by SetActiveSlot passes"), Inventory->ActiveSlotShadow.Matches(Inventory->ActiveSlot));
+
+        Inventory->ActiveSlot = 2;
+        TestFalse(TEXT("ActiveSlot written directly fails"), Inventory->ActiveSlotShadow.Matches(Inventory->ActiveSlot));
+    }
+
+    GEngine->DestroyWorldContext(World);
+    World->DestroyWorld(false);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS && DASHER_WITH_PUSH_MODEL_VALIDATION
@@ -0,0 +1,20 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+public class DasherServerTarget : TargetRules
+{
+	public DasherServerTarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Server;
+		DefaultBuildSettings = BuildSettingsVersion.V2;
+		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_1;
+		ExtraModuleNames.Add("Dasher");
+
+		// Replicated properties are push-model, see Core/DasherPushModel.h
+		bWithPushModel = true;
+
+		// Cosmetics under #if !UE_SERVER, first person mesh, camera, fire sound and montage, input mapping, aren't built
+	}
+}
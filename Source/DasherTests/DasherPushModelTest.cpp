@@ -0,0 +1,52 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DasherPushModelTestObject.h"
+
+#include "Misc/AutomationTest.h"
+#include "Net/UnrealNetwork.h"
+#include "UObject/Package.h"
+
+void UDasherPushModelTestObject::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    FDoRepLifetimeParams Params;
+    Params.bIsPushBased = true;
+    DOREPLIFETIME_WITH_PARAMS_FAST(UDasherPushModelTestObject, Value, Params);
+}
+
+void UDasherPushModelTestObject::SetValue(int32 NewValue)
+{
+    DASHER_SET_PUSH_PROPERTY(UDasherPushModelTestObject, Value, NewValue);
+}
+
+#if WITH_DEV_AUTOMATION_TESTS && DASHER_WITH_PUSH_MODEL_VALIDATION
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDasherPushModelValidationTest, "Dasher.Net.PushModelValidation",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FDasherPushModelValidationTest::RunTest(const FString& Parameters)
+{
+    UDasherPushModelTestObject* Object = NewObject<UDasherPushModelTestObject>(GetTransientPackage());
+
+    TestTrue(TEXT("Untouched property passes"), Object->IsValueMarked());
+
+    Object->SetValue(1);
+    TestTrue(TEXT("Property set and marked dirty passes"), Object->IsValueMarked());
+
+    Object->SetValueUnmarked(2);
+    TestFalse(TEXT("Property changed without being marked dirty fails"), Object->IsValueMarked());
+
+    Object->SetValue(2);
+    TestTrue(TEXT("Property marked dirty again passes"), Object->IsValueMarked());
+
+    // Writing back the value it was marked with changes nothing that needs replicating
+    Object->SetValueUnmarked(3);
+    Object->SetValueUnmarked(2);
+    TestTrue(TEXT("Property written back to its marked value passes"), Object->IsValueMarked());
+
+    Object->MarkAsGarbage();
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS && DASHER_WITH_PUSH_MODEL_VALIDATION
@@ -0,0 +1,38 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+
+#include "Core/DasherPushModel.h"
+
+#include "DasherPushModelTestObject.generated.h"
+
+/** A push-model property for the push model validation test to write with and without marking it dirty */
+UCLASS(Transient, NotBlueprintable)
+class UDasherPushModelTestObject : public UObject
+{
+    GENERATED_BODY()
+
+public:
+
+    virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+    virtual bool IsSupportedForNetworking() const override { return true; }
+
+    /** Writes the property the way every push-model property must be written */
+    void SetValue(int32 NewValue);
+
+    /** Writes the property without marking it dirty, the mistake the validation catches */
+    void SetValueUnmarked(int32 NewValue) { Value = NewValue; }
+
+    /** What DASHER_VALIDATE_PUSH_PROPERTY checks in PreReplication */
+    bool IsValueMarked() const { return DASHER_IS_PUSH_PROPERTY_MARKED(Value); }
+
+private:
+
+    UPROPERTY(Replicated)
+    int32 Value = 0;
+
+    TDasherPushModelShadow<int32> ValueShadow;
+};
@@ -0,0 +1,14 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+// Classes only the automation tests need, kept out of the game module so shipping builds never contain them
+public class DasherTests : ModuleRules
+{
+    public DasherTests(ReadOnlyTargetRules Target) : base(Target)
+    {
+        PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+        PrivateDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "NetCore", "Dasher" });
+    }
+}